@@ -1,4 +1,5 @@
 #include "Block.h"
+#include "counters.h"
 
 namespace game
 {
@@ -28,6 +29,7 @@ namespace game
 	/* Collision */
 	bool Block::collision(SceneNode * obj, float off, float boundRad)
 	{
+		Counters::Add(CounterCollisionsTested);
 		//find real center of the object
 		glm::vec3 objUpVec = glm::normalize(obj->GetOrientation() * glm::vec3(0, 1, 0));
 		glm::vec3 objRealCenter = obj->getAbsolutePosition() + objUpVec * off;
@@ -1,4 +1,5 @@
 #include "DragonFly.h"
+#include "counters.h"
 
 namespace game
 {
@@ -99,6 +100,7 @@ namespace game
 	/* Collision */
 	bool DragonFly::collision(SceneNode* object, float off, float boundRad)
 	{
+		Counters::Add(CounterCollisionsTested);
 		//find real center of the object
 		glm::vec3 objUpVec = glm::normalize(object->getAbsoluteOrientation() * glm::vec3(0, 1, 0));
 		glm::vec3 objRealCenter = object->getAbsolutePosition() + objUpVec * off;
@@ -1,9 +1,7 @@
 #ifndef ENEMY_H
 #define ENEMY_H
 
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "gl_types.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
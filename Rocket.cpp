@@ -1,5 +1,6 @@
 #include "Rocket.h"
 #include <iostream>
+#include "counters.h"
 
 namespace game
 {
@@ -29,6 +30,7 @@ namespace game
 	/* Collision */
 	bool Rocket::collision(SceneNode* object , float off, float boundRad)
 	{
+		Counters::Add(CounterCollisionsTested);
 		//find real center of the object
 		glm::vec3 objUpVec = glm::normalize(object->getAbsoluteOrientation() * glm::vec3(0, 1, 0));
 		glm::vec3 objRealCenter = object->getAbsolutePosition() + objUpVec * off;
@@ -1,4 +1,5 @@
 #include "Spider.h"
+#include "counters.h"
 
 // Spider is fixed
 namespace game
@@ -115,6 +116,7 @@ namespace game
 	/* Collision */
 	bool Spider::collision(SceneNode* object, float off, float boundRad)
 	{
+		Counters::Add(CounterCollisionsTested);
 		//find real center of the object
 		glm::vec3 objUpVec = glm::normalize(object->getAbsoluteOrientation() * glm::vec3(0, 1, 0));
 		glm::vec3 objRealCenter = object->getAbsolutePosition() + objUpVec * off;
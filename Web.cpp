@@ -1,4 +1,5 @@
 #include "Web.h"
+#include "counters.h"
 
 #include <iostream>
 
@@ -40,6 +41,7 @@ namespace game
 	/* Collision */
 	bool Web::collision(SceneNode* collidable, float off, float boundingRad)
 	{
+		Counters::Add(CounterCollisionsTested);
 		//find real center of the object
 		glm::vec3 objUpVec = glm::normalize(collidable->getAbsoluteOrientation() * glm::vec3(0, 1, 0));
 		glm::vec3 objRealCenter = collidable->getAbsolutePosition() + objUpVec * off;
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "benchmark.h"
+
+// BENCHMARK
+namespace game
+{
+	// Written by Consume, volatile so the stores are not optimized away
+	static volatile double sink_g = 0.0;
+
+	/* Constructor */
+	Benchmark::Benchmark(int warmup, int repetitions)
+	{
+		if (repetitions < 1) { throw(std::invalid_argument(std::string("A benchmark needs at least one repetition"))); }
+		warmup_ = warmup;
+		repetitions_ = repetitions;
+	}
+
+	/* Destructor */
+	Benchmark::~Benchmark() {}
+
+	void Benchmark::SetFilter(const std::string filter) { filter_ = filter; }
+	bool Benchmark::Selected(const std::string name) const { return name.find(filter_) != std::string::npos; }
+	void Benchmark::Consume(double value) { sink_g = sink_g + value; }
+	const std::vector<BenchmarkResult> &Benchmark::GetResults(void) const { return results_; }
+
+	void Benchmark::Run(const std::string name, std::function<void(void)> kernel, double items)
+	{
+		if (!Selected(name)) { return; }
+
+		for (int i = 0; i < warmup_; i++) { kernel(); }
+
+		std::vector<double> time(repetitions_);
+		for (int i = 0; i < repetitions_; i++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			kernel();
+			time[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		std::sort(time.begin(), time.end());
+
+		BenchmarkResult result;
+		result.name = name;
+		result.repetitions = repetitions_;
+		result.items = items;
+		result.min = time[0];
+		result.median = (repetitions_ % 2) ? time[repetitions_ / 2] : 0.5 * (time[repetitions_ / 2 - 1] + time[repetitions_ / 2]);
+		result.p99 = time[(int)std::ceil(0.99 * repetitions_) - 1];	// Nearest rank
+		result.mean = 0.0;
+		for (int i = 0; i < repetitions_; i++) { result.mean += time[i]; }
+		result.mean /= repetitions_;
+		results_.push_back(result);
+	}
+
+	void Benchmark::PrintTable(std::ostream &out) const
+	{
+		out << std::left << std::setw(40) << "benchmark" << std::right
+			<< std::setw(12) << "median ms" << std::setw(12) << "p99 ms" << std::setw(12) << "min ms" << std::setw(16) << "items/s" << std::endl;
+		for (int i = 0; i < results_.size(); i++)
+		{
+			const BenchmarkResult &r = results_[i];
+			out << std::left << std::setw(40) << r.name << std::right << std::fixed << std::setprecision(4)
+				<< std::setw(12) << r.median * 1000.0 << std::setw(12) << r.p99 * 1000.0 << std::setw(12) << r.min * 1000.0
+				<< std::setprecision(0) << std::setw(16) << r.items / r.median << std::endl;
+		}
+	}
+
+	void Benchmark::WriteCsv(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		f << "name,repetitions,items,min_s,median_s,p99_s,mean_s" << std::endl;
+		f << std::setprecision(9);
+		for (int i = 0; i < results_.size(); i++)
+		{
+			const BenchmarkResult &r = results_[i];
+			f << r.name << "," << r.repetitions << "," << r.items << "," << r.min << "," << r.median << "," << r.p99 << "," << r.mean << std::endl;
+		}
+	}
+
+	void Benchmark::WriteJson(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		f << "[" << std::endl << std::setprecision(9);
+		for (int i = 0; i < results_.size(); i++)
+		{
+			const BenchmarkResult &r = results_[i];
+			// Names are built from file names, only quotes and backslashes need escaping
+			std::string name;
+			for (int j = 0; j < r.name.size(); j++)
+			{
+				if (r.name[j] == '"' || r.name[j] == '\\') { name += '\\'; }
+				name += r.name[j];
+			}
+			f << "  {\"name\": \"" << name << "\", \"repetitions\": " << r.repetitions << ", \"items\": " << r.items
+				<< ", \"min_s\": " << r.min << ", \"median_s\": " << r.median << ", \"p99_s\": " << r.p99 << ", \"mean_s\": " << r.mean << "}"
+				<< ((i + 1 < results_.size()) ? "," : "") << std::endl;
+		}
+		f << "]" << std::endl;
+	}
+} // namespace game
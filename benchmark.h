@@ -0,0 +1,56 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+// Runs of a kernel before the timed ones, to fill the caches and the allocator
+#define BENCHMARK_DEFAULT_WARMUP 3
+// Timed runs of a kernel
+#define BENCHMARK_DEFAULT_REPETITIONS 30
+
+// BENCHMARK
+namespace game
+{
+	// Timings of one kernel, in seconds per run
+	struct BenchmarkResult
+	{
+		std::string name;
+		int repetitions;
+		double items;		// Work done by one run (entities, vertices, ...), for the throughput
+		double min;
+		double median;
+		double p99;
+		double mean;
+	};
+
+	// Small harness for the micro-benchmarks: each kernel is run a few times
+	// untimed, then timed run by run so the median and tail are reported
+	// alongside the mean
+	class Benchmark
+	{
+	public:
+		Benchmark(int warmup = BENCHMARK_DEFAULT_WARMUP, int repetitions = BENCHMARK_DEFAULT_REPETITIONS);
+		~Benchmark();
+
+		void SetFilter(const std::string filter);	// Only run kernels whose name contains filter
+		bool Selected(const std::string name) const;	// Whether a kernel passes the filter, to skip its setup
+
+		void Run(const std::string name, std::function<void(void)> kernel, double items = 1.0);
+		static void Consume(double value);			// Keep a result of a kernel alive so the compiler cannot drop the work
+
+		const std::vector<BenchmarkResult> &GetResults(void) const;
+		void PrintTable(std::ostream &out) const;
+		void WriteCsv(const std::string filename) const;
+		void WriteJson(const std::string filename) const;
+
+	private:
+		int warmup_;
+		int repetitions_;
+		std::string filter_;
+		std::vector<BenchmarkResult> results_;
+	}; // class Benchmark
+} // namespace game
+#endif // BENCHMARK_H_
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <exception>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/quaternion.hpp>
+
+#include "bin/path_config.h"
+#include "benchmark.h"
+#include "mesh_loader.h"
+#include "scene_node.h"
+#include "Rocket.h"
+
+// Entities tested against each other by the collision benchmark
+#define BENCH_DEFAULT_ENTITIES 512
+// Nodes in the scene traversed by the transform benchmark
+#define BENCH_DEFAULT_NODES 4096
+// Particles sampled over a mesh, as many as the game uses for each part of a human
+#define BENCH_MESH_PARTICLES 200000
+
+// Macro for printing exceptions
+#define PrintException(exception_object)\
+	std::cerr << exception_object.what() << std::endl
+
+// Obj files of the asset directory, sorted so runs list them in the same order
+std::vector<std::string> ListAssets(const std::string directory)
+{
+	std::vector<std::string> files;
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((directory + "/*.obj").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE) { throw(std::ios_base::failure(std::string("Error opening directory ") + directory)); }
+	do { files.push_back(data.cFileName); } while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (!dir) { throw(std::ios_base::failure(std::string("Error opening directory ") + directory)); }
+	for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir))
+	{
+		std::string name(entry->d_name);
+		if (name.size() > 4 && name.compare(name.size() - 4, 4, ".obj") == 0) { files.push_back(name); }
+	}
+	closedir(dir);
+#endif
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+// Micro-benchmarks of the CPU kernels of the game, no window or OpenGL context is created
+// --reps N and --warmup N set the runs per kernel, --filter S only runs kernels whose name contains S,
+// --csv FILE and --json FILE also write the results to files
+int main(int argc, char **argv)
+{
+	int repetitions = BENCHMARK_DEFAULT_REPETITIONS;
+	int warmup = BENCHMARK_DEFAULT_WARMUP;
+	int num_entities = BENCH_DEFAULT_ENTITIES;
+	int num_nodes = BENCH_DEFAULT_NODES;
+	std::string filter, csv, json;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if (arg == "--reps" && i + 1 < argc) { repetitions = atoi(argv[++i]); }
+		else if (arg == "--warmup" && i + 1 < argc) { warmup = atoi(argv[++i]); }
+		else if (arg == "--filter" && i + 1 < argc) { filter = argv[++i]; }
+		else if (arg == "--entities" && i + 1 < argc) { num_entities = atoi(argv[++i]); }
+		else if (arg == "--nodes" && i + 1 < argc) { num_nodes = atoi(argv[++i]); }
+		else if (arg == "--csv" && i + 1 < argc) { csv = argv[++i]; }
+		else if (arg == "--json" && i + 1 < argc) { json = argv[++i]; }
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--reps N] [--warmup N] [--filter S] [--entities N] [--nodes N] [--csv FILE] [--json FILE]" << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		game::Benchmark bench(warmup, repetitions);
+		bench.SetFilter(filter);
+
+		/* Obj parsing */
+		std::string asset_directory = std::string(MATERIAL_DIRECTORY) + std::string("/assets");
+		std::vector<std::string> assets = ListAssets(asset_directory);
+		for (int i = 0; i < assets.size(); i++)
+		{
+			if (!bench.Selected("load_obj/" + assets[i])) { continue; }	// Counting the faces parses the file too
+			std::string filename = asset_directory + "/" + assets[i];
+			game::TriMesh mesh;
+			game::LoadObj(filename.c_str(), mesh);
+			double faces = mesh.face.size();
+			bench.Run("load_obj/" + assets[i], [filename]() {
+				game::TriMesh mesh;
+				game::LoadObj(filename.c_str(), mesh);
+				game::Benchmark::Consume(mesh.face.size());
+			}, faces);
+		}
+
+		/* Procedural geometry, with the default sampling of the resource manager */
+		bench.Run("sphere_geometry", []() {
+			game::GeometryData geometry;
+			game::BuildSphereGeometry(0.6, 90, 45, geometry);
+			game::Benchmark::Consume(geometry.vertex[0]);
+		}, 90 * 45);
+		bench.Run("torus_geometry", []() {
+			game::GeometryData geometry;
+			game::BuildTorusGeometry(0.6, 0.2, 90, 30, geometry);
+			game::Benchmark::Consume(geometry.vertex[0]);
+		}, 90 * 30);
+
+		/* Particles sampled over the surface of a mesh */
+		if (bench.Selected("mesh_particles"))
+		{
+			game::TriMesh mesh;
+			game::LoadObj((asset_directory + "/humanbody.obj").c_str(), mesh);
+			bench.Run("mesh_particles/humanbody.obj", [&mesh]() {
+				game::GeometryData geometry;
+				game::BuildMeshParticles(mesh, BENCH_MESH_PARTICLES, geometry);
+				game::Benchmark::Consume(geometry.vertex[0]);
+			}, BENCH_MESH_PARTICLES);
+		}
+
+		/* Sphere-pair collision of every entity against every other, like rockets against enemies */
+		if (bench.Selected("collision"))
+		{
+			game::SceneNode root("root", 0, 0);
+			std::vector<game::SceneNode *> node(num_entities);
+			std::vector<game::Rocket *> entity(num_entities);
+			srand(1);
+			for (int i = 0; i < num_entities; i++)
+			{
+				node[i] = new game::SceneNode("entity", 0, 0);
+				node[i]->SetPosition(glm::vec3(rand() % 200 - 100, rand() % 40, rand() % 200 - 100));
+				node[i]->SetOrientation(glm::angleAxis((float)(rand() % 360), glm::vec3(0, 1, 0)));
+				root.AddChild(node[i]);
+				node[i]->UpdateTransform(glm::mat4(1.0));
+				entity[i] = new game::Rocket(node[i], glm::vec3(0, 0, 1));
+			}
+			bench.Run("collision/" + std::to_string(num_entities), [&]() {
+				int hits = 0;
+				for (int i = 0; i < num_entities; i++)
+				{
+					for (int j = i + 1; j < num_entities; j++)
+					{
+						if (entity[i]->collision(node[j], 0.0, 1.0)) { hits++; }
+					}
+				}
+				game::Benchmark::Consume(hits);
+			}, (double)num_entities * (num_entities - 1) / 2);
+			for (int i = 0; i < num_entities; i++) { delete entity[i]; delete node[i]; }
+		}
+
+		/* Transform pass over a scene of drawable nodes, each body with three parts like the enemies */
+		if (bench.Selected("scene_transform"))
+		{
+			// Handles are never used by OpenGL, the transform pass only checks they are set
+			game::Resource geometry(game::Mesh, "bench_geometry", 1, 1, 36);
+			game::Resource material(game::Material, "bench_material", 1, 0);
+			game::SceneNode *root = new game::SceneNode("root", 0, 0);
+			std::vector<game::SceneNode *> node;
+			for (int i = 0; i < num_nodes; i++)
+			{
+				game::SceneNode *current = new game::SceneNode("node", &geometry, &material);
+				current->SetPosition(glm::vec3(i % 64, (i / 64) % 8, i / 512));
+				if (i % 4 == 0) { root->AddChild(current); }
+				else { node[i - i % 4]->AddChild(current); }
+				node.push_back(current);
+			}
+			bench.Run("scene_transform/" + std::to_string(num_nodes), [root, &node]() {
+				game::SceneNode::TransformHierarchy(root, NULL);
+				game::Benchmark::Consume(node.back()->getAbsolutePosition().x);
+			}, num_nodes);
+			for (int i = 0; i < num_nodes; i++) { delete node[i]; }
+			delete root;
+		}
+
+		bench.PrintTable(std::cout);
+		if (!csv.empty()) { bench.WriteCsv(csv); }
+		if (!json.empty()) { bench.WriteJson(json); }
+	}
+	catch (std::exception &e)
+	{
+		PrintException(e);
+		return 1;
+	}
+
+	return 0;
+}
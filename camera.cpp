@@ -14,6 +14,7 @@ namespace game
 	{
 		firstPerson = false;
 		distance = 0.6f;
+		pixel_scale_ = 1.0f;
 	}
 
 	/* Destructor */
@@ -22,6 +23,7 @@ namespace game
 	/* Getters */
 	glm::vec3 Camera::GetPosition(void) const			{ return position_; }
 	glm::quat Camera::GetOrientation(void) const		{ return orientation_; }
+	float Camera::GetPixelScale(void) const				{ return pixel_scale_; }
 
 	/* Setters */
 	void Camera::SetPosition(glm::vec3 position)		{ position_ = position; }
@@ -98,21 +100,7 @@ namespace game
 		float top = tan((fov / 2.0)*(glm::pi<float>() / 180.0))*near;
 		float right = top * w / h;
 		projection_matrix_ = glm::frustum(-right, right, -top, top, near, far);
-	}
-
-	//Shader
-	void Camera::SetupShader(GLuint program) 
-	{
-		// Update view matrix
-		SetupViewMatrix();
-
-		// Set view matrix in shader
-		GLint view_mat = glGetUniformLocation(program, "view_mat");
-		glUniformMatrix4fv(view_mat, 1, GL_FALSE, glm::value_ptr(view_matrix_));
-
-		// Set projection matrix in shader
-		GLint projection_mat = glGetUniformLocation(program, "projection_mat");
-		glUniformMatrix4fv(projection_mat, 1, GL_FALSE, glm::value_ptr(projection_matrix_));
+		pixel_scale_ = h * near / (2.0 * top);
 	}
 
 	//View Matrix
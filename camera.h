@@ -1,9 +1,7 @@
 #ifndef CAMERA_H_
 #define CAMERA_H_
 
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "gl_types.h"
 #include <glm/glm.hpp>
 
 
@@ -50,6 +48,8 @@ namespace game
             void SetProjection(GLfloat fov, GLfloat near, GLfloat far, GLfloat w, GLfloat h);
             // Set all camera-related variables in shader program
             void SetupShader(GLuint program);
+            // Pixels covered by one unit at a distance of one unit, for sizing objects on screen
+            float GetPixelScale(void) const;
 
         private:
             glm::vec3 position_;				 // Position of camera
@@ -58,6 +58,7 @@ namespace game
             glm::vec3 side_;					 // Initial side vector
             glm::mat4 view_matrix_;				 // View matrix
             glm::mat4 projection_matrix_;		 // Projection matrix
+            float pixel_scale_;					 // Viewport height over the height of the view at distance one
 
             // Create view matrix from current camera parameters
             void SetupViewMatrix(void);
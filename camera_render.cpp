@@ -0,0 +1,24 @@
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "camera.h"
+#include "gl_calls.h"
+
+// Shader setup of the camera, built into the renderer library
+namespace game
+{
+	//Shader
+	void Camera::SetupShader(GLuint program) 
+	{
+		// Update view matrix
+		SetupViewMatrix();
+
+		// Set view matrix in shader
+		GLint view_mat = glGetUniformLocation(program, "view_mat");
+		Gl::UniformMatrix4fv(view_mat, 1, GL_FALSE, glm::value_ptr(view_matrix_));
+
+		// Set projection matrix in shader
+		GLint projection_mat = glGetUniformLocation(program, "projection_mat");
+		Gl::UniformMatrix4fv(projection_mat, 1, GL_FALSE, glm::value_ptr(projection_matrix_));
+	}
+} // namespace game
@@ -0,0 +1,51 @@
+#include <stdexcept>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "character_node.h"
+#include "gl_calls.h"
+
+// CHARACTER NODE
+namespace game
+{
+	/* Constructor */
+	CharacterNode::CharacterNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture) : SceneNode(name, geometry, material, texture) {}
+
+	/* Destructor */
+	CharacterNode::~CharacterNode() {}
+
+	void CharacterNode::AddPart(SceneNode *part)
+	{
+		if (parts_.size() == MAX_CHARACTER_PARTS) { throw(std::invalid_argument(std::string("Too many parts in character ") + GetName())); }
+
+		part->SetMerged(true);
+		parts_.push_back(part);
+	}
+
+	void CharacterNode::SetupShader(GLuint program)
+	{
+		SceneNode::SetupShader(program);
+
+		// Hidden parts get a zero matrix, collapsing their triangles
+		glm::mat4 part_mat[MAX_CHARACTER_PARTS];
+		glm::mat4 part_normal_mat[MAX_CHARACTER_PARTS];
+		for (int i = 0; i < parts_.size(); i++)
+		{
+			if (parts_[i]->GetVisible())
+			{
+				part_mat[i] = parts_[i]->GetWorldMatrix();
+				part_normal_mat[i] = parts_[i]->GetNormalMatrix();
+			}
+			else
+			{
+				part_mat[i] = glm::mat4(0.0);
+				part_normal_mat[i] = glm::mat4(0.0);
+			}
+		}
+
+		GLint part_mat_var = glGetUniformLocation(program, "part_mat");
+		Gl::UniformMatrix4fv(part_mat_var, parts_.size(), GL_FALSE, glm::value_ptr(part_mat[0]));
+		GLint part_normal_mat_var = glGetUniformLocation(program, "part_normal_mat");
+		Gl::UniformMatrix4fv(part_normal_mat_var, parts_.size(), GL_FALSE, glm::value_ptr(part_normal_mat[0]));
+	}
+} // namespace game
@@ -0,0 +1,32 @@
+#ifndef CHARACTER_NODE_H_
+#define CHARACTER_NODE_H_
+
+#include <vector>
+
+#include "scene_node.h"
+
+// Maximum number of parts in a merged character, must match the size of the arrays in character_vp.glsl
+#define MAX_CHARACTER_PARTS 8
+
+// CHARACTER NODE
+namespace game
+{
+	// Draws all the parts of a character in one call. The geometry is the merged mesh of
+	// the parts (see MergeGeometry) and each vertex is moved by the world matrix of its part,
+	// so the part nodes keep animating while only their matrices are computed
+	class CharacterNode : public SceneNode
+	{
+	public:
+		CharacterNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture = 0);
+		~CharacterNode();
+
+		void AddPart(SceneNode *part);		// Add the next part of the merged mesh, it is no longer drawn on its own
+
+	protected:
+		void SetupShader(GLuint program);	// Also set the matrices of the parts
+
+	private:
+		std::vector<SceneNode *> parts_;	// Parts, in the order of the merged mesh
+	}; // class CharacterNode
+} // namespace game
+#endif // CHARACTER_NODE_H_
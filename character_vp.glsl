@@ -0,0 +1,46 @@
+#version 130
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 normal;
+in vec3 color;
+in vec2 uv;
+
+// Uniform (global) buffer
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+
+// World and normal matrices of each part, indexed by the red channel of the color
+// The size must match MAX_CHARACTER_PARTS
+uniform mat4 part_mat[8];
+uniform mat4 part_normal_mat[8];
+
+// Attributes forwarded to the fragment shader
+out vec3 position_interp;
+out vec3 normal_interp;
+out vec4 color_interp;
+out vec2 uv_interp;
+out vec3 light_pos;
+
+// Material attributes (constants)
+uniform vec3 light_position = vec3(-0.5, 100, 10.5);
+
+
+void main()
+{
+    int part = int(color.r + 0.5);
+    mat4 world_mat = part_mat[part];
+    mat4 normal_mat = part_normal_mat[part];
+
+    gl_Position = projection_mat * view_mat * world_mat * vec4(vertex, 1.0);
+
+    position_interp = vec3(view_mat * world_mat * vec4(vertex, 1.0));
+    
+    normal_interp = vec3(normal_mat * vec4(normal, 0.0));
+
+    color_interp = vec4(color, 1.0);
+
+    uv_interp = uv;
+
+    light_pos = vec3(view_mat * vec4(light_position, 1.0));
+}
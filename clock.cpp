@@ -0,0 +1,27 @@
+#include "clock.h"
+
+// CLOCK
+namespace game
+{
+	double Clock::step_ = 0.0;
+	double Clock::time_ = 0.0;
+	const std::chrono::steady_clock::time_point Clock::start_ = std::chrono::steady_clock::now();
+
+	double Clock::GetTime(void)
+	{
+		if (step_ > 0.0) { return time_; }
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+	void Clock::SetFixedStep(double step)
+	{
+		// Carry on from the current time, so running timers do not jump
+		time_ = GetTime();
+		step_ = step;
+	}
+
+	double Clock::GetFixedStep(void) { return step_; }
+	void Clock::Reset(void) { time_ = 0.0; }
+
+	void Clock::Tick(void) { if (step_ > 0.0) { time_ += step_; } }
+} // namespace game
@@ -0,0 +1,27 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <chrono>
+
+// CLOCK
+namespace game
+{
+	// Time seen by the simulation. It follows the wall clock, unless a fixed step is set:
+	// then it only moves when Tick is called, so headless runs go as fast as the CPU allows
+	// and give the same results every time
+	class Clock
+	{
+	public:
+		static double GetTime(void);			// Seconds since the start of the game
+		static void SetFixedStep(double step);	// Advance by step seconds on each Tick, 0 to follow the wall clock again
+		static double GetFixedStep(void);
+		static void Reset(void);				// Start a fixed-step time again from zero, so that replays see the same times
+		static void Tick(void);					// End a simulation step
+
+	private:
+		static double step_;	// Seconds per tick, 0 when following the wall clock
+		static double time_;	// Simulated time
+		static const std::chrono::steady_clock::time_point start_;	// Start of the game
+	}; // class Clock
+} // namespace game
+#endif // CLOCK_H_
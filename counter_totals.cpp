@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "counter_totals.h"
+
+// COUNTER TOTALS
+namespace game
+{
+	/* Constructor */
+	CounterTotals::CounterTotals(void)
+	{
+		num_frames_ = 0;
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			total_[i] = 0;
+			peak_[i] = 0;
+		}
+	}
+
+	/* Destructor */
+	CounterTotals::~CounterTotals() {}
+
+	void CounterTotals::AddFrame(const long long counter[NUM_COUNTERS])
+	{
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			total_[i] += counter[i];
+			peak_[i] = std::max(peak_[i], counter[i]);
+		}
+		num_frames_++;
+	}
+
+	int CounterTotals::GetNumFrames(void) const { return num_frames_; }
+
+	void CounterTotals::Load(const std::string filename)
+	{
+		std::ifstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		num_frames_ = -1;
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			total_[i] = -1;
+			peak_[i] = -1;
+		}
+
+		// "frames N", then "counter total peak" lines, # starts a comment
+		std::string line;
+		while (std::getline(f, line))
+		{
+			line = line.substr(0, line.find('#'));
+			std::istringstream in(line);
+			std::string name;
+			if (!(in >> name)) { continue; }	// Empty line
+			if (name == "frames")
+			{
+				if (!(in >> num_frames_)) { throw(std::invalid_argument(std::string("Missing frame count in ") + filename)); }
+				continue;
+			}
+
+			int i = 0;
+			while (i < NUM_COUNTERS && name != Counters::GetName((Counter)i)) { i++; }
+			if (i == NUM_COUNTERS) { throw(std::invalid_argument(std::string("Unknown counter ") + name + std::string(" in ") + filename)); }
+			if (!(in >> total_[i] >> peak_[i])) { throw(std::invalid_argument(std::string("Missing total or peak of counter ") + name + std::string(" in ") + filename)); }
+		}
+		if (num_frames_ < 0) { throw(std::invalid_argument(std::string("Missing frame count in ") + filename)); }
+	}
+
+	void CounterTotals::Save(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		f << "# counter total peak" << std::endl;
+		f << "frames " << num_frames_ << std::endl;
+		for (int i = 0; i < NUM_COUNTERS; i++) { f << Counters::GetName((Counter)i) << " " << total_[i] << " " << peak_[i] << std::endl; }
+	}
+
+	bool CounterTotals::Check(const CounterTotals &baseline, std::ostream &out) const
+	{
+		// Counts of runs of different lengths cannot be compared
+		if (num_frames_ != baseline.num_frames_)
+		{
+			out << "Counter check: " << num_frames_ << " frames, the baseline has " << baseline.num_frames_ << std::endl;
+			return false;
+		}
+
+		bool passed = true;
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			if (baseline.total_[i] >= 0 && total_[i] > baseline.total_[i])
+			{
+				out << "Counter check: " << Counters::GetName((Counter)i) << " total " << total_[i] << ", baseline " << baseline.total_[i] << std::endl;
+				passed = false;
+			}
+			if (baseline.peak_[i] >= 0 && peak_[i] > baseline.peak_[i])
+			{
+				out << "Counter check: " << Counters::GetName((Counter)i) << " peak " << peak_[i] << ", baseline " << baseline.peak_[i] << std::endl;
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	void CounterTotals::Print(std::ostream &out) const
+	{
+		out << "Counters over " << num_frames_ << " frames" << std::endl;
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			out << std::left << std::setw(20) << Counters::GetName((Counter)i) << std::right
+				<< "total " << std::setw(12) << total_[i] << "   peak " << std::setw(10) << peak_[i] << std::endl;
+		}
+	}
+} // namespace game
@@ -0,0 +1,34 @@
+#ifndef COUNTER_TOTALS_H_
+#define COUNTER_TOTALS_H_
+
+#include <string>
+#include <ostream>
+
+#include "counters.h"
+
+// COUNTER TOTALS
+// Counters of a whole run, to compare a replayed scenario with a checked-in baseline.
+// The counts are exact, so unlike timings they can be checked on any machine
+namespace game
+{
+	class CounterTotals
+	{
+	public:
+		CounterTotals(void);
+		~CounterTotals();
+
+		void AddFrame(const long long counter[NUM_COUNTERS]);
+		int GetNumFrames(void) const;
+
+		void Load(const std::string filename);			// Baseline, counters missing from the file are not checked
+		void Save(const std::string filename) const;
+		bool Check(const CounterTotals &baseline, std::ostream &out) const;	// Whether no counter is over the baseline, reporting those that are
+		void Print(std::ostream &out) const;
+
+	private:
+		int num_frames_;
+		long long total_[NUM_COUNTERS];		// Sum over the frames, -1 when not checked
+		long long peak_[NUM_COUNTERS];		// Largest count of one frame, -1 when not checked
+	}; // class CounterTotals
+} // namespace game
+#endif // COUNTER_TOTALS_H_
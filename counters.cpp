@@ -0,0 +1,43 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "counters.h"
+
+// COUNTERS
+namespace game
+{
+	// Names of the counters, in the order of Counter
+	static const char *counter_name_g[NUM_COUNTERS] = {
+		"draw_calls", "program_switches", "texture_binds", "buffer_binds", "uniform_uploads",
+		"nodes_visited", "nodes_drawn", "nodes_culled",
+		"collisions_tested", "allocations", "resources_created", "entities_alive" };
+
+	// Plain array so that it is ready before any allocation of the static constructors
+	static std::atomic<long long> counter_g[NUM_COUNTERS];
+
+	void Counters::Add(Counter counter, long long amount)
+	{
+		counter_g[counter].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	void Counters::Collect(long long value[NUM_COUNTERS])
+	{
+		for (int i = 0; i < NUM_COUNTERS; i++) { value[i] = counter_g[i].exchange(0, std::memory_order_relaxed); }
+	}
+
+	const char *Counters::GetName(Counter counter) { return counter_name_g[counter]; }
+} // namespace game
+
+/* Allocations, every new of the program goes through these */
+void *operator new(std::size_t size)
+{
+	game::Counters::Add(game::CounterAllocations);
+	void *p = std::malloc(size ? size : 1);
+	if (!p) { throw(std::bad_alloc()); }
+	return p;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
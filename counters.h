@@ -0,0 +1,23 @@
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+// COUNTERS
+// Exact counts of the work done each frame, cheap enough to always be on.
+// Any thread may add to them; the main thread collects them once per frame
+namespace game
+{
+	// The OpenGL calls are counted by the wrappers of gl_calls.h; entities alive is set once per frame rather than added up
+	typedef enum CounterType {
+		CounterDrawCalls, CounterProgramSwitches, CounterTextureBinds, CounterBufferBinds, CounterUniformUploads,
+		CounterNodesVisited, CounterNodesDrawn, CounterNodesCulled,
+		CounterCollisionsTested, CounterAllocations, CounterResourcesCreated, CounterEntitiesAlive, NUM_COUNTERS } Counter;
+
+	class Counters
+	{
+	public:
+		static void Add(Counter counter, long long amount = 1);
+		static void Collect(long long value[NUM_COUNTERS]);	// Counts since the last collect, which start again from zero
+		static const char *GetName(Counter counter);
+	}; // class Counters
+} // namespace game
+#endif // COUNTERS_H_
@@ -11,6 +11,13 @@ uniform mat4 view_mat;
 uniform mat4 normal_mat;
 uniform float timer;
 
+// Instances drawn in one call by the particle system manager
+#define MAX_PARTICLE_INSTANCES 16
+uniform int num_instances = 0; // 0 when the node is drawn on its own
+uniform mat4 instance_world_mat[MAX_PARTICLE_INSTANCES];
+uniform mat4 instance_normal_mat[MAX_PARTICLE_INSTANCES];
+uniform float instance_timer[MAX_PARTICLE_INSTANCES];
+
 // Attributes forwarded to the geometry shader
 out vec4 particle_color;
 out float particle_id;
@@ -28,12 +35,23 @@ const float two_pi = 2.0*pi;
 
 void main()
 {
+    // Matrices and timer of the instance, or of the node
+    mat4 world = world_mat;
+    mat4 normal_world = normal_mat;
+    float time = timer;
+    if (num_instances > 0)
+    {
+        world = instance_world_mat[gl_InstanceID];
+        normal_world = instance_normal_mat[gl_InstanceID];
+        time = instance_timer[gl_InstanceID];
+    }
+
     // Define particle id
     particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
 
     // Define time in a cyclic manner
     float phase = two_pi*particle_id; // Start the sin wave later depending on the particle_id
-    float param = timer / 10.0 + phase; // The constant that divides "timer" also helps to adjust the "speed" of the fire
+    float param = time / 10.0 + phase; // The constant that divides "timer" also helps to adjust the "speed" of the fire
     float rem = mod(param, pi_over_two); // Use the remainder of dividing by pi/2 so that we are always in the range [0..pi/2] where sin() gives values in [0..1]
     float circtime = sin(rem); // Get time value in [0..1], according to a sinusoidal wave
                                     
@@ -45,7 +63,7 @@ void main()
     position += speed*up_vec*accel*t*t; // Particle moves up
     
     // Define output position but do not apply the projection matrix yet
-    gl_Position = view_mat * world_mat * vec4(position, 1.0);
+    gl_Position = view_mat * world * vec4(position, 1.0);
     
     // Define amount of blending depending on the cyclic time
     float alpha = 1.0 - circtime*circtime;
@@ -0,0 +1,38 @@
+#include "frame_timer.h"
+
+// FRAME TIMER
+namespace game
+{
+	// Names of the phases, in the order of FramePhase
+	static const char *frame_phase_name_g[NUM_FRAME_PHASES] = { "load", "input", "draw", "collision", "update" };
+
+	/* Constructor */
+	FrameTimer::FrameTimer(void) { Start(); }
+
+	/* Destructor */
+	FrameTimer::~FrameTimer() {}
+
+	void FrameTimer::Start(void)
+	{
+		for (int i = 0; i < NUM_FRAME_PHASES; i++) { phase_time_[i] = 0.0; }
+		lap_ = std::chrono::steady_clock::now();
+	}
+
+	void FrameTimer::Lap(FramePhase phase)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		phase_time_[phase] += std::chrono::duration<double>(now - lap_).count();
+		lap_ = now;
+	}
+
+	double FrameTimer::GetPhaseTime(FramePhase phase) const { return phase_time_[phase]; }
+
+	double FrameTimer::GetFrameTime(void) const
+	{
+		double total = 0.0;
+		for (int i = 0; i < NUM_FRAME_PHASES; i++) { total += phase_time_[i]; }
+		return total;
+	}
+
+	const char *FrameTimer::GetPhaseName(FramePhase phase) { return frame_phase_name_g[phase]; }
+} // namespace game
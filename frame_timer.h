@@ -0,0 +1,31 @@
+#ifndef FRAME_TIMER_H_
+#define FRAME_TIMER_H_
+
+#include <chrono>
+
+// FRAME TIMER
+namespace game
+{
+	// Phases of a frame, in the order they run
+	typedef enum FramePhaseType { PhaseLoad, PhaseInput, PhaseDraw, PhaseCollision, PhaseUpdate, NUM_FRAME_PHASES } FramePhase;
+
+	// Wall-clock time of each phase of the current frame, measured as laps
+	class FrameTimer
+	{
+	public:
+		FrameTimer(void);
+		~FrameTimer();
+
+		void Start(void);					// Start timing a frame, clearing the last one
+		void Lap(FramePhase phase);			// Add the time since the last Start or Lap to a phase
+		double GetPhaseTime(FramePhase phase) const;	// Seconds
+		double GetFrameTime(void) const;	// Seconds, all phases together
+
+		static const char *GetPhaseName(FramePhase phase);
+
+	private:
+		double phase_time_[NUM_FRAME_PHASES];
+		std::chrono::steady_clock::time_point lap_;
+	}; // class FrameTimer
+} // namespace game
+#endif // FRAME_TIMER_H_
@@ -1,8 +1,14 @@
  #include <iostream>
 #include <time.h>
 #include <sstream>
+#include <iomanip>
+#include <chrono>
 
 #include "game.h"
+#include "clock.h"
+#include "profiler.h"
+#include "trace.h"
+#include "counters.h"
 #include "bin/path_config.h"
 
 // Spacebar to shoot rocket
@@ -12,6 +18,7 @@
 // Z and C to roll the camera
 // Ascent and Descent are Q and E respectively
 // G to get a draggable object when close enough to it
+// F9 to record a trace of the next frames
 // Esc to quit 
 namespace game 
 {
@@ -36,24 +43,79 @@ namespace game
 
 	const std::string material_directory_g = MATERIAL_DIRECTORY;	// Materials 
 
+	// Time spent creating OpenGL objects for loaded resources each frame, while the menu is shown
+	const double loading_time_budget_g = 0.008;
+
+	// Draw the parts of humans and spiders as one merged mesh per character
+	const bool merge_characters_g = true;
+
+	// Draw particles as instanced quads instead of expanding points in geometry programs,
+	// which is slow on some drivers (llvmpipe among them)
+	const bool particle_quads_g = false;
+
+	// Simulated seconds per tick of a headless game
+	const double headless_time_step_g = 1.0 / 60.0;
+
+	// Longest time a recorded tick moves the clock, longer frames (a hitch, a breakpoint) are kept short
+	const double max_recorded_step_g = 0.25;
+
 	Game::Game(void) {}
 	Game::~Game() { glfwTerminate(); }
 
-	void Game::Init(void) 
+	void Game::Init(bool headless) 
 	{
-		// Run all initialization steps
-		InitWindow();
+		// Run all initialization steps, a headless game only needs the camera
+		headless_ = headless;
+		Trace::SetThreadName("main");
+		window_ = NULL;
+		if (!headless_) { InitWindow(); }
+		else { Clock::SetFixedStep(headless_time_step_g); }	// Timers follow the simulation instead of the wall clock
 		InitView();
-		InitEventHandlers();
+		if (!headless_) { InitEventHandlers(); }
 
 		// Set variables
 		animating_ = true;
 		gamestart_ = false;
+		worldready_ = false;
+		stress_ = false;
+		loader_ = NULL;
+		menuNode = NULL;
+		inputTime_ = -1.0;
 		world = new SceneNode("world", 0, 0, 0);	// Dummy Node
 		scene_.SetRoot(world);						// Set dummy as Root of Heirarchy
 		world->AddChild(camNode);					// Set the camera as a child of the world
 	}
 
+	void Game::SetStress(const StressConfig &config)
+	{
+		stress_ = true;
+		config_ = config;
+		if (window_) { glfwSwapInterval(0); }	// Frames are not held back by the display
+
+		// Counters of a replayed run only match the baseline if the simulation does not follow the wall clock
+		if (!config_.write_counters.empty() || !config_.check_counters.empty()) { Clock::SetFixedStep(headless_time_step_g); }
+	}
+
+	void Game::SetHitchBudget(double budget) { hitches_.SetBudget(budget); }
+
+	void Game::SetInputRecord(const std::string filename)
+	{
+		inputFile_ = filename;
+		inputLog_.Record();
+
+		// The clock moves by the wall time of each tick, which is recorded for the replay
+		Clock::SetFixedStep(headless_time_step_g);
+		Clock::Reset();
+	}
+
+	void Game::SetInputReplay(const std::string filename)
+	{
+		inputFile_ = filename;
+		inputLog_.Replay(filename);
+		Clock::SetFixedStep(headless_time_step_g);
+		Clock::Reset();
+	}
+
 	void Game::InitWindow(void) 
 	{
 		// Initialize the window management library (GLFW)
@@ -80,14 +142,18 @@ namespace game
 
 	void Game::InitView(void)
 	{
-		// Set up z-buffer
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LESS);
+		int width = window_width_g;
+		int height = window_height_g;
+		if (!headless_)
+		{
+			// Set up z-buffer
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_LESS);
 
-		// Set viewport
-		int width, height;
-		glfwGetFramebufferSize(window_, &width, &height);
-		glViewport(0, 0, width, height);
+			// Set viewport
+			glfwGetFramebufferSize(window_, &width, &height);
+			glViewport(0, 0, width, height);
+		}
 
 		/* Set up camera */
 		camera_.SetView(camera_position_g, camera_look_at_g, camera_up_g);		// Set current view
@@ -109,169 +175,227 @@ namespace game
 
 	void Game::SetupResources(void)
 	{
-		/* Create Built-In Geometries */
-		resman_.CreateCylinder("rocketMesh");
+		// Headless games draw nothing, their nodes are made without resources
+		if (headless_) { return; }
+
+		// Reuse shader programs linked by previous runs
+		resman_.SetShaderCacheDirectory(SHADER_CACHE_DIRECTORY);
+		// Reuse meshes simplified and optimized by previous runs
+		resman_.SetMeshCacheDirectory(MESH_CACHE_DIRECTORY);
+
+		/* Resources for the menu screen, loaded right away so the menu can be drawn */
 		resman_.CreateWall("wallMesh");
-		resman_.CreateSphere("simpleSphereMesh");
-		resman_.CreateCylinder("targetMesh", 0.1, 0.6, 0.35, 4, 4, glm::vec3(1,0,0));
-		resman_.CreateCube("CubeMesh");
-		resman_.CreateSphereParticles("SphereParticle");
-		resman_.CreateTorusParticles("TorusParticle", 20000, 0.002, 0.002);
-		resman_.CreateTorusParticles("RingParticle");
-		resman_.CreateConeParticles("ConeParticle");
-		resman_.CreateControlPoints("ControlPoints", 64);
+		std::string filename = std::string(MATERIAL_DIRECTORY) + std::string("/texture");
+		resman_.LoadResource(Material, "textureMaterial", filename.c_str());
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/menuscreen.jpg");
+		resman_.LoadResource(Texture, "menuTex", filename.c_str());
+
+		scene_.SetupDrawToTexture();
+
+		/* Everything else is loaded in the background while the menu is shown */
+		loader_ = new ResourceLoader(&resman_);
+		ResourceManager *resman = &resman_;
+
+		/* Create Built-In Geometries */
+		loader_->AddUpload([resman]() { resman->CreateCylinder("rocketMesh"); });
+		loader_->AddUpload([resman]() { resman->CreateSphere("simpleSphereMesh"); });
+		loader_->AddUpload([resman]() { resman->CreateCylinder("targetMesh", 0.1, 0.6, 0.35, 4, 4, glm::vec3(1, 0, 0)); });
+		loader_->AddUpload([resman]() { resman->CreateCube("CubeMesh"); });
+		loader_->AddUpload([resman]() { resman->CreateSphereParticles("SphereParticle"); });
+		loader_->AddUpload([resman]() { resman->CreateTorusParticles("TorusParticle", 20000, 0.002, 0.002); });
+		loader_->AddUpload([resman]() { resman->CreateTorusParticles("RingParticle"); });
+		loader_->AddUpload([resman]() { resman->CreateConeParticles("ConeParticle"); });
+		loader_->AddUpload([resman]() { resman->CreateControlPoints("ControlPoints", 64); });
 
 		/* Loading Material for Particle System */
-		std::string filename = std::string(MATERIAL_DIRECTORY) + std::string("/fire");
-		resman_.LoadResource(Material, "FireMaterial", filename.c_str());
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/fire");
+		loader_->LoadParticleMaterial("FireMaterial", filename.c_str(), particle_quads_g);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/particle");
-		resman_.LoadResource(Material, "ExplosionMaterial", filename.c_str());
+		loader_->LoadParticleMaterial("ExplosionMaterial", filename.c_str(), particle_quads_g);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/death");
-		resman_.LoadResource(Material, "deathMaterial", filename.c_str());
+		loader_->LoadParticleMaterial("deathMaterial", filename.c_str(), particle_quads_g);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/bullet");
-		resman_.LoadResource(Material, "bulletMaterial", filename.c_str());
+		loader_->LoadParticleMaterial("bulletMaterial", filename.c_str(), particle_quads_g);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/spline");
-		resman_.LoadResource(Material, "splineMaterial", filename.c_str());
+		loader_->LoadParticleMaterial("splineMaterial", filename.c_str(), particle_quads_g);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/ring");
-		resman_.LoadResource(Material, "ringMaterial", filename.c_str());
+		loader_->LoadParticleMaterial("ringMaterial", filename.c_str(), particle_quads_g);
+
+		/* Materials simulating and drawing the GPU particles */
+		std::vector<std::string> varyings;
+		varyings.push_back("out_position");
+		varyings.push_back("out_velocity");
+		varyings.push_back("out_age");
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/gpu_particle_update");
+		loader_->LoadFeedbackMaterial("gpuParticleUpdateMaterial", filename.c_str(), varyings);
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/gpu_particle");
+		loader_->LoadResource(Material, "gpuParticleMaterial", filename.c_str());
+
+		/* Version of the texture material for the multi-draw indirect pass, when the driver has one */
+		if (IndirectRenderer::IsSupported())
+		{
+			filename = std::string(MATERIAL_DIRECTORY) + std::string("/texture_indirect");
+			loader_->LoadResource(Material, "textureIndirectMaterial", filename.c_str());
+		}
 		
 		/* Loading PointSet for Particle System */
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanBody.obj");
-		resman_.LoadResource(PointSet, "humanBodyParticle", filename.c_str(), 200000);
+		loader_->LoadResource(PointSet, "humanBodyParticle", filename.c_str(), 200000);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftHand.obj");
-		resman_.LoadResource(PointSet, "humanLeftParticle", filename.c_str(), 200000);
+		loader_->LoadResource(PointSet, "humanLeftParticle", filename.c_str(), 200000);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightHand.obj");
-		resman_.LoadResource(PointSet, "humanRightParticle", filename.c_str(), 200000);
+		loader_->LoadResource(PointSet, "humanRightParticle", filename.c_str(), 200000);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftLeg.obj");
-		resman_.LoadResource(PointSet, "humanLeftLegParticle", filename.c_str(), 200000);
+		loader_->LoadResource(PointSet, "humanLeftLegParticle", filename.c_str(), 200000);
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightLeg.obj");
-		resman_.LoadResource(PointSet, "humanRightLegParticle", filename.c_str(), 200000);
+		loader_->LoadResource(PointSet, "humanRightLegParticle", filename.c_str(), 200000);
 
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/dragonflyfull.obj");
-		resman_.LoadResource(PointSet, "dragonFlyParticle", filename.c_str());
+		loader_->LoadResource(PointSet, "dragonFlyParticle", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/flyfull.obj");
-		resman_.LoadResource(PointSet, "flyParticle", filename.c_str());
+		loader_->LoadResource(PointSet, "flyParticle", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanfull.obj");
-		resman_.LoadResource(PointSet, "humanParticle", filename.c_str());
+		loader_->LoadResource(PointSet, "humanParticle", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderfull.obj");
-		resman_.LoadResource(PointSet, "spiderParticle", filename.c_str());
+		loader_->LoadResource(PointSet, "spiderParticle", filename.c_str());
 
 		/* Create Resources */
 
 		/* MATERIAL GLSL FILES */
 		// OBJECT MATREIAL FOR GENERAL OBJECTS
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/material");
-		resman_.LoadResource(Material, "objectMaterial", filename.c_str());
-
-		// TEXTURE MATERIAL FOR OBJECTS THAT HAVE TEXTURES
-		filename = std::string(MATERIAL_DIRECTORY) + std::string("/texture");
-		resman_.LoadResource(Material, "textureMaterial", filename.c_str());
+		loader_->LoadResource(Material, "objectMaterial", filename.c_str());
 
 		/* TEXTURES */
 
 		// WEB TEXTURE
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/webTexture.png");
-		resman_.LoadResource(Texture, "webTex", filename.c_str());
+		loader_->LoadResource(Texture, "webTex", filename.c_str());
 
 		// ROCKET TEXTURE
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/rocketTexture.png");
-		resman_.LoadResource(Texture, "rocketTex", filename.c_str());
+		loader_->LoadResource(Texture, "rocketTex", filename.c_str());
 
 		// HUMAN TEXTURE
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/skin.png");
-		resman_.LoadResource(Texture, "humanTex", filename.c_str());
+		loader_->LoadResource(Texture, "humanTex", filename.c_str());
 
 		// FLY TEXTURES
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/flyBodyTexture.png");
-		resman_.LoadResource(Texture, "flyBodyTex", filename.c_str());
+		loader_->LoadResource(Texture, "flyBodyTex", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/flyWingsTexture.png");
-		resman_.LoadResource(Texture, "flyWingsTex", filename.c_str());
+		loader_->LoadResource(Texture, "flyWingsTex", filename.c_str());
 
 		// SPIDER TEXTURES
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/spiderBodyTexture.png");
-		resman_.LoadResource(Texture, "spiderBodyTex", filename.c_str());
+		loader_->LoadResource(Texture, "spiderBodyTex", filename.c_str());
 
 		// DRAGONFLY TEXTURES
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/dragonFlyBodyTexture.png");
-		resman_.LoadResource(Texture, "dragonFlyBodyTex", filename.c_str());
+		loader_->LoadResource(Texture, "dragonFlyBodyTex", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/dragonFlyWingsTexture.png");
-		resman_.LoadResource(Texture, "dragonFlyWingsTex", filename.c_str());
+		loader_->LoadResource(Texture, "dragonFlyWingsTex", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/dragonFlyLegsTexture.png");
-		resman_.LoadResource(Texture, "dragonFlyLegsTex", filename.c_str());
+		loader_->LoadResource(Texture, "dragonFlyLegsTex", filename.c_str());
 
 		// ENVIRONMENT TEXTURES
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/floorTexture.jpg");
-		resman_.LoadResource(Texture, "floorTex", filename.c_str());
+		loader_->LoadResource(Texture, "floorTex", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/Cubes-3D-wall-panels-close-up-604x330.jpg");
-		resman_.LoadResource(Texture, "wallTex", filename.c_str());
+		loader_->LoadResource(Texture, "wallTex", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/sky-texture.jpg");
-		resman_.LoadResource(Texture, "skyTex", filename.c_str());
+		loader_->LoadResource(Texture, "skyTex", filename.c_str());
 
 		// BLOCK TEXTURE
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/metalTexture.png");
-		resman_.LoadResource(Texture, "blockTex", filename.c_str());
+		loader_->LoadResource(Texture, "blockTex", filename.c_str());
 
 		// FIRE TEXTURE
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/flame4x4orig.png");
-		resman_.LoadResource(Texture, "Flame", filename.c_str());
-
-		// MENU TEXTURE 
-		filename = std::string(MATERIAL_DIRECTORY) + std::string("/textures/menuscreen.jpg");
-		resman_.LoadResource(Texture, "menuTex", filename.c_str());
+		loader_->LoadResource(Texture, "Flame", filename.c_str());
 
 		/* GEOMETRIES */
 
 		// HUMAN BODY LEFT AND RIGHT HANDS AND LEGS
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanBody.obj");
-		resman_.LoadResource(Mesh, "humanBodyMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "humanBodyMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftHand.obj");
-		resman_.LoadResource(Mesh, "humanLeftHandMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "humanLeftHandMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightHand.obj");
-		resman_.LoadResource(Mesh, "humanRightHandMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "humanRightHandMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftLeg.obj");
-		resman_.LoadResource(Mesh, "humanLeftLegMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "humanLeftLegMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightLeg.obj");
-		resman_.LoadResource(Mesh, "humanRightLegMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "humanRightLegMesh", filename.c_str());
 
 		//healthBar->SetScale(healthBar->GetScale() - glm::vec3(health * (1.0 / 3.2), 0.0, 0.0));
 		// SPIDER BODY and RIGHT AND LEFT LEGS
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderBody.obj");
-		resman_.LoadResource(Mesh, "spiderBodyMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "spiderBodyMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderLeftLeg.obj");
-		resman_.LoadResource(Mesh, "spiderLeftLegMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "spiderLeftLegMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderRightLeg.obj");
-		resman_.LoadResource(Mesh, "spiderRightLegMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "spiderRightLegMesh", filename.c_str());
+
+		// HUMAN AND SPIDER PARTS MERGED, in the order the parts are added to their character node
+		if (merge_characters_g)
+		{
+			std::vector<std::string> parts;
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanBody.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftHand.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightHand.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanLeftLeg.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/humanRightLeg.obj"));
+			loader_->LoadMergedMesh("humanMergedMesh", parts);
+
+			parts.clear();
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderBody.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderLeftLeg.obj"));
+			parts.push_back(std::string(MATERIAL_DIRECTORY) + std::string("/assets/spiderRightLeg.obj"));
+			loader_->LoadMergedMesh("spiderMergedMesh", parts);
+
+			filename = std::string(MATERIAL_DIRECTORY) + std::string("/character");
+			loader_->LoadResource(Material, "characterMaterial", filename.c_str());
+		}
 
 		// DRAGONFLY BODY, RIGHT and LEFT WINGS and LEGS
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/dragonFlyBody.obj");
-		resman_.LoadResource(Mesh, "dragonFlyBodyMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "dragonFlyBodyMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/dragonFlyLeftWing.obj");
-		resman_.LoadResource(Mesh, "dragonFlyLeftWingMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "dragonFlyLeftWingMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/dragonFlyRightWing.obj");
-		resman_.LoadResource(Mesh, "dragonFlyRightWingMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "dragonFlyRightWingMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/dragonFlyLegs.obj");
-		resman_.LoadResource(Mesh, "dragonFlyLegsMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "dragonFlyLegsMesh", filename.c_str());
 
 		// FLY BODY WINGS AND LEGS
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/flyBody.obj");
-		resman_.LoadResource(Mesh, "flyBodyMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "flyBodyMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/flyWings.obj");
-		resman_.LoadResource(Mesh, "flyWingsMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "flyWingsMesh", filename.c_str());
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/assets/flyLegs.obj");
-		resman_.LoadResource(Mesh, "flyLegsMesh", filename.c_str());
+		loader_->LoadResource(Mesh, "flyLegsMesh", filename.c_str());
 
 		//loading material for the screen-space effect
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/screen_space");
-		resman_.LoadResource(Material, "ScreenSpaceMaterial", filename.c_str());
-
-		scene_.SetupDrawToTexture();
+		loader_->LoadResource(Material, "ScreenSpaceMaterial", filename.c_str());
 	}
 
 	/* Setup game elements */
 	void Game::SetupScene(void)
 	{
 		scene_.SetBackgroundColor(viewport_background_color_g);		// Set background color for the scene
-		//scene_.SetUpHealthData();                                   // Set up data for the screen space effect
+		scene_.SetUpHealthData();                                   // Set up data for the screen space effect
+
+		/* Headless games skip the menu and start right away */
+		if (headless_)
+		{
+			SetupWorld();
+			worldready_ = true;
+			gamestart_ = true;
+			player->body->SetVisible(true);
+			return;
+		}
 
 		/* Menu Screen */
 		menuNode = createSceneNode("menuInstance", "wallMesh", "textureMaterial", "menuTex");
@@ -279,96 +403,51 @@ namespace game
 		menuNode->SetPosition(camera_.GetPosition());
 		menuNode->Translate(glm::vec3(0, 0, -1.3));
 		world->AddChild(menuNode);
-		
+	}
+
+	/* Setup the game world, once all resources are loaded */
+	void Game::SetupWorld(void)
+	{
+		/* Draw opaque textured meshes with multi-draw indirect */
+		Resource *indirect = resman_.GetResource("textureIndirectMaterial");
+		if (indirect)
+		{
+			scene_.SetIndirectProgram(resman_.GetResource("textureMaterial")->GetResource(), indirect->GetResource());
+		}
+
 		/* creating ParticleNode */
-		dragonFlyParticle = createParticle("dragonFlyParticleInstance", "dragonFlyParticle", "ExplosionMaterial", "", glm::vec3(40, 40, 40));
-		spiderParticle = createParticle("spiderParticleInstance", "spiderParticle", "deathMaterial", "", glm::vec3(0.02, 0.02, 0.02));
-		humanParticle = createParticle("humanParticleInstance", "humanParticle", "FireMaterial", "Flame", glm::vec3(1, 1, 1));
-		flyParticle = createParticle("flyParticleInstance", "flyParticle", "ExplosionMaterial", "", glm::vec3(1, 1, 1));
-		humanParticleRing = createParticle("humanParticleInstance2", "humanParticle", "ringMaterial", "", glm::vec3(1, 1, 1));
+		/* creating particle effects, a burning human ends with a ring */
+		createParticleEffect("dragonFlyDeath", "dragonFlyParticle", "ExplosionMaterial", "", glm::vec3(40, 40, 40), 3);
+		createParticleEffect("spiderDeath", "spiderParticle", "deathMaterial", "", glm::vec3(0.02, 0.02, 0.02), 3);
+		createParticleEffect("humanDeath", "humanParticle", "FireMaterial", "Flame", glm::vec3(1, 1, 1), 5, "humanRing");
+		createParticleEffect("humanRing", "humanParticle", "ringMaterial", "", glm::vec3(1, 1, 1), 4);
+		createParticleEffect("flyExplosion", "flyParticle", "ExplosionMaterial", "", glm::vec3(1, 1, 1), 3);
 		ringParticle1 = createParticle("ringInstance1", "RingParticle", "ringMaterial", "", glm::vec3(0.8, 0.8, 0.8));
 		ringParticle2 = createParticle("ringInstance2", "RingParticle", "ringMaterial", "", glm::vec3(0.8, 0.8, 0.8));
+		sparkParticle = createGpuParticle("sparkParticleInstance", 100000, -30.0);	// Floor of the rooms
+
+		/* One batch draws the particles of every web */
+		webBatch = new WebBatch("webBatch", findResource("TorusParticle"), findResource("splineMaterial"));
+		if (!headless_)
+		{
+			Resource *cp = resman_.GetResource("ControlPoints");
+			webBatch->SetControlPoints(cp->GetData(), cp->GetSize());
+		}
+		world->AppendChild(webBatch);
 		
 		player = createFly("player");											
 		player->body->SetVisible(false);
 		target = createTarget("playerTarget");																			
 		player->healthBar = createHealthBar("playerHealthBar");										
 
-		int randomx;
-		int randomz;
-
-		//creating human
-		for (int i = 0; i < 5; i++)
-		{
-			//choosing which room to go
-			if (rand() % 2 == 0)
-			{
-				randomx = rand() % 500 - 250;
-				randomz = rand() % 500 - 250;
-				createHuman("human", glm::vec3(randomx, 0, randomz));
-			}
-			else
-			{
-				randomx = rand() % 500 + 230;
-				randomz = rand() % 500 - 850;
-				createHuman("human", glm::vec3(randomx, 0, randomz));
-			}
-		}
-
-		//creating spider
-		for (int i = 0; i < 5; i++)
-		{
-			//choosing which room to go
-			if (rand() % 2 == 0)
-			{
-				randomx = rand() % 500 - 250;
-				randomz = rand() % 500 - 250;
-				createSpider("spider", glm::vec3(randomx, 0, randomz));
-			}
-			else
-			{
-				randomx = rand() % 500 + 230;
-				randomz = rand() % 500 - 850;
-				createSpider("spider", glm::vec3(randomx, 0, randomz));
-			}
-		}
-
-		//creating dragonfly
-		for (int i = 0; i < 5; i++)
-
-		{
-			//choosing which room to go
-			if (rand() % 2 == 0)
-			{
-				randomx = rand() % 500 - 250;
-				randomz = rand() % 500 - 250;
-				createDragonFly("dragonfly", glm::vec3(randomx, 0, randomz));
-			}
-			else
-			{
-				randomx = rand() % 500 + 230;
-				randomz = rand() % 500 - 850;
-				createDragonFly("dragonfly", glm::vec3(randomx, 0, randomz));
-			}
-		}
-
-		//creating block
-		for (int i = 0; i < 7; i++)
-		{
-			//choosing which room to go
-			if (rand() % 2 == 0)
-			{
-				randomx = rand() % 500 - 250;
-				randomz = rand() % 500 - 250;
-				createBlock("block", glm::vec3(randomx, -20.3, randomz));
-			}
-			else
-			{
-				randomx = rand() % 500 + 230;
-				randomz = rand() % 500 - 850;
-				createBlock("block", glm::vec3(randomx, -20.3, randomz));
-			}
-		}
+		/* Enemies and blocks, where the layout puts them; a replay uses the seed of the recorded game */
+		if (inputLog_.IsReplaying()) { config_.seed = inputLog_.GetSeed(); }
+		else { inputLog_.SetSeed(config_.seed); }
+		srand(config_.seed);
+		for (int i = 0; i < config_.num_humans; i++) { createHuman("human", SpawnPosition(config_.layout, 0, i, config_.num_humans, 0)); }
+		for (int i = 0; i < config_.num_spiders; i++) { createSpider("spider", SpawnPosition(config_.layout, 1, i, config_.num_spiders, 0)); }
+		for (int i = 0; i < config_.num_dragonflies; i++) { createDragonFly("dragonfly", SpawnPosition(config_.layout, 2, i, config_.num_dragonflies, 0)); }
+		for (int i = 0; i < config_.num_blocks; i++) { createBlock("block", SpawnPosition(config_.layout, 3, i, config_.num_blocks, -20.3)); }
 
 		environment = new Environment();
 		room = createRoom("Room1", 0);
@@ -383,6 +462,19 @@ namespace game
 
 		//Since it is just a decoration, do we need to store the pointer of that?
 		SceneNode *sky = createSky();
+
+		/* Stress runs start right away, without the menu */
+		if (stress_)
+		{
+			gamestart_ = true;
+			if (menuNode) { menuNode->SetVisible(false); }
+			player->body->SetVisible(true);
+			recorder_.SetEnabled(true);
+
+			// The counters of the run start from here, setting up the world is not part of it
+			long long setup[NUM_COUNTERS];
+			Counters::Collect(setup);
+		}
 	}
 
 	void Game::MainLoop(void)
@@ -390,26 +482,67 @@ namespace game
 		// Loop while the user did not close the window
 		while (!glfwWindowShouldClose(window_))
 		{
+			frameTimer_.Start();
+			bool loading = !worldready_;	// Loading frames, the one setting up the world included, are slow on purpose
+
+			/* LOADING */
+			if (!worldready_)
+			{
+				loader_->ProcessUploads(loading_time_budget_g);
+				if (loader_->IsDone() && resman_.MaterialsReady())
+				{
+					resman_.FinishMaterials();
+					delete loader_;
+					loader_ = NULL;
+					SetupWorld();
+					worldready_ = true;
+				}
+			}
+
+			frameTimer_.Lap(PhaseLoad);
+
+			// The frame starting the game only shows it, the first tick is the next frame, as in headless games
+			bool playing = gamestart_;
+
 			/* INPUT */
-			checkInput(); 
+			if (stress_ && gamestart_) { stressInput(recorder_.GetNumFrames()); }
+			else
+			{
+				pollInput();
+				checkInput();
+			}
+			frameTimer_.Lap(PhaseInput);
 
 			/* DRAW */
-			scene_.Draw(&camera_);		// Draw the scene
+			ParticleNode::selectDrawCounts(&camera_);	// Spend the particle budget on the systems that are big on screen
+			if (PROFILER_ENABLED && worldready_)
+			{
+				// The screen-space pass draws the profiler overlay over the scene
+				scene_.DrawToTexture(&camera_);
+				scene_.DisplayTexture(resman_.GetResource("ScreenSpaceMaterial")->GetResource());
+			}
+			else { scene_.Draw(&camera_); }		// Draw the scene
+			frameTimer_.Lap(PhaseDraw);
 
-			std::cout << "spiders: " << spiders.size() << std::endl;
-			std::cout << "dragonflies: " << dragonFlies.size() << std::endl;
-			std::cout <<  "humans: " << humans.size() << std::endl;
+			if (!stress_)
+			{
+				std::cout << "spiders: " << spiders.size() << std::endl;
+				std::cout << "dragonflies: " << dragonFlies.size() << std::endl;
+				std::cout << "humans: " << humans.size() << std::endl;
+			}
 
 			//check if player health > 0 & gamestate & if we no longer have enemies 
-			if (gamestart_ && !(humans.size() == 0 && spiders.size() == 0 && dragonFlies.size() == 0))
+			if (playing && !(humans.size() == 0 && spiders.size() == 0 && dragonFlies.size() == 0))
 			{
 				if (player->health > 0)
 				{
 					/* COLLISION DETECTION */
 					gameCollisionDetection();
+					frameTimer_.Lap(PhaseCollision);
 
 					/* UPDATE */
 					update();
+					frameTimer_.Lap(PhaseUpdate);
 				}
 
 				//scene_.UpdateHealthData(player->health, player->maxHealth);
@@ -418,8 +551,152 @@ namespace game
 			}
 			
 			glfwSwapBuffers(window_);	// Push buffer drawn in the background onto the display
+			frameTimer_.Lap(PhaseDraw);	// Waiting for the GPU to finish the frame is part of drawing it
 			glfwPollEvents();			// Update other events like input handling
+			frameTimer_.Lap(PhaseInput);
+
+			endFrame(loading);
+			PROFILE_END_FRAME();
+			Trace::EndFrame();
+			if (playing) { Clock::Tick(); }	// Only moves a fixed-step clock
+			if (stress_ && recorder_.GetNumFrames() >= config_.frames) { break; }
+			if (inputLog_.IsDone()) { break; }	// End of the replayed game
 		}
+
+		if (stress_) { finishStress(); }
+		finishInput();
+	}
+
+	void Game::RunHeadless(int ticks)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double start_time = Clock::GetTime();	// Replays tick by the recorded times, not by the headless step
+
+		int tick;
+		for (tick = 0; tick < ticks; tick++)
+		{
+			// The game is over once the player died or all enemies are dead, stress runs go on for all their ticks
+			if (!stress_ && (player->health <= 0 || (humans.size() == 0 && spiders.size() == 0 && dragonFlies.size() == 0))) { break; }
+
+			if (inputLog_.IsDone()) { break; }	// End of the replayed game
+
+			/* INPUT */
+			frameTimer_.Start();
+			if (stress_) { stressInput(tick); }
+			else if (inputLog_.IsReplaying()) { checkInput(); }
+			frameTimer_.Lap(PhaseInput);
+
+			/* TRANSFORM */
+			scene_.UpdateTransforms();	// Absolute positions for the collisions, nothing is drawn
+			frameTimer_.Lap(PhaseDraw);	// The transform pass is all a headless frame draws
+
+			/* COLLISION DETECTION */
+			gameCollisionDetection();
+			frameTimer_.Lap(PhaseCollision);
+
+			/* UPDATE */
+			update();
+			frameTimer_.Lap(PhaseUpdate);
+
+			endFrame(false);
+			PROFILE_END_FRAME();
+			Trace::EndFrame();
+			Clock::Tick();
+		}
+
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Simulated " << tick << " ticks (" << Clock::GetTime() - start_time << " s of game time) in " << elapsed << " s";
+		if (elapsed > 0) { std::cout << ", " << tick / elapsed << " ticks per second"; }
+		std::cout << std::endl;
+		std::cout << "player health: " << player->health << std::endl;
+		std::cout << "spiders: " << spiders.size() << std::endl;
+		std::cout << "dragonflies: " << dragonFlies.size() << std::endl;
+		std::cout << "humans: " << humans.size() << std::endl;
+		if (stress_) { finishStress(); }
+		finishInput();
+	}
+
+	void Game::endFrame(bool loading)
+	{
+		Counters::Add(CounterEntitiesAlive, humans.size() + spiders.size() + dragonFlies.size() + rockets.size() + webs.size() + blocks.size());
+		long long counter[NUM_COUNTERS];
+		Counters::Collect(counter);
+		recorder_.EndFrame(frameTimer_, humans.size(), spiders.size(), dragonFlies.size(), rockets.size() + webs.size());
+		if (recorder_.GetEnabled()) { counterTotals_.AddFrame(counter); }
+		hitches_.EndFrame(frameTimer_, counter, loading);
+	}
+
+	void Game::stressInput(int frame)
+	{
+		// The camera carries the player, so it only depends on the frame number
+		glm::vec3 position, look_at;
+		cameraPath_.GetPose(frame, config_.camera_speed, position, look_at);
+		camera_.SetView(position, look_at, camera_up_g);
+
+		player->health = player->maxHealth;	// The player cannot die, the load has to last the whole run
+		if (config_.fire_interval > 0 && frame % config_.fire_interval == 0) { fireRocket(); }
+	}
+
+	void Game::finishStress()
+	{
+		recorder_.PrintSummary(std::cout);
+		if (!config_.csv.empty())
+		{
+			recorder_.WriteCsv(config_.csv);
+			std::cout << "Frame timings written to " << config_.csv << std::endl;
+		}
+
+		counterTotals_.Print(std::cout);
+		if (!config_.write_counters.empty())
+		{
+			counterTotals_.Save(config_.write_counters);
+			std::cout << "Counters written to " << config_.write_counters << std::endl;
+		}
+		if (!config_.check_counters.empty())
+		{
+			CounterTotals baseline;
+			baseline.Load(config_.check_counters);
+			if (!counterTotals_.Check(baseline, std::cout)) { throw(GameException(std::string("Counters over the baseline ") + config_.check_counters)); }
+			std::cout << "Counters within the baseline " << config_.check_counters << std::endl;
+		}
+	}
+
+	void Game::finishInput()
+	{
+		if (inputLog_.IsRecording())
+		{
+			if (worldready_) { inputLog_.SetEndState(endState()); }	// A window closed while loading has no game to check
+			inputLog_.Save(inputFile_);
+			std::cout << "Input written to " << inputFile_ << ", replay it with --replay " << inputFile_ << std::endl;
+			return;
+		}
+
+		// A replay played to the end of the game, or of its input, ends where the recorded game did
+		if (!inputLog_.IsReplaying() || inputLog_.GetEndState().empty() || !worldready_) { return; }
+		bool over = player->health <= 0 || (humans.size() == 0 && spiders.size() == 0 && dragonFlies.size() == 0);
+		if (!over && !inputLog_.IsDone()) { return; }
+		std::string state = endState();
+		if (state != inputLog_.GetEndState())
+		{
+			throw(GameException(std::string("Replay of ") + inputFile_ + std::string(" ended in ") + state + std::string(", the recorded game in ") + inputLog_.GetEndState()));
+		}
+		std::cout << "Replay of " << inputFile_ << " ended as recorded: " << state << std::endl;
+	}
+
+	std::string Game::endState()
+	{
+		// Enemies stand still once the game is over, while the player can still look around and fire
+		float enemy_health = 0.0f;
+		glm::vec3 enemy_position(0.0f);
+		for (int i = 0; i < humans.size(); i++) { enemy_health += humans[i]->health; enemy_position += humans[i]->body->GetPosition(); }
+		for (int i = 0; i < spiders.size(); i++) { enemy_health += spiders[i]->health; enemy_position += spiders[i]->body->GetPosition(); }
+		for (int i = 0; i < dragonFlies.size(); i++) { enemy_health += dragonFlies[i]->health; enemy_position += dragonFlies[i]->body->GetPosition(); }
+
+		std::ostringstream state;
+		state << std::setprecision(9) << "health " << player->health << " humans " << humans.size() << " spiders " << spiders.size()
+			<< " dragonflies " << dragonFlies.size() << " enemy_health " << enemy_health
+			<< " enemy_position " << enemy_position.x << " " << enemy_position.y << " " << enemy_position.z;
+		return state.str();
 	}
 
 	void Game::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
@@ -429,18 +706,8 @@ namespace game
 		Game *game = (Game *)ptr;
 		
 		if (game->gamestart_)
-			// Mouse click checks for 1st or third person
-			if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) 
-			{
-				//update health bar
-				if (game->camera_.firstPerson)
-				{
-					game->player->healthBar->Translate(glm::vec3(0, 0, 1) * game->camera_.distance);
-				}
-				else { game->player->healthBar->Translate(glm::vec3(0, 0, -1) * game->camera_.distance); }
-
-				game->camera_.firstPerson = !game->camera_.firstPerson; 
-			}
+			// Mouse click checks for 1st or third person, on the next tick
+			if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) { game->inputLog_.Press(InputToggleView); }
 	}
 
 	void Game::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -449,44 +716,20 @@ namespace game
 		void* ptr = glfwGetWindowUserPointer(window);
 		Game* game = (Game *)ptr;
 
+		// Record the next frames for chrome://tracing or Perfetto
+		if (key == GLFW_KEY_F9 && action == GLFW_PRESS) { Trace::Start(TRACE_DEFAULT_FRAMES); }
+
 		if (game->gamestart_)
 		{
 
 			// Quit game if ESC button is pressed
 			if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) { glfwSetWindowShouldClose(window, true); }
 
-			if (key == GLFW_KEY_G && action == GLFW_PRESS)
-			{
-				if (game->player->myBlock == NULL)
-				{
-					for (int i = 0; i < game->blocks.size(); i++)
-					{
-						// Drag add alittle to the bounding box for the block we want to drag
-						if (game->player->collision(game->blocks[i]->object, game->blocks[i]->offset, game->blocks[i]->boundingRadius + 1.f))
-						{
-							std::cout << "dragging" << std::endl;
-							game->world->RemoveChild(game->blocks[i]->object);
-							game->player->myBlock = game->blocks[i];
-							game->player->myBlock->beingDragged = true;
-							game->player->myBlock->dropped = false;
-							game->player->myBlock->hitFloor = true;
-							game->blocks[i]->object->SetPosition(game->player->body->GetPosition() + (glm::vec3(0, -0.8, 0)));
-							game->player->body->AddChild(game->blocks[i]->object);
-						}
-					}
-				}
-				// Drop
-				else
-				{
-					std::cout << "dropping" << std::endl;
-					game->player->myBlock->dropped = true;
-					game->player->myBlock->beingDragged = false;
-					game->player->body->RemoveChild(game->player->myBlock->object);
-					game->player->myBlock->object->SetPosition(game->player->myBlock->object->getAbsolutePosition());
-					game->world->AddChild(game->player->myBlock->object);
-					game->player->myBlock = 0;
-				}
-			}
+			// Toggle timing of the particle draws on the GPU
+			if (key == GLFW_KEY_T && action == GLFW_PRESS) { game->scene_.SetParticleTiming(!game->scene_.GetParticleTiming()); }
+
+			// Drag or drop a block, on the next tick
+			if (key == GLFW_KEY_G && action == GLFW_PRESS) { game->inputLog_.Press(InputGrab); }
 		}
 	}
 
@@ -500,61 +743,137 @@ namespace game
 		game->camera_.SetProjection(camera_fov_g, camera_near_clip_distance_g, camera_far_clip_distance_g, width, height);
 	}
 
+	void Game::pollInput()
+	{
+		// Keys held for each button, in the order of InputButton
+		static const int button_key[NUM_INPUT_BUTTONS] = {
+			GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT,
+			GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D,
+			GLFW_KEY_Z, GLFW_KEY_C, GLFW_KEY_Q, GLFW_KEY_E, GLFW_KEY_SPACE };
+
+		for (int i = 0; i < NUM_INPUT_BUTTONS; i++) { inputLog_.SetHeld((InputButton)i, glfwGetKey(window_, button_key[i]) == GLFW_PRESS); }
+
+		// Time since the last frame, the first one takes a normal step
+		double now = glfwGetTime();
+		double step = (inputTime_ < 0.0) ? headless_time_step_g : now - inputTime_;
+		inputTime_ = now;
+		inputLog_.SetStep(glm::clamp((float)step, 1e-6f, (float)max_recorded_step_g));
+	}
+
 	// CHECKING WHETHER A BUTTON IS HELD DOWN OR NOT IS AN ISSUE???????? WITH THE CHECK INPUT FUNCTION
 	void Game::checkInput()
 	{
+		PROFILE_SCOPE("input");
+		TRACE_SCOPE("input");
+
 		if (gamestart_)
 		{
+			// Input of this tick, from the window or from the replayed game
+			const InputSnapshot &input = inputLog_.NextTick();
+
+			// Recorded and replayed games tick the clock by the time of the recorded frame, so timers run at the speed they were played at
+			if ((inputLog_.IsRecording() || inputLog_.IsReplaying()) && input.step > 0.0f) { Clock::SetFixedStep(input.step); }
+
 			// View control
 			float rot_factor(glm::pi<float>() / 360);
 
 			// Move camera up, down, and to the sides
-			if (glfwGetKey(window_, GLFW_KEY_UP)) { camera_.Pitch(rot_factor); }
-			if (glfwGetKey(window_, GLFW_KEY_DOWN)) { camera_.Pitch(-rot_factor); }
-			if (glfwGetKey(window_, GLFW_KEY_LEFT)) { camera_.Yaw(rot_factor); }
-			if (glfwGetKey(window_, GLFW_KEY_RIGHT)) { camera_.Yaw(-rot_factor); }
+			if (input.IsHeld(InputPitchUp)) { camera_.Pitch(rot_factor); }
+			if (input.IsHeld(InputPitchDown)) { camera_.Pitch(-rot_factor); }
+			if (input.IsHeld(InputYawLeft)) { camera_.Yaw(rot_factor); }
+			if (input.IsHeld(InputYawRight)) { camera_.Yaw(-rot_factor); }
 
 			// Forward backward and side movements
-			if (glfwGetKey(window_, GLFW_KEY_W)) { camera_.Translate(camera_.GetForward() * player->speed); }
-			if (glfwGetKey(window_, GLFW_KEY_S)) { camera_.Translate(-camera_.GetForward() * player->speed); }
-			if (glfwGetKey(window_, GLFW_KEY_A)) { camera_.Translate(-camera_.GetSide() * player->speed); }
-			if (glfwGetKey(window_, GLFW_KEY_D)) { camera_.Translate(camera_.GetSide() * player->speed); }
+			if (input.IsHeld(InputForward)) { camera_.Translate(camera_.GetForward() * player->speed); }
+			if (input.IsHeld(InputBackward)) { camera_.Translate(-camera_.GetForward() * player->speed); }
+			if (input.IsHeld(InputLeft)) { camera_.Translate(-camera_.GetSide() * player->speed); }
+			if (input.IsHeld(InputRight)) { camera_.Translate(camera_.GetSide() * player->speed); }
 
 			// Roll camera
-			if (glfwGetKey(window_, GLFW_KEY_Z)) { camera_.Roll(-rot_factor); }
-			if (glfwGetKey(window_, GLFW_KEY_C)) { camera_.Roll(rot_factor); }
+			if (input.IsHeld(InputRollLeft)) { camera_.Roll(-rot_factor); }
+			if (input.IsHeld(InputRollRight)) { camera_.Roll(rot_factor); }
 
 			// TO BE CHANGED!!!!!!!!!!!!!! (movement up and down)
-			if (glfwGetKey(window_, GLFW_KEY_Q)) { camera_.Translate(camera_.GetUp() * player->speed); }
-			if (glfwGetKey(window_, GLFW_KEY_E)) { camera_.Translate(-camera_.GetUp() * player->speed); }
+			if (input.IsHeld(InputUp)) { camera_.Translate(camera_.GetUp() * player->speed); }
+			if (input.IsHeld(InputDown)) { camera_.Translate(-camera_.GetUp() * player->speed); }
 
 			// Shoot a rocket
-			if (glfwGetKey(window_, GLFW_KEY_SPACE))
-			{
-				if (player->fireRate <= 0)
-				{
-					ParticleNode *particle = createParticle("rocketParticle1", "ConeParticle", "bulletMaterial", "", glm::vec3(1, 1, 1));
-					//particle->getParticle()->SetBlending(false);
-					particle->startAnimate(target->getAbsolutePosition() - player->body->getAbsolutePosition(), player->body->getAbsoluteOrientation(), 999);
-					particle->getParticle()->Rotate(glm::angleAxis(glm::pi<float>() / 2, glm::vec3(1.0, 0.0, 0.0)));
-					player->rockets_particles.push_back(particle);
-
-					player->rockets.push_back(createRocket("Rocket1", target->getAbsolutePosition() - player->body->getAbsolutePosition(), player->body->getAbsolutePosition()));
-					player->fireRate = player->maxFireRate;
-				}
-			}
+			if (input.IsHeld(InputFire)) { fireRocket(); }
+
+			if (input.WasPressed(InputToggleView)) { toggleView(); }
+			if (input.WasPressed(InputGrab)) { grabBlock(); }
 		}
 		else
 		{
-			if (glfwGetKey(window_, GLFW_KEY_SPACE))
+			// The game can only start once the world is loaded, replays start right away
+			if (worldready_ && (inputLog_.IsReplaying() || inputLog_.GetLive().IsHeld(InputFire)))
 			{
 				gamestart_ = true;
-				menuNode->SetVisible(false);
+				if (menuNode) { menuNode->SetVisible(false); }
 				player->body->SetVisible(true);
 			}
 		}
 	}
 
+	void Game::toggleView()
+	{
+		//update health bar
+		if (camera_.firstPerson)
+		{
+			player->healthBar->Translate(glm::vec3(0, 0, 1) * camera_.distance);
+		}
+		else { player->healthBar->Translate(glm::vec3(0, 0, -1) * camera_.distance); }
+
+		camera_.firstPerson = !camera_.firstPerson;
+	}
+
+	void Game::grabBlock()
+	{
+		if (player->myBlock == NULL)
+		{
+			for (int i = 0; i < blocks.size(); i++)
+			{
+				// Drag add alittle to the bounding box for the block we want to drag
+				if (player->collision(blocks[i]->object, blocks[i]->offset, blocks[i]->boundingRadius + 1.f))
+				{
+					std::cout << "dragging" << std::endl;
+					world->RemoveChild(blocks[i]->object);
+					player->myBlock = blocks[i];
+					player->myBlock->beingDragged = true;
+					player->myBlock->dropped = false;
+					player->myBlock->hitFloor = true;
+					blocks[i]->object->SetPosition(player->body->GetPosition() + (glm::vec3(0, -0.8, 0)));
+					player->body->AddChild(blocks[i]->object);
+				}
+			}
+		}
+		// Drop
+		else
+		{
+			std::cout << "dropping" << std::endl;
+			player->myBlock->dropped = true;
+			player->myBlock->beingDragged = false;
+			player->body->RemoveChild(player->myBlock->object);
+			player->myBlock->object->SetPosition(player->myBlock->object->getAbsolutePosition());
+			world->AddChild(player->myBlock->object);
+			player->myBlock = 0;
+		}
+	}
+
+	void Game::fireRocket()
+	{
+		if (player->fireRate > 0) { return; }
+
+		ParticleNode *particle = createParticle("rocketParticle1", "ConeParticle", "bulletMaterial", "", glm::vec3(1, 1, 1));
+		//particle->getParticle()->SetBlending(false);
+		particle->startAnimate(target->getAbsolutePosition() - player->body->getAbsolutePosition(), player->body->getAbsoluteOrientation(), 999);
+		particle->getParticle()->Rotate(glm::angleAxis(glm::pi<float>() / 2, glm::vec3(1.0, 0.0, 0.0)));
+		player->rockets_particles.push_back(particle);
+
+		player->rockets.push_back(createRocket("Rocket1", target->getAbsolutePosition() - player->body->getAbsolutePosition(), player->body->getAbsolutePosition()));
+		player->fireRate = player->maxFireRate;
+	}
+
 	SceneNode *Game::createSky()
 	{
 		SceneNode* sky = createSceneNode("SkyInstance", "wallMesh", "textureMaterial", "skyTex");
@@ -631,6 +950,16 @@ namespace game
 		spiderBody->SetPosition(pos);
 		spiderBody->Rotate(glm::angleAxis(glm::pi<float>(), glm::vec3(0, 1, 0)));
 
+		// Draw the parts in one call
+		if (merge_characters_g && !headless_)
+		{
+			std::vector<SceneNode*> parts;
+			parts.push_back(spiderBody);
+			parts.push_back(spiderLeftLeg);
+			parts.push_back(spiderRightLeg);
+			spiderBody->AddChild(createCharacterNode(entity_name + "Merged", "spiderMergedMesh", "spiderBodyTex", parts));
+		}
+
 		Spider* spi = new Spider(spiderBody, spiderLeftLeg, spiderRightLeg);
 		spiders.push_back(spi);
 
@@ -695,6 +1024,18 @@ namespace game
 		// Setup part Positions
 		humanBody->SetPosition(pos);
 
+		// Draw the parts in one call
+		if (merge_characters_g && !headless_)
+		{
+			std::vector<SceneNode*> parts;
+			parts.push_back(humanBody);
+			parts.push_back(humanLeftHand);
+			parts.push_back(humanRightHand);
+			parts.push_back(humanLeftLeg);
+			parts.push_back(humanRightLeg);
+			humanBody->AddChild(createCharacterNode(entity_name + "Merged", "humanMergedMesh", "humanTex", parts));
+		}
+
 		Human* hum = new Human(humanBody, humanLeftHand, humanRightHand, humanLeftLeg, humanRightLeg);
 		humans.push_back(hum);
 
@@ -740,8 +1081,7 @@ namespace game
 		webNode->SetPosition(pos + 4.f * glm::normalize(direction));
 
 		ParticleNode* webParticle = createParticle(entity_name + "Particle", "TorusParticle", "splineMaterial", "", glm::vec3(0.2, 0.2, 0.2), true);
-		Resource *cp = resman_.GetResource("ControlPoints");
-		webParticle->getParticle()->AddShaderAttribute("control_point", Vec3Type, cp->GetSize(), cp->GetData());
+		webBatch->AddWeb(webParticle->getParticle());
 		webParticle->startAnimate(pos + 2.f * glm::normalize(direction), player->body->getAbsoluteOrientation(), 999);
 		webParticle->getParticle()->Rotate(glm::normalize(glm::angleAxis(glm::pi<float>() / 2, glm::vec3(1.0, 0.0, 0.0))));
 
@@ -891,26 +1231,84 @@ namespace game
 		return new ParticleNode(particle);
 	}
 
-	// Function to create a new SceneNode
-	SceneNode* Game::createSceneNode(std::string entity_name, std::string geometryName, std::string materialName, std::string textureName )
+	// Function to add a particle effect to the manager, drawn by one node for all its instances
+	void Game::createParticleEffect(std::string effect_name, std::string geometry, std::string material, std::string texture, glm::vec3 scale, double duration, std::string next)
 	{
 		// Get resources
-		Resource *geom = resman_.GetResource(geometryName);
-		if (!geom) { throw(GameException(std::string("Could not find resource \"") + geometryName + std::string("\""))); }
-		Resource *mat = resman_.GetResource(materialName);
-		if (!mat) { throw(GameException(std::string("Could not find resource \"") + materialName + std::string("\""))); }
+		Resource *geom = findResource(geometry);
+		Resource *mat = findResource(material);
 		Resource *tex = NULL;
-		if (textureName != "") {
-			tex = resman_.GetResource(textureName);
-			if (!tex) {
-				throw(GameException(std::string("Could not find resource \"") + textureName + std::string("\"")));
-			}
+		if (texture != "") { tex = findResource(texture); }
+
+		ParticleEffectNode *node = new ParticleEffectNode(effect_name + "Effect", geom, mat, tex);
+		node->SetScale(scale);
+		world->AddChild(node);
+		effects_.AddEffect(effect_name, node, duration, next);
+	}
+
+	// Function to create a particle system simulated on the GPU
+	ParticleNode *Game::createGpuParticle(std::string entity_name, int capacity, float floor_height)
+	{
+		// The sparks are only drawn, a headless game gets a system that never emits
+		if (headless_)
+		{
+			SceneNode *particle = new SceneNode(entity_name, 0, 0, 0);
+			world->AddChild(particle);
+			return new ParticleNode(particle);
 		}
 
+		Resource *update = resman_.GetResource("gpuParticleUpdateMaterial");
+		if (!update) { throw(GameException(std::string("Could not find resource \"gpuParticleUpdateMaterial\""))); }
+
+		GpuParticleSystem *system = new GpuParticleSystem(capacity, update->GetResource());
+		system->SetFloorHeight(floor_height);
+		resman_.AddResource(PointSet, entity_name + "State", system->GetArrayBuffer(), 0, capacity, GpuParticleSystem::GetVertexFormat());
+		SceneNode *particle = createSceneNode(entity_name, entity_name + "State", "gpuParticleMaterial", "");
+		world->AddChild(particle);
+		return new ParticleNode(particle, system);
+	}
+
+	// Function to create a new SceneNode
+	SceneNode* Game::createSceneNode(std::string entity_name, std::string geometryName, std::string materialName, std::string textureName )
+	{
+		// Get resources, the nodes of headless games have none and are only transformed
+		Resource *geom = findResource(geometryName);
+		Resource *mat = findResource(materialName);
+		Resource *tex = NULL;
+		if (textureName != "") { tex = findResource(textureName); }
+
 		//return a new sceneNode object
 		return new SceneNode(entity_name, geom, mat, tex);
 	}
 
+	// Function to get a resource used by a node
+	Resource* Game::findResource(std::string name)
+	{
+		if (headless_) { return NULL; }
+
+		Resource *res = resman_.GetResource(name);
+		if (!res) { throw(GameException(std::string("Could not find resource \"") + name + std::string("\""))); }
+		return res;
+	}
+
+	CharacterNode* Game::createCharacterNode(std::string entity_name, std::string geometryName, std::string textureName, std::vector<SceneNode*> parts)
+	{
+		// Get resources
+		Resource *geom = resman_.GetResource(geometryName);
+		if (!geom) { throw(GameException(std::string("Could not find resource \"") + geometryName + std::string("\""))); }
+		Resource *mat = resman_.GetResource("characterMaterial");
+		if (!mat) { throw(GameException(std::string("Could not find resource \"characterMaterial\""))); }
+		Resource *tex = resman_.GetResource(textureName);
+		if (!tex) { throw(GameException(std::string("Could not find resource \"") + textureName + std::string("\""))); }
+
+		// The node is a child of the first part, so it is removed from the scene along with it
+		// Its scale is only used to size it for choosing the level of detail, the parts place the vertices
+		CharacterNode *character = new CharacterNode(entity_name, geom, mat, tex);
+		character->SetScale(parts[0]->GetScale());
+		for (int i = 0; i < parts.size(); i++) { character->AddPart(parts[i]); }
+		return character;
+	}
+
 	// LOADS GEOMETRY MATERIAL AND TEXTURE STORES THEM IN A VECTOR AND RETURN THEM
 	std::vector<Resource*> Game::loadAssetResources(std::string geometryName, std::string materialName, std::string textureName)
 	{
@@ -929,17 +1327,16 @@ namespace game
 
 	void Game::update()
 	{
+		PROFILE_SCOPE("update");
+		TRACE_SCOPE("update");
+
 		/* CHECK THE PARTICLE SYSTEM TIME */
-		dragonFlyParticle->update(); if (dragonFlyParticle->shouldDisappear) { dragonFlyParticle->shouldDisappear = false; dragonFlyParticle->getParticle()->SetVisible(false); }		
- 		spiderParticle->update(); if (spiderParticle->shouldDisappear) { spiderParticle->shouldDisappear = false; spiderParticle->getParticle()->SetVisible(false); }		
- 		humanParticle->update(); if (humanParticle->shouldDisappear) { 		
- 			humanParticle->shouldDisappear = false; humanParticle->getParticle()->SetVisible(false); 		
- 			humanParticleRing->startAnimate(humanParticle->getParticle()->getAbsolutePosition(), humanParticle->getParticle()->getAbsoluteOrientation(), 4);		
- 		}		
- 		flyParticle->update(); if (flyParticle->shouldDisappear) { flyParticle->shouldDisappear = false; flyParticle->getParticle()->SetVisible(false); }		
- 		humanParticleRing->update(); if (humanParticleRing->shouldDisappear) { humanParticleRing->shouldDisappear = false; humanParticleRing->getParticle()->SetVisible(false); }		
+		TraceScope effects_trace("update_effects");
+		effects_.Update();
  		ringParticle1->update(); if (ringParticle1->shouldDisappear) { ringParticle1->shouldDisappear = false; ringParticle1->getParticle()->SetVisible(false); }		
  		ringParticle2->update(); if (ringParticle2->shouldDisappear) { ringParticle2->shouldDisappear = false; ringParticle2->getParticle()->SetVisible(false); }
+		sparkParticle->update();
+		effects_trace.End();
 
 		/* UPDATE */
 		// Check distances before updating
@@ -960,12 +1357,14 @@ namespace game
 			}
 		}
 
+		TraceScope dragonfly_trace("ai_dragonflies");
 		for (int i = 0; i < dragonFlies.size(); i++)
 		{
 			// Check if dragonfly has any leftover health if it does update else kill the dragonfly
 			if (dragonFlies[i]->health <= 0)
 			{
-				dragonFlyParticle->startAnimate(dragonFlies[i]->body->getAbsolutePosition(), dragonFlies[i]->body->getAbsoluteOrientation(), 3);
+				effects_.Start("dragonFlyDeath", dragonFlies[i]->body->getAbsolutePosition(), dragonFlies[i]->body->getAbsoluteOrientation());
+				sparkParticle->emit(3000, dragonFlies[i]->body->getAbsolutePosition(), glm::vec3(0, 5, 0), 15.0, 4.0);
 				dragonFlies[i]->body->del = true;			// Delete node from sceneGraph
 				dragonFlies[i]->leftWing->del = true;		// Delete node from sceneGraph
 				dragonFlies[i]->rightWing->del = true;		// Delete node from sceneGraph
@@ -989,11 +1388,15 @@ namespace game
 			}
 		}
 
+		dragonfly_trace.End();
+
+		TraceScope spider_trace("ai_spiders");
 		for (int j = 0; j < spiders.size(); j++)
 		{
 			if (spiders[j]->health <= 0)
 			{
-				spiderParticle->startAnimate(spiders[j]->body->getAbsolutePosition(), spiders[j]->body->getAbsoluteOrientation(), 3);
+				effects_.Start("spiderDeath", spiders[j]->body->getAbsolutePosition(), spiders[j]->body->getAbsoluteOrientation());
+				sparkParticle->emit(3000, spiders[j]->body->getAbsolutePosition(), glm::vec3(0, 5, 0), 15.0, 4.0);
 				spiders[j]->body->del = true;			// Delete node from sceneGraph
 				spiders[j]->leftLeg->del = true;		// Delete node from sceneGraph
 				spiders[j]->rightLeg->del = true;		// Delete node from sceneGraph
@@ -1018,11 +1421,15 @@ namespace game
 			}
 		}
 
+		spider_trace.End();
+
+		TraceScope human_trace("ai_humans");
 		for (int k = 0; k < humans.size(); k++)
 		{
 			if (humans[k]->health <= 0)
 			{
-				humanParticle->startAnimate(humans[k]->body->getAbsolutePosition(), humans[k]->body->getAbsoluteOrientation(), 5);
+				effects_.Start("humanDeath", humans[k]->body->getAbsolutePosition(), humans[k]->body->getAbsoluteOrientation());
+				sparkParticle->emit(5000, humans[k]->body->getAbsolutePosition(), glm::vec3(0, 5, 0), 20.0, 5.0);
 				humans[k]->body->del = true;				// Delete node from sceneGraph
 				humans[k]->leftLeg->del = true;				// Delete node from sceneGraph
 				humans[k]->leftHand->del = true;			// Delete node from sceneGraph
@@ -1044,6 +1451,8 @@ namespace game
 			}
 		}
 
+		human_trace.End();
+
 		//UPDATE BLOCKS
 		for (int i = 0; i < blocks.size(); i++)
 		{
@@ -1058,10 +1467,14 @@ namespace game
 				webs[i]->particle->updatePosition(webs[i]->node->getAbsolutePosition());
 			}
 		}
+		webBatch->UpdateInstances();
 	}
 
 	void Game::gameCollisionDetection()
 	{
+		PROFILE_SCOPE("collision");
+		TRACE_SCOPE("collision");
+
 		environmentCollision();
 		projectileCollision();
 		enemiesCollision();
@@ -1070,6 +1483,8 @@ namespace game
 
 	void Game::projectileCollision()
 	{
+		TRACE_SCOPE("collision_projectiles");
+
 		/* Rocket Collision detection */
 
 		/* PLAYER ROCKET COLLISION DETECTION */
@@ -1219,6 +1634,8 @@ namespace game
 
 	void Game::environmentCollision()
 	{
+		TRACE_SCOPE("collision_environment");
+
 		// PLAYER ROOM COLLISION 
 		glm::vec3 norm;
 
@@ -1315,6 +1732,8 @@ namespace game
 	/* ENEMY COLLISION DETECTION */
 	void Game::enemiesCollision()
 	{
+		TRACE_SCOPE("collision_enemies");
+
 		/* DRAGONFLIES ENEMIES AND PLAYER COLLISION  */
 		for (int i = 0; i < dragonFlies.size(); i++)
 		{
@@ -1422,6 +1841,8 @@ namespace game
 	/* Blocks Collision */ // DO WE DELETE BLOCK AFTER USING IT
 	void Game::blocksCollision()
 	{
+		TRACE_SCOPE("collision_blocks");
+
 		for (int w = 0; w < blocks.size(); w++)
 		{
 			if (blocks[w]->beingDragged) { return; }
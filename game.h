@@ -9,6 +9,7 @@
 
 #include "scene_graph.h"
 #include "resource_manager.h"
+#include "resource_loader.h"
 #include "camera.h"
 #include "rocket.h"
 #include "Web.h"
@@ -22,6 +23,15 @@
 #include "Room.h"
 #include "wall.h"
 #include "particleNode.h"
+#include "gpu_particles.h"
+#include "character_node.h"
+#include "particle_system_manager.h"
+#include "web_batch.h"
+#include "stress_scene.h"
+#include "frame_timer.h"
+#include "hitch_recorder.h"
+#include "counter_totals.h"
+#include "input_log.h"
 
 // GAME
 namespace game 
@@ -45,18 +55,36 @@ namespace game
             Game(void);
             ~Game();
 
-            void Init(void);								// Call Init() before calling any other method
+            void Init(bool headless = false);				// Call Init() before calling any other method; headless games have no window and make no OpenGL calls
             void SetupResources(void);						// Set up resources for the game
-            void SetupScene(void);							// Set up resources for the game
+            void SetupScene(void);							// Set up the menu screen, the world is set up once loading is done
             void MainLoop(void);							// Run the game: keep the application active
+            void RunHeadless(int ticks);					// Simulate a headless game for a number of fixed steps, as fast as possible
+            void SetStress(const StressConfig &config);		// Play the world of config with a scripted player and time each frame, call before SetupScene
+            void SetHitchBudget(double budget);				// Seconds a frame may take before it is written to disk with the frames around it, 0 never writes
+            void SetInputRecord(const std::string filename);	// Write the input of each tick to filename when the game ends, call before SetupScene
+            void SetInputReplay(const std::string filename);	// Play the game recorded in filename instead of reading the window, call before SetupScene
 
         private:
             GLFWwindow* window_;							// GLFW window
             SceneGraph scene_;								// Scene graph containing all nodes to render
 			ResourceManager resman_;						// Resources available to the game
+			ResourceLoader *loader_;						// Loads resources in the background, NULL once done
             Camera camera_;									// Camera abstraction
             bool animating_;								// Flag to turn animation on/off
+			bool headless_;									// Whether the game only simulates, without window or OpenGL context
 			bool gamestart_;								// Checking for the gamestate for menu screen
+			bool worldready_;								// Whether all resources are loaded and the world is set up
+			bool stress_;									// Whether this is a stress run, the player follows a scripted path
+			StressConfig config_;							// Entities of the world and settings of a stress run
+			StressCameraPath cameraPath_;					// Path of the player in a stress run
+			StressRecorder recorder_;						// Time of the phases of each frame of a stress run
+			FrameTimer frameTimer_;							// Time of the phases of the current frame
+			HitchRecorder hitches_;							// Last frames, written to disk after a slow one
+			CounterTotals counterTotals_;					// Counters of the frames of a stress run
+			InputLog inputLog_;								// Input of each tick, live or replayed
+			std::string inputFile_;							// Where a recorded game is written, or the replayed game
+			double inputTime_;								// Wall time the window was last polled, -1 before the first frame
 			SceneNode *menuNode;							// Adding a sceneNode for the menu
 			CameraNode* camNode;							// SceneNode for the camera to add to the hierarchy 
 			Fly* player;									// Player fly
@@ -66,13 +94,11 @@ namespace game
 			Environment* environment;						// Environment
 			Room* room;										// A room (not used)
 			Room* room2;									// Not using this
-			ParticleNode *dragonFlyParticle;				// Particle for dragonfly death
-			ParticleNode *flyParticle;						// Particle for fly rockets
-			ParticleNode *humanParticle;					// Particle system for human death
-			ParticleNode *spiderParticle;					// Particle system for spider death
-			ParticleNode *humanParticleRing;				// Particle system for Human explosion  
+			ParticleSystemManager effects_;					// Death effects, any number of each can run at once
+			WebBatch *webBatch;								// Draws the particles of all webs
 	    	ParticleNode *ringParticle1;					// Particle system for ring particles
 	    	ParticleNode *ringParticle2;					// Particle system for ring particles
+			ParticleNode *sparkParticle;					// Sparks bouncing on the floor when an enemy dies, simulated on the GPU
 			std::vector<Rocket*> rockets;					// All Rockets
 			std::vector<Web*> webs;							// All webs
 			std::vector<DragonFly*> dragonFlies;			// All dragonflies
@@ -83,6 +109,7 @@ namespace game
             void InitWindow(void);
             void InitView(void);
             void InitEventHandlers(void);
+            void SetupWorld(void);							// Set up the game world once all resources are loaded
  
             // Methods to handle events
             static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);		// Callback for key presses 
@@ -90,6 +117,15 @@ namespace game
             static void ResizeCallback(GLFWwindow* window, int width, int height);							// Callback for resizing the screen
 			
 			void checkInput();																				// Check for input
+			void stressInput(int frame);																	// Scripted input of a stress run
+			void finishStress();																			// Report the timings and counters of a stress run, checking them against the baseline
+			void endFrame(bool loading);																	// Hand the timings and counters of the frame to the recorders
+			void pollInput();																				// Read the buttons held in the window
+			void toggleView();																				// Switch between first and third person
+			void grabBlock();																				// Drag the block the player touches, or drop the dragged one
+			void finishInput();																				// Write the input of a recorded game, or check that a replay ended as recorded
+			std::string endState();																			// Player and enemies at the end of the game, as text
+			void fireRocket();																				// Shoot a rocket at the target if the player can fire
 			void update();																					// Update everything in the game
 			void gameCollisionDetection();																	// All game collision detection
 			void projectileCollision();																		// All Projectile Collision detection
@@ -110,9 +146,13 @@ namespace game
 			DragonFly* createDragonFly(std::string entity_name, glm::vec3 pos);								// Create a dragonfly instance
 			SceneNode* createSky();																			// Create a sky
 			ParticleNode* createParticle(std::string entity_name, std::string geometry, std::string material, std::string texture, glm::vec3 scale, bool insertFlag = false);// Create particles
+			ParticleNode* createGpuParticle(std::string entity_name, int capacity, float floor_height);	// Create particles simulated on the GPU, bouncing on the floor
+			void createParticleEffect(std::string effect_name, std::string geometry, std::string material, std::string texture, glm::vec3 scale, double duration, std::string next = "");// Add an effect to the manager
 			Block* createBlock(std::string entity_name, glm::vec3 pos);										// Create a block
 			Room* createRoom(std::string entity_name, int);													// Create a room with 4 walls and a floor
 			SceneNode* createSceneNode(std::string, std::string, std::string, std::string);					// General SceneNode creator
+			Resource* findResource(std::string name);														// Resource for a node, NULL in headless games
+			CharacterNode* createCharacterNode(std::string, std::string, std::string, std::vector<SceneNode*>);	// Node drawing the parts of a character in one call
 	}; // class Game
 } // namespace game
 #endif // GAME_H_
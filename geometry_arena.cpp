@@ -0,0 +1,87 @@
+#include <cstddef>
+
+#include "geometry_arena.h"
+#include "gl_calls.h"
+
+namespace game
+{
+	/* Constructor */
+	GeometryArena::GeometryArena(void)
+	{
+		// Buffers are created on first use, when there is an OpenGL context
+		array_buffer_ = 0;
+		element_array_buffer_ = 0;
+		vertex_capacity_ = vertex_used_ = 0;
+		index_capacity_ = index_used_ = 0;
+	}
+
+	/* Destructor */
+	GeometryArena::~GeometryArena() {}
+
+	/* Getters */
+	GLuint GeometryArena::GetArrayBuffer(void) const		{ return array_buffer_; }
+	GLuint GeometryArena::GetElementArrayBuffer(void) const	{ return element_array_buffer_; }
+
+	void GeometryArena::Allocate(const void *vertex, GLsizeiptr vertex_bytes, GLsizei stride, const GLuint *index, GLsizei num_indices, GLint &base_vertex, GLsizei &first_index)
+	{
+		if (!array_buffer_)
+		{
+			glGenBuffers(1, &array_buffer_);
+			glGenBuffers(1, &element_array_buffer_);
+		}
+
+		// Meshes have different vertex formats, so align the start of each one
+		// to its own stride; the base vertex is then a whole number of vertices
+		GLsizeiptr vertex_offset = ((vertex_used_ + stride - 1) / stride) * stride;
+		GLsizeiptr index_bytes = num_indices * sizeof(GLuint);
+
+		Reserve(array_buffer_, vertex_used_, vertex_capacity_, vertex_offset + vertex_bytes, ARENA_VERTEX_BYTES);
+		Reserve(element_array_buffer_, index_used_, index_capacity_, index_used_ + index_bytes, ARENA_INDEX_BYTES);
+
+		// Copy data
+		Gl::BindBuffer(GL_COPY_WRITE_BUFFER, array_buffer_);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, vertex_offset, vertex_bytes, vertex);
+		Gl::BindBuffer(GL_COPY_WRITE_BUFFER, element_array_buffer_);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, index_used_, index_bytes, index);
+		Gl::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		base_vertex = (GLint)(vertex_offset / stride);
+		first_index = (GLsizei)(index_used_ / sizeof(GLuint));
+		vertex_used_ = vertex_offset + vertex_bytes;
+		index_used_ += index_bytes;
+	}
+
+	void GeometryArena::Reserve(GLuint buffer, GLsizeiptr used, GLsizeiptr &capacity, GLsizeiptr needed, GLsizeiptr initial)
+	{
+		if (needed <= capacity) { return; }
+
+		GLsizeiptr new_capacity = (capacity > 0) ? capacity : initial;
+		while (new_capacity < needed) { new_capacity *= 2; }
+
+		if (used == 0)
+		{
+			Gl::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glBufferData(GL_COPY_WRITE_BUFFER, new_capacity, NULL, GL_STATIC_DRAW);
+		}
+		else
+		{
+			// Copy the used part out, reallocate and copy it back, so that
+			// resources that already refer to this buffer stay valid
+			GLuint temp;
+			glGenBuffers(1, &temp);
+			Gl::BindBuffer(GL_COPY_WRITE_BUFFER, temp);
+			glBufferData(GL_COPY_WRITE_BUFFER, used, NULL, GL_STREAM_COPY);
+			Gl::BindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+
+			glBufferData(GL_COPY_READ_BUFFER, new_capacity, NULL, GL_STATIC_DRAW);
+			Gl::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			Gl::BindBuffer(GL_COPY_READ_BUFFER, temp);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+			glDeleteBuffers(1, &temp);
+		}
+		Gl::BindBuffer(GL_COPY_READ_BUFFER, 0);
+		Gl::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		capacity = new_capacity;
+	}
+} // namespace game
@@ -0,0 +1,41 @@
+#ifndef GEOMETRY_ARENA_H_
+#define GEOMETRY_ARENA_H_
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// Initial sizes of the shared buffers, they grow as needed
+#define ARENA_VERTEX_BYTES (8 * 1024 * 1024)
+#define ARENA_INDEX_BYTES (4 * 1024 * 1024)
+
+namespace game
+{
+	// One vertex buffer and one index buffer shared by all static meshes.
+	// Each mesh gets a range of both; its indices are relative to its first
+	// vertex, so meshes are drawn with glDrawElementsBaseVertex
+	class GeometryArena
+	{
+	public:
+		GeometryArena(void);
+		~GeometryArena();
+
+		// Copy a mesh into the arena. Returns the index of its first vertex (base vertex) and of its first index
+		void Allocate(const void *vertex, GLsizeiptr vertex_bytes, GLsizei stride, const GLuint *index, GLsizei num_indices, GLint &base_vertex, GLsizei &first_index);
+
+		GLuint GetArrayBuffer(void) const;			// Shared vertex buffer
+		GLuint GetElementArrayBuffer(void) const;	// Shared index buffer
+
+	private:
+		GLuint array_buffer_;				// Shared vertex buffer
+		GLuint element_array_buffer_;		// Shared index buffer
+		GLsizeiptr vertex_capacity_;		// Size of the vertex buffer in bytes
+		GLsizeiptr vertex_used_;			// Bytes of the vertex buffer in use
+		GLsizeiptr index_capacity_;			// Size of the index buffer in bytes
+		GLsizeiptr index_used_;				// Bytes of the index buffer in use
+
+		// Make room for needed bytes, keeping the buffer name and the used contents
+		static void Reserve(GLuint buffer, GLsizeiptr used, GLsizeiptr &capacity, GLsizeiptr needed, GLsizeiptr initial);
+	}; // class GeometryArena
+} // namespace game
+#endif // GEOMETRY_ARENA_H_
@@ -0,0 +1,124 @@
+#ifndef GL_CALLS_H_
+#define GL_CALLS_H_
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "counters.h"
+
+// GL CALLS
+// Thin wrappers of the OpenGL calls the counters follow: draws, program switches,
+// texture and buffer binds and uniform uploads. The renderer makes these calls only
+// through here, so the counts are exact
+namespace game
+{
+	class Gl
+	{
+	public:
+		/* Draws */
+		static inline void DrawArrays(GLenum mode, GLint first, GLsizei count)
+		{
+			Counters::Add(CounterDrawCalls);
+			glDrawArrays(mode, first, count);
+		}
+
+		static inline void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+		{
+			Counters::Add(CounterDrawCalls);
+			glDrawArraysInstanced(mode, first, count, instances);
+		}
+
+		static inline void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void *indices, GLint base_vertex)
+		{
+			Counters::Add(CounterDrawCalls);
+			glDrawElementsBaseVertex(mode, count, type, indices, base_vertex);
+		}
+
+		static inline void DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, void *indices, GLsizei instances, GLint base_vertex)
+		{
+			Counters::Add(CounterDrawCalls);
+			glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, base_vertex);
+		}
+
+		static inline void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect, GLsizei draws, GLsizei stride)
+		{
+			Counters::Add(CounterDrawCalls);	// One call, however many draws it holds
+			glMultiDrawElementsIndirect(mode, type, indirect, draws, stride);
+		}
+
+		/* State */
+		static inline void UseProgram(GLuint program)
+		{
+			Counters::Add(CounterProgramSwitches);
+			glUseProgram(program);
+		}
+
+		static inline void BindTexture(GLenum target, GLuint texture)
+		{
+			Counters::Add(CounterTextureBinds);
+			glBindTexture(target, texture);
+		}
+
+		static inline void BindBuffer(GLenum target, GLuint buffer)
+		{
+			Counters::Add(CounterBufferBinds);
+			glBindBuffer(target, buffer);
+		}
+
+		static inline void BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+		{
+			Counters::Add(CounterBufferBinds);
+			glBindBufferBase(target, index, buffer);
+		}
+
+		/* Uniforms */
+		static inline void Uniform1i(GLint location, GLint value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform1i(location, value);
+		}
+
+		static inline void Uniform1f(GLint location, GLfloat value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform1f(location, value);
+		}
+
+		static inline void Uniform1iv(GLint location, GLsizei count, const GLint *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform1iv(location, count, value);
+		}
+
+		static inline void Uniform1fv(GLint location, GLsizei count, const GLfloat *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform1fv(location, count, value);
+		}
+
+		static inline void Uniform2fv(GLint location, GLsizei count, const GLfloat *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform2fv(location, count, value);
+		}
+
+		static inline void Uniform3fv(GLint location, GLsizei count, const GLfloat *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform3fv(location, count, value);
+		}
+
+		static inline void Uniform4fv(GLint location, GLsizei count, const GLfloat *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniform4fv(location, count, value);
+		}
+
+		static inline void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+		{
+			Counters::Add(CounterUniformUploads);
+			glUniformMatrix4fv(location, count, transpose, value);
+		}
+	}; // class Gl
+} // namespace game
+#endif // GL_CALLS_H_
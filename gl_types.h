@@ -0,0 +1,29 @@
+#ifndef GL_TYPES_H_
+#define GL_TYPES_H_
+
+// OpenGL types and constants used by the simulation core. The core is built with
+// GAME_NO_GL and has no OpenGL, GLEW or GLFW dependency; everything else gets the
+// real definitions from GLEW, which these must match
+#ifdef GAME_NO_GL
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef unsigned short GLushort;
+typedef float GLfloat;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_POINTS 0x0000
+#define GL_TRIANGLES 0x0004
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_FLOAT 0x1406
+#define GL_HALF_FLOAT 0x140B
+#define GL_INT_2_10_10_10_REV 0x8D9F
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#endif // GL_TYPES_H_
@@ -0,0 +1,11 @@
+#version 400
+
+// Attributes passed from the geometry shader
+in vec4 frag_color;
+
+
+void main (void)
+{
+	// Set output fragment color
+    gl_FragColor = frag_color;
+}
@@ -0,0 +1,42 @@
+#version 400
+
+// Definition of the geometry shader
+layout (points) in;
+layout (triangle_strip, max_vertices = 4) out;
+
+// Attributes passed from the vertex shader
+in vec4 particle_color[];
+
+// Uniform (global) buffer
+uniform mat4 projection_mat;
+
+// Simulation parameters (constants)
+float particle_size = 0.4;
+
+// Attributes passed to the fragment shader
+out vec4 frag_color;
+
+
+void main(void){
+
+    // Dead particles produce no geometry
+    if (particle_color[0].a <= 0.0) return;
+
+    // Get the position of the particle, already in camera space
+    vec4 position = gl_in[0].gl_Position;
+
+    // Define the positions of the four vertices that will form a quad 
+    vec4 v[4];
+    v[0] = vec4(position.x - 0.5*particle_size, position.y - 0.5*particle_size, position.z, 1.0);
+    v[1] = vec4(position.x + 0.5*particle_size, position.y - 0.5*particle_size, position.z, 1.0);
+    v[2] = vec4(position.x - 0.5*particle_size, position.y + 0.5*particle_size, position.z, 1.0);
+    v[3] = vec4(position.x + 0.5*particle_size, position.y + 0.5*particle_size, position.z, 1.0);
+
+    for (int i = 0; i < 4; i++){
+        gl_Position = projection_mat * v[i];
+        frag_color = particle_color[0];
+        EmitVertex();
+     }
+
+     EndPrimitive();
+}
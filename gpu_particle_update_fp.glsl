@@ -0,0 +1,7 @@
+#version 400
+
+// Nothing is drawn while the particles are updated, rasterization is discarded
+void main (void)
+{
+    gl_FragColor = vec4(0.0);
+}
@@ -0,0 +1,88 @@
+#version 400
+
+// Particle state, read from one buffer
+in vec3 vertex;     // Position
+in vec3 normal;     // Velocity
+in vec2 uv;         // Age and lifetime
+
+// New particle state, captured into the other buffer
+out vec3 out_position;
+out vec3 out_velocity;
+out vec2 out_age;
+
+// Simulation parameters
+uniform float delta_time;
+uniform vec3 gravity;
+uniform float floor_height;
+uniform float restitution;
+uniform int capacity;
+uniform float seed;
+
+// Ranges of the ring to spawn, the size must match GPU_PARTICLE_MAX_EMITS
+uniform int num_emits;
+uniform int emit_start[4];
+uniform int emit_count[4];
+uniform vec3 emit_position[4];
+uniform vec3 emit_velocity[4];
+uniform float emit_speed[4];
+uniform float emit_lifetime[4];
+
+// Define some useful constants
+const float pi = 3.1415926536;
+const float friction = 0.8; // Horizontal speed kept when bouncing
+
+
+float hash(float n)
+{
+    return fract(sin(n) * 43758.5453);
+}
+
+
+void main()
+{
+    vec3 position = vertex;
+    vec3 velocity = normal;
+    float age = uv.x;
+    float lifetime = uv.y;
+
+    // Spawn: reset the particle if it is in one of the emitted ranges
+    for (int i = 0; i < num_emits; i++)
+    {
+        int offset = gl_VertexID - emit_start[i];
+        if (offset < 0) offset += capacity;
+        if (offset < emit_count[i])
+        {
+            // Random direction on the sphere
+            float n = float(gl_VertexID) + seed * 7.31;
+            float theta = 2.0 * pi * hash(n);
+            float z = 2.0 * hash(n + 13.7) - 1.0;
+            float r = sqrt(1.0 - z * z);
+            vec3 dir = vec3(r * cos(theta), r * sin(theta), z);
+
+            position = emit_position[i];
+            velocity = emit_velocity[i] + dir * emit_speed[i] * (0.5 + 0.5 * hash(n + 41.3));
+            age = 0.0;
+            lifetime = emit_lifetime[i] * (0.75 + 0.5 * hash(n + 97.1));
+        }
+    }
+
+    // Simulate the particles that are alive
+    if (age < lifetime)
+    {
+        velocity += gravity * delta_time;
+        position += velocity * delta_time;
+        age += delta_time;
+
+        // Bounce on the floor
+        if (position.y < floor_height && velocity.y < 0.0)
+        {
+            position.y = floor_height;
+            velocity.y = -velocity.y * restitution;
+            velocity.xz *= friction;
+        }
+    }
+
+    out_position = position;
+    out_velocity = velocity;
+    out_age = vec2(age, lifetime);
+}
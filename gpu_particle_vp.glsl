@@ -0,0 +1,24 @@
+#version 400
+
+// Vertex buffer, the state written by the update program
+in vec3 vertex;     // Position in world space
+in vec3 normal;     // Velocity
+in vec2 uv;         // Age and lifetime
+
+// Uniform (global) buffer
+uniform mat4 world_mat;
+uniform mat4 view_mat;
+
+// Attributes forwarded to the geometry shader
+out vec4 particle_color;
+
+
+void main()
+{
+    // Define output position but do not apply the projection matrix yet
+    gl_Position = view_mat * world_mat * vec4(vertex, 1.0);
+
+    // Fade out over the lifetime, dead particles are not drawn
+    float alpha = (uv.x < uv.y) ? 1.0 - uv.x / uv.y : 0.0;
+    particle_color = vec4(1.0, 0.6 + 0.4 * alpha, 0.2, alpha);
+}
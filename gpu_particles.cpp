@@ -0,0 +1,126 @@
+#include <vector>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "gpu_particles.h"
+#include "scene_node.h"
+#include "gl_calls.h"
+
+// GPU PARTICLE SYSTEM
+namespace game
+{
+	/* Constructor */
+	GpuParticleSystem::GpuParticleSystem(int capacity, GLuint update_program)
+	{
+		capacity_ = capacity;
+		update_program_ = update_program;
+		current_ = 0;
+		head_ = 0;
+		tick_ = 0;
+		gravity_ = glm::vec3(0.0, -9.8, 0.0);
+		floor_height_ = -30.0;
+		restitution_ = 0.4;
+
+		// All particles start dead, with age and lifetime 0
+		std::vector<GLfloat> state(capacity * GPU_PARTICLE_FLOATS, 0.0f);
+		glGenBuffers(2, buffer_);
+		for (int i = 0; i < 2; i++)
+		{
+			Gl::BindBuffer(GL_ARRAY_BUFFER, buffer_[i]);
+			glBufferData(GL_ARRAY_BUFFER, state.size() * sizeof(GLfloat), &state[0], GL_DYNAMIC_COPY);
+		}
+		SceneNode::ResetBufferBindings();
+	}
+
+	/* Destructor */
+	GpuParticleSystem::~GpuParticleSystem() { glDeleteBuffers(2, buffer_); }
+
+	/* Getters */
+	GLuint GpuParticleSystem::GetArrayBuffer(void) const	{ return buffer_[current_]; }
+	int GpuParticleSystem::GetCapacity(void) const			{ return capacity_; }
+
+	VertexFormat GpuParticleSystem::GetVertexFormat(void)
+	{
+		// Position as vertex, velocity as normal, age and lifetime as uv
+		VertexFormat format = DefaultVertexFormat();
+		format.stride = GPU_PARTICLE_FLOATS * sizeof(GLfloat);
+		format.attribute[PositionAttribute].offset = 0;
+		format.attribute[NormalAttribute].offset = 3 * sizeof(GLfloat);
+		format.attribute[ColorAttribute].enabled = false;
+		format.attribute[ColorAttribute].constant[0] = format.attribute[ColorAttribute].constant[1] = format.attribute[ColorAttribute].constant[2] = 1.0f;
+		format.attribute[UVAttribute].offset = 6 * sizeof(GLfloat);
+		return format;
+	}
+
+	/* Setters */
+	void GpuParticleSystem::SetGravity(glm::vec3 gravity)		{ gravity_ = gravity; }
+	void GpuParticleSystem::SetFloorHeight(float height)		{ floor_height_ = height; }
+	void GpuParticleSystem::SetRestitution(float restitution)	{ restitution_ = restitution; }
+
+	void GpuParticleSystem::Emit(int count, glm::vec3 position, glm::vec3 velocity, float speed, float lifetime)
+	{
+		if (count <= 0) { return; }
+		if (count > capacity_) { count = capacity_; }
+
+		// Spawn what is already queued when there is no room for more
+		if (emissions_.size() == GPU_PARTICLE_MAX_EMITS) { Update(0.0f); }
+
+		// Take the oldest particles of the ring, whether they are dead or not
+		Emission emission = { head_, count, position, velocity, speed, lifetime };
+		emissions_.push_back(emission);
+		head_ = (head_ + count) % capacity_;
+	}
+
+	void GpuParticleSystem::Update(float delta_time)
+	{
+		Gl::UseProgram(update_program_);
+
+		// Simulation parameters
+		Gl::Uniform1f(glGetUniformLocation(update_program_, "delta_time"), delta_time);
+		Gl::Uniform3fv(glGetUniformLocation(update_program_, "gravity"), 1, glm::value_ptr(gravity_));
+		Gl::Uniform1f(glGetUniformLocation(update_program_, "floor_height"), floor_height_);
+		Gl::Uniform1f(glGetUniformLocation(update_program_, "restitution"), restitution_);
+		Gl::Uniform1i(glGetUniformLocation(update_program_, "capacity"), capacity_);
+		Gl::Uniform1f(glGetUniformLocation(update_program_, "seed"), (float)(tick_++ % 4096));
+
+		// Emissions, as arrays indexed in the shader
+		int num_emits = emissions_.size();
+		GLint start[GPU_PARTICLE_MAX_EMITS], count[GPU_PARTICLE_MAX_EMITS];
+		glm::vec3 position[GPU_PARTICLE_MAX_EMITS], velocity[GPU_PARTICLE_MAX_EMITS];
+		GLfloat speed[GPU_PARTICLE_MAX_EMITS], lifetime[GPU_PARTICLE_MAX_EMITS];
+		for (int i = 0; i < num_emits; i++)
+		{
+			start[i] = emissions_[i].start;
+			count[i] = emissions_[i].count;
+			position[i] = emissions_[i].position;
+			velocity[i] = emissions_[i].velocity;
+			speed[i] = emissions_[i].speed;
+			lifetime[i] = emissions_[i].lifetime;
+		}
+		Gl::Uniform1i(glGetUniformLocation(update_program_, "num_emits"), num_emits);
+		if (num_emits > 0)
+		{
+			Gl::Uniform1iv(glGetUniformLocation(update_program_, "emit_start"), num_emits, start);
+			Gl::Uniform1iv(glGetUniformLocation(update_program_, "emit_count"), num_emits, count);
+			Gl::Uniform3fv(glGetUniformLocation(update_program_, "emit_position"), num_emits, glm::value_ptr(position[0]));
+			Gl::Uniform3fv(glGetUniformLocation(update_program_, "emit_velocity"), num_emits, glm::value_ptr(velocity[0]));
+			Gl::Uniform1fv(glGetUniformLocation(update_program_, "emit_speed"), num_emits, speed);
+			Gl::Uniform1fv(glGetUniformLocation(update_program_, "emit_lifetime"), num_emits, lifetime);
+		}
+		emissions_.clear();
+
+		// Run the update program over every particle, capturing its outputs in the other buffer
+		glEnable(GL_RASTERIZER_DISCARD);
+		Gl::BindBuffer(GL_ARRAY_BUFFER, buffer_[current_]);
+		SceneNode::SetupAttributes(update_program_, GetVertexFormat());
+		Gl::BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer_[1 - current_]);
+		glBeginTransformFeedback(GL_POINTS);
+		Gl::DrawArrays(GL_POINTS, 0, capacity_);
+		glEndTransformFeedback();
+		Gl::BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+		SceneNode::ResetBufferBindings();
+
+		current_ = 1 - current_;
+	}
+} // namespace game
@@ -0,0 +1,64 @@
+#ifndef GPU_PARTICLES_H_
+#define GPU_PARTICLES_H_
+
+#include <vector>
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "vertex_format.h"
+#include "particle_simulation.h"
+
+// Emissions that can be queued between two updates, must match gpu_particle_update_vp.glsl
+#define GPU_PARTICLE_MAX_EMITS 4
+// Floats per particle: position (3), velocity (3), age (1), lifetime (1)
+#define GPU_PARTICLE_FLOATS 8
+
+// GPU PARTICLE SYSTEM
+namespace game
+{
+	// Particles whose state lives in two buffers on the GPU. Each update runs the
+	// update program over one buffer and captures the result in the other with
+	// transform feedback, so the CPU never touches individual particles.
+	// New particles are spawned by the update program in a ring over the buffer
+	class GpuParticleSystem : public ParticleSimulation
+	{
+	public:
+		GpuParticleSystem(int capacity, GLuint update_program);
+		~GpuParticleSystem();
+
+		// Spawn count particles at position, moving with velocity plus a random direction of the given speed
+		void Emit(int count, glm::vec3 position, glm::vec3 velocity, float speed, float lifetime);
+		void Update(float delta_time);			// Advance the simulation and spawn the emitted particles
+
+		void SetGravity(glm::vec3 gravity);		// Acceleration of all particles
+		void SetFloorHeight(float height);		// Particles bounce on the plane y = height
+		void SetRestitution(float restitution);	// Fraction of the speed kept when bouncing
+
+		GLuint GetArrayBuffer(void) const;		// Buffer holding the latest state, to draw from
+		int GetCapacity(void) const;
+		static VertexFormat GetVertexFormat(void);	// Layout of a particle, as vertex, normal and uv attributes
+
+	private:
+		// Range of the ring reset by the next update
+		struct Emission
+		{
+			int start, count;
+			glm::vec3 position, velocity;
+			float speed, lifetime;
+		};
+
+		GLuint buffer_[2];						// Particle state, read from one and written to the other
+		int current_;							// Buffer holding the latest state
+		int capacity_;							// Number of particles in each buffer
+		int head_;								// Next particle of the ring to spawn
+		std::vector<Emission> emissions_;		// Emissions since the last update
+		GLuint update_program_;					// Program capturing the new state
+		glm::vec3 gravity_;
+		float floor_height_;
+		float restitution_;
+		unsigned int tick_;						// Number of updates, varies the random directions
+	}; // class GpuParticleSystem
+} // namespace game
+#endif // GPU_PARTICLES_H_
@@ -0,0 +1,92 @@
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "hitch_recorder.h"
+
+// HITCH RECORDER
+namespace game
+{
+	/* Constructor */
+	HitchRecorder::HitchRecorder(void)
+	{
+		num_frames_ = 0;
+		time_ = 0.0;
+		budget_ = HITCH_DEFAULT_BUDGET;
+		hitch_frame_ = -1;
+		num_dumps_ = 0;
+	}
+
+	/* Destructor */
+	HitchRecorder::~HitchRecorder() {}
+
+	void HitchRecorder::SetBudget(double budget) { budget_ = budget; }
+	double HitchRecorder::GetBudget(void) const { return budget_; }
+
+	void HitchRecorder::EndFrame(const FrameTimer &timer, const long long counter[NUM_COUNTERS], bool loading)
+	{
+		if (budget_ <= 0.0) { return; }
+
+		Frame &frame = history_[num_frames_ % HITCH_HISTORY_FRAMES];
+		frame.number = num_frames_;
+		frame.time = time_;
+		for (int i = 0; i < NUM_FRAME_PHASES; i++) { frame.phase_time[i] = timer.GetPhaseTime((FramePhase)i); }
+		for (int i = 0; i < NUM_COUNTERS; i++) { frame.counter[i] = counter[i]; }
+		frame.loading = loading;
+		time_ += timer.GetFrameTime();
+		num_frames_++;
+
+		// Only the first hitch of a burst is written, the later ones are in its file
+		if (hitch_frame_ < 0 && num_dumps_ < HITCH_MAX_DUMPS && !loading && timer.GetFrameTime() > budget_)
+		{
+			hitch_frame_ = frame.number;
+		}
+
+		// Wait for the frames after the hitch, then write the whole history
+		if (hitch_frame_ >= 0 && num_frames_ - 1 - hitch_frame_ >= HITCH_AFTER_FRAMES)
+		{
+			std::ostringstream filename;
+			filename << "hitch_" << hitch_frame_ << ".csv";
+			try
+			{
+				Write(filename.str());
+				std::cout << "Hitch of frame " << hitch_frame_ << " written to " << filename.str() << std::endl;
+			}
+			catch (std::exception &e)
+			{
+				// The recorder is always on, it should never stop the game
+				std::cerr << e.what() << std::endl;
+			}
+			hitch_frame_ = -1;
+			num_dumps_++;
+		}
+	}
+
+	void HitchRecorder::Write(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		f << "frame,time,frame_ms";
+		for (int j = 0; j < NUM_FRAME_PHASES; j++) { f << "," << FrameTimer::GetPhaseName((FramePhase)j) << "_ms"; }
+		for (int j = 0; j < NUM_COUNTERS; j++) { f << "," << Counters::GetName((Counter)j); }
+		f << ",loading,hitch" << std::endl;
+		f << std::fixed << std::setprecision(4);
+
+		// Oldest frame first
+		int oldest = (num_frames_ > HITCH_HISTORY_FRAMES) ? num_frames_ - HITCH_HISTORY_FRAMES : 0;
+		for (int i = oldest; i < num_frames_; i++)
+		{
+			const Frame &frame = history_[i % HITCH_HISTORY_FRAMES];
+			double frame_time = 0.0;
+			for (int j = 0; j < NUM_FRAME_PHASES; j++) { frame_time += frame.phase_time[j]; }
+
+			f << frame.number << "," << frame.time << "," << frame_time * 1000.0;
+			for (int j = 0; j < NUM_FRAME_PHASES; j++) { f << "," << frame.phase_time[j] * 1000.0; }
+			for (int j = 0; j < NUM_COUNTERS; j++) { f << "," << frame.counter[j]; }
+			f << "," << (frame.loading ? 1 : 0) << "," << (!frame.loading && frame_time > budget_ ? 1 : 0) << std::endl;
+		}
+	}
+} // namespace game
@@ -0,0 +1,55 @@
+#ifndef HITCH_RECORDER_H_
+#define HITCH_RECORDER_H_
+
+#include <string>
+
+#include "frame_timer.h"
+#include "counters.h"
+
+// Frames kept in the history, a few seconds at 60 frames per second
+#define HITCH_HISTORY_FRAMES 300
+// Frames slower than this many seconds are hitches when no budget is set
+#define HITCH_DEFAULT_BUDGET 0.050
+// Frames recorded after a hitch before it is written
+#define HITCH_AFTER_FRAMES 30
+// Hitches written in one run, so that a slow machine does not fill the disk
+#define HITCH_MAX_DUMPS 20
+
+// HITCH RECORDER
+// Always-on history of the last frames: the time of each phase and the counters.
+// A frame over the budget is written to hitch_N.csv along with the frames around it;
+// loading frames are kept for context but never count as hitches
+namespace game
+{
+	class HitchRecorder
+	{
+	public:
+		HitchRecorder(void);
+		~HitchRecorder();
+
+		void SetBudget(double budget);		// Seconds, 0 turns the recorder off
+		double GetBudget(void) const;
+
+		void EndFrame(const FrameTimer &timer, const long long counter[NUM_COUNTERS], bool loading);	// Once per frame, after the last phase
+
+	private:
+		struct Frame
+		{
+			int number;
+			double time;			// Seconds since the first frame
+			double phase_time[NUM_FRAME_PHASES];
+			long long counter[NUM_COUNTERS];
+			bool loading;
+		};
+
+		Frame history_[HITCH_HISTORY_FRAMES];	// Ring buffer, no allocation once the game runs
+		int num_frames_;						// Frames recorded so far, the newest is at (num_frames_ - 1) % HITCH_HISTORY_FRAMES
+		double time_;
+		double budget_;
+		int hitch_frame_;						// Frame number of the hitch waiting to be written, -1 if none
+		int num_dumps_;
+
+		void Write(const std::string filename) const;
+	}; // class HitchRecorder
+} // namespace game
+#endif // HITCH_RECORDER_H_
@@ -0,0 +1,147 @@
+#include <cstring>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "indirect_renderer.h"
+#include "gl_calls.h"
+
+// Binding point of the per-draw data, must match the indirect shaders
+#define DRAW_DATA_BINDING 0
+
+namespace game
+{
+	/* Constructor */
+	IndirectRenderer::IndirectRenderer(void)
+	{
+		num_batches_ = 0;
+		command_buffer_ = 0;
+		draw_data_buffer_ = 0;
+	}
+
+	/* Destructor */
+	IndirectRenderer::~IndirectRenderer() {}
+
+	bool IndirectRenderer::IsSupported(void)
+	{
+		bool multi_draw = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_storage_buffer_object);
+		return multi_draw && GLEW_ARB_shader_draw_parameters;
+	}
+
+	void IndirectRenderer::SetIndirectProgram(GLuint program, GLuint indirect_program) { indirect_program_[program] = indirect_program; }
+
+	void IndirectRenderer::Begin(void)
+	{
+		for (int i = 0; i < num_batches_; i++) { batch_[i].node.clear(); }
+		num_batches_ = 0;
+	}
+
+	bool IndirectRenderer::Add(SceneNode *node)
+	{
+		// Only opaque indexed meshes with an indirect program and no custom uniforms
+		if (node->GetBlending() || node->GetMode() != GL_TRIANGLES || node->HasShaderAttributes()) { return false; }
+		std::map<GLuint, GLuint>::const_iterator it = indirect_program_.find(node->GetMaterial());
+		if (it == indirect_program_.end()) { return false; }
+
+		// Find the batch of the node
+		const VertexFormat &format = node->GetVertexFormat();
+		int b;
+		for (b = 0; b < num_batches_; b++)
+		{
+			Batch &batch = batch_[b];
+			if (batch.program == it->second && batch.texture == node->GetTexture() &&
+				batch.array_buffer == node->GetArrayBuffer() && batch.element_array_buffer == node->GetElementArrayBuffer() &&
+				SameVertexFormat(batch.format, format)) { break; }
+		}
+
+		// Start a new batch
+		if (b == num_batches_)
+		{
+			if (num_batches_ == batch_.size()) { batch_.push_back(Batch()); }
+			Batch &batch = batch_[num_batches_++];
+			batch.program = it->second;
+			batch.texture = node->GetTexture();
+			batch.array_buffer = node->GetArrayBuffer();
+			batch.element_array_buffer = node->GetElementArrayBuffer();
+			batch.format = format;
+		}
+
+		batch_[b].node.push_back(node);
+		return true;
+	}
+
+	void IndirectRenderer::Submit(Camera *camera)
+	{
+		if (num_batches_ == 0) { return; }
+
+		// Write the commands and per-draw data of all batches, one after the other
+		command_.clear();
+		draw_data_.clear();
+		for (int b = 0; b < num_batches_; b++)
+		{
+			for (int i = 0; i < batch_[b].node.size(); i++)
+			{
+				SceneNode *node = batch_[b].node[i];
+				DrawCommand command;
+				command.count = node->GetSize();
+				command.instance_count = 1;
+				command.first_index = node->GetFirstIndex();
+				command.base_vertex = node->GetBaseVertex();
+				command.base_instance = 0;
+				command_.push_back(command);
+
+				DrawData data;
+				data.world_mat = node->GetWorldMatrix();
+				data.normal_mat = node->GetNormalMatrix();
+				draw_data_.push_back(data);
+			}
+		}
+
+		// Upload them, orphaning last frame's storage
+		if (!command_buffer_)
+		{
+			glGenBuffers(1, &command_buffer_);
+			glGenBuffers(1, &draw_data_buffer_);
+		}
+		Gl::BindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, command_.size() * sizeof(DrawCommand), &command_[0], GL_STREAM_DRAW);
+		Gl::BindBuffer(GL_SHADER_STORAGE_BUFFER, draw_data_buffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, draw_data_.size() * sizeof(DrawData), &draw_data_[0], GL_STREAM_DRAW);
+		Gl::BindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, draw_data_buffer_);
+
+		// Opaque state
+		glEnable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		glDepthFunc(GL_LESS);
+
+		// One call per batch
+		GLint first_draw = 0;
+		for (int b = 0; b < num_batches_; b++)
+		{
+			Batch &batch = batch_[b];
+			Gl::UseProgram(batch.program);
+			camera->SetupShader(batch.program);
+
+			// gl_DrawIDARB restarts at 0 in each call
+			GLint draw_offset = glGetUniformLocation(batch.program, "draw_offset");
+			Gl::Uniform1i(draw_offset, first_draw);
+
+			if (batch.texture)
+			{
+				GLint tex = glGetUniformLocation(batch.program, "texture_map");
+				Gl::Uniform1i(tex, 0);
+				glActiveTexture(GL_TEXTURE0);
+				Gl::BindTexture(GL_TEXTURE_2D, batch.texture);
+			}
+
+			Gl::BindBuffer(GL_ARRAY_BUFFER, batch.array_buffer);
+			Gl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.element_array_buffer);
+			SceneNode::SetupAttributes(batch.program, batch.format);
+
+			Gl::MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void *)(first_draw * sizeof(DrawCommand)), batch.node.size(), 0);
+			first_draw += batch.node.size();
+		}
+
+		// Nodes drawn next bind their own buffers
+		SceneNode::ResetBufferBindings();
+	}
+} // namespace game
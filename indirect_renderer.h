@@ -0,0 +1,70 @@
+#ifndef INDIRECT_RENDERER_H_
+#define INDIRECT_RENDERER_H_
+
+#include <vector>
+#include <map>
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "scene_node.h"
+#include "camera.h"
+
+namespace game
+{
+	// Draws opaque meshes from the shared mesh buffers with glMultiDrawElementsIndirect.
+	// Nodes are grouped by program, texture and vertex format; the matrices of each draw
+	// go to a shader storage buffer that the shaders index with gl_DrawIDARB
+	class IndirectRenderer
+	{
+	public:
+		IndirectRenderer(void);
+		~IndirectRenderer();
+
+		static bool IsSupported(void);							// Whether the driver has multi-draw indirect, storage buffers and gl_DrawIDARB
+		void SetIndirectProgram(GLuint program, GLuint indirect_program);	// Draw nodes using program with indirect_program instead
+
+		void Begin(void);						// Start collecting the draws of a frame
+		bool Add(SceneNode *node);				// Collect a node; false if it has to be drawn on its own
+		void Submit(Camera *camera);			// Draw everything collected
+
+	private:
+		// Command layout expected by glMultiDrawElementsIndirect
+		struct DrawCommand
+		{
+			GLuint count;
+			GLuint instance_count;
+			GLuint first_index;
+			GLint base_vertex;
+			GLuint base_instance;
+		};
+
+		// Per-draw data read by the indirect shaders, laid out as std430
+		struct DrawData
+		{
+			glm::mat4 world_mat;
+			glm::mat4 normal_mat;
+		};
+
+		// Nodes that can go out in one call
+		struct Batch
+		{
+			GLuint program;
+			GLuint texture;
+			GLuint array_buffer;
+			GLuint element_array_buffer;
+			VertexFormat format;
+			std::vector<SceneNode *> node;
+		};
+
+		std::map<GLuint, GLuint> indirect_program_;	// Indirect version of each program
+		std::vector<Batch> batch_;					// Batches, kept between frames to reuse memory
+		int num_batches_;							// Batches in use this frame
+		std::vector<DrawCommand> command_;			// Commands of the frame
+		std::vector<DrawData> draw_data_;			// Per-draw data of the frame
+		GLuint command_buffer_;						// GL_DRAW_INDIRECT_BUFFER
+		GLuint draw_data_buffer_;					// GL_SHADER_STORAGE_BUFFER
+	}; // class IndirectRenderer
+} // namespace game
+#endif // INDIRECT_RENDERER_H_
@@ -0,0 +1,161 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "input_log.h"
+
+// INPUT LOG
+namespace game
+{
+	// Start of every input file
+	static const char input_log_magic_g[4] = { 'I', 'N', 'P', 'T' };
+
+	// Integers are stored little-endian, whatever the machine
+	static void WriteInt(std::ofstream &f, unsigned int value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++) { f.put((char)((value >> (8 * i)) & 0xFF)); }
+	}
+
+	static unsigned int ReadInt(std::ifstream &f, int bytes)
+	{
+		unsigned int value = 0;
+		for (int i = 0; i < bytes; i++) { value |= (unsigned int)(unsigned char)f.get() << (8 * i); }
+		return value;
+	}
+
+	bool InputSnapshot::IsHeld(InputButton button) const { return (held & (1 << button)) != 0; }
+	bool InputSnapshot::WasPressed(InputEvent event) const { return (pressed & (1 << event)) != 0; }
+
+	/* Constructor */
+	InputLog::InputLog(void)
+	{
+		recording_ = false;
+		replaying_ = false;
+		seed_ = 1;
+		live_.held = 0;
+		live_.pressed = 0;
+		live_.step = 0.0f;
+		current_ = live_;
+		next_tick_ = 0;
+	}
+
+	/* Destructor */
+	InputLog::~InputLog() {}
+
+	void InputLog::Record(void) { recording_ = true; }
+
+	void InputLog::Replay(const std::string filename)
+	{
+		std::ifstream f(filename.c_str(), std::ios::binary);
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		// Header: magic, version, seed and number of runs
+		char magic[4];
+		f.read(magic, 4);
+		if (f.fail() || std::string(magic, 4) != std::string(input_log_magic_g, 4)) { throw(std::invalid_argument(std::string("Not an input file: ") + filename)); }
+		if (ReadInt(f, 4) != INPUT_LOG_VERSION) { throw(std::invalid_argument(std::string("Unsupported version of input file ") + filename)); }
+		seed_ = ReadInt(f, 4);
+		unsigned int num_runs = ReadInt(f, 4);
+
+		// Runs of ticks with the same buttons: held, pressed, number of ticks
+		tick_.clear();
+		for (unsigned int i = 0; i < num_runs; i++)
+		{
+			InputSnapshot snapshot;
+			snapshot.held = ReadInt(f, 2);
+			snapshot.pressed = ReadInt(f, 2);
+			snapshot.step = 0.0f;
+			unsigned int count = ReadInt(f, 4);
+			if (f.fail()) { throw(std::ios_base::failure(std::string("Truncated input file ") + filename)); }
+			tick_.insert(tick_.end(), count, snapshot);
+		}
+
+		// Time of each tick, as the bits of a float
+		for (int i = 0; i < tick_.size(); i++)
+		{
+			unsigned int bits = ReadInt(f, 4);
+			std::memcpy(&tick_[i].step, &bits, 4);
+		}
+
+		// State at the end of the game: length and text
+		unsigned int length = ReadInt(f, 4);
+		end_state_.assign(length, ' ');
+		if (length > 0) { f.read(&end_state_[0], length); }
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Truncated input file ") + filename)); }
+
+		replaying_ = true;
+		next_tick_ = 0;
+	}
+
+	bool InputLog::IsRecording(void) const { return recording_; }
+	bool InputLog::IsReplaying(void) const { return replaying_; }
+	bool InputLog::IsDone(void) const { return replaying_ && next_tick_ >= tick_.size(); }
+
+	void InputLog::SetSeed(unsigned int seed) { seed_ = seed; }
+	unsigned int InputLog::GetSeed(void) const { return seed_; }
+	void InputLog::SetEndState(const std::string state) { end_state_ = state; }
+	const std::string &InputLog::GetEndState(void) const { return end_state_; }
+
+	void InputLog::SetHeld(InputButton button, bool held)
+	{
+		if (held) { live_.held |= (1 << button); }
+		else { live_.held &= ~(1 << button); }
+	}
+
+	void InputLog::Press(InputEvent event) { live_.pressed |= (1 << event); }
+	void InputLog::SetStep(float step) { live_.step = step; }
+	const InputSnapshot &InputLog::GetLive(void) const { return live_; }
+
+	const InputSnapshot &InputLog::NextTick(void)
+	{
+		if (replaying_)
+		{
+			// Nothing is held once the replay is over, and its clock stops
+			current_.held = 0;
+			current_.pressed = 0;
+			current_.step = 0.0f;
+			if (next_tick_ < tick_.size()) { current_ = tick_[next_tick_++]; }
+			return current_;
+		}
+
+		current_ = live_;
+		live_.pressed = 0;
+		if (recording_) { tick_.push_back(current_); }
+		return current_;
+	}
+
+	void InputLog::Save(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str(), std::ios::binary);
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		// Most ticks repeat the buttons of the one before, so runs of them are stored with their length
+		std::vector<std::pair<InputSnapshot, unsigned int> > run;
+		for (int i = 0; i < tick_.size(); i++)
+		{
+			if (!run.empty() && run.back().first.held == tick_[i].held && run.back().first.pressed == tick_[i].pressed) { run.back().second++; }
+			else { run.push_back(std::make_pair(tick_[i], 1u)); }
+		}
+
+		f.write(input_log_magic_g, 4);
+		WriteInt(f, INPUT_LOG_VERSION, 4);
+		WriteInt(f, seed_, 4);
+		WriteInt(f, run.size(), 4);
+		for (int i = 0; i < run.size(); i++)
+		{
+			WriteInt(f, run[i].first.held, 2);
+			WriteInt(f, run[i].first.pressed, 2);
+			WriteInt(f, run[i].second, 4);
+		}
+		for (int i = 0; i < tick_.size(); i++)
+		{
+			unsigned int bits;
+			std::memcpy(&bits, &tick_[i].step, 4);
+			WriteInt(f, bits, 4);
+		}
+		WriteInt(f, end_state_.size(), 4);
+		f.write(end_state_.data(), end_state_.size());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error writing file ") + filename)); }
+	}
+} // namespace game
@@ -0,0 +1,74 @@
+#ifndef INPUT_LOG_H_
+#define INPUT_LOG_H_
+
+#include <string>
+#include <vector>
+
+// Version of the input files, increased whenever their layout changes
+#define INPUT_LOG_VERSION 3
+
+// INPUT LOG
+// Input of the game as one snapshot per tick: the buttons held, the one-off
+// presses and the game time of the tick. Snapshots come from the window, or from
+// a file written by an earlier game, which replays that game exactly when the
+// clock moves by the recorded times. The file also keeps the state the game ended
+// in, for checking that it did
+namespace game
+{
+	// Buttons read on every tick while they are held
+	typedef enum InputButtonType {
+		InputPitchUp, InputPitchDown, InputYawLeft, InputYawRight,
+		InputForward, InputBackward, InputLeft, InputRight,
+		InputRollLeft, InputRollRight, InputUp, InputDown, InputFire, NUM_INPUT_BUTTONS } InputButton;
+
+	// Presses handled once, on the tick after they happen
+	typedef enum InputEventType { InputToggleView, InputGrab, NUM_INPUT_EVENTS } InputEvent;
+
+	// Input of one tick, one bit per button and per event
+	struct InputSnapshot
+	{
+		unsigned short held;
+		unsigned short pressed;
+		float step;				// Seconds the clock moves on this tick
+
+		bool IsHeld(InputButton button) const;
+		bool WasPressed(InputEvent event) const;
+	};
+
+	class InputLog
+	{
+	public:
+		InputLog(void);
+		~InputLog();
+
+		void Record(void);							// Keep the snapshot of every tick, for Save
+		void Replay(const std::string filename);	// Take the snapshots from a file instead of the window
+		bool IsRecording(void) const;
+		bool IsReplaying(void) const;
+		bool IsDone(void) const;					// Whether a replay has used all its ticks
+
+		void SetSeed(unsigned int seed);			// Seed of rand for the world of the game
+		unsigned int GetSeed(void) const;
+		void SetEndState(const std::string state);	// State the recorded game ended in, as text
+		const std::string &GetEndState(void) const;	// Empty if the file has none
+
+		void SetHeld(InputButton button, bool held);	// Input from the window, ignored by replays
+		void Press(InputEvent event);
+		void SetStep(float step);					// Wall time of the tick in the window
+		const InputSnapshot &GetLive(void) const;
+		const InputSnapshot &NextTick(void);		// Input of the next tick, clearing the presses of the window
+
+		void Save(const std::string filename) const;
+
+	private:
+		bool recording_;
+		bool replaying_;
+		unsigned int seed_;
+		std::string end_state_;
+		InputSnapshot live_;
+		InputSnapshot current_;
+		std::vector<InputSnapshot> tick_;	// Recorded or replayed snapshots
+		int next_tick_;						// Next snapshot of a replay
+	}; // class InputLog
+} // namespace game
+#endif // INPUT_LOG_H_
@@ -2,31 +2,101 @@
 #include <exception>
 #include <chrono>
 #include <thread>
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+#include <climits>
 #include "game.h"
+#include "trace.h"
 
 
 // Macro for printing exceptions
 #define PrintException(exception_object)\
 	std::cerr << exception_object.what() << std::endl
 
+// Ticks simulated by a headless run when --ticks is not given, a minute of game time
+#define HEADLESS_DEFAULT_TICKS 3600
+
 // Main function that builds and runs the game
-int main(void)
+// --headless simulates the game without a window or OpenGL context, for --ticks N steps
+// --stress FILE runs the scene of a stress config file with a scripted player and reports the time of each phase of the frames,
+// --humans N, --layout grid, ... set single options of the config, overriding the file;
+// --check_counters FILE fails the run if a counter goes over the baseline FILE, --write_counters FILE writes a new one
+// --trace N records the first N frames, loading included, as a Chrome trace
+// --hitch-budget MS writes the last frames to hitch_N.csv after a frame slower than MS milliseconds, 0 never writes
+// --record FILE writes the input of the game to FILE, --replay FILE plays it again tick for tick, with or without --headless,
+// and fails if the replay does not end in the state the recorded game ended in. Recorded games keep the wall time of each
+// frame (at most a quarter second), which the replay ticks its clock by instead of the fixed headless step
+int main(int argc, char **argv)
 {
+    bool headless = false;
+    bool ticks_set = false;
+    int ticks = HEADLESS_DEFAULT_TICKS;
+    int trace_frames = 0;
+    double hitch_budget = HITCH_DEFAULT_BUDGET;
+    std::string record_file;
+    std::string replay_file;
+    bool stress = false;
+    std::string stress_file;
+    std::vector<std::pair<std::string, std::string> > stress_options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "--headless") { headless = true; }
+        else if (arg == "--ticks" && i + 1 < argc) { ticks = atoi(argv[++i]); ticks_set = true; }
+        else if (arg == "--trace" && i + 1 < argc) { trace_frames = atoi(argv[++i]); }
+        else if (arg == "--hitch-budget" && i + 1 < argc) { hitch_budget = atof(argv[++i]) / 1000.0; }
+        else if (arg == "--record" && i + 1 < argc) { record_file = argv[++i]; }
+        else if (arg == "--replay" && i + 1 < argc) { replay_file = argv[++i]; }
+        else if (arg == "--stress" && i + 1 < argc) { stress_file = argv[++i]; stress = true; }
+        else if (arg.compare(0, 2, "--") == 0 && i + 1 < argc) { stress_options.push_back(std::make_pair(arg.substr(2), std::string(argv[++i]))); stress = true; }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--headless [--ticks N]] [--trace N] [--hitch-budget MS] [--record FILE | --replay FILE] [--stress FILE] [--OPTION VALUE ...]" << std::endl;
+            return 1;
+        }
+    }
+
+    game::StressConfig config;
+    if (stress)
+    {
+        try
+        {
+            if (!stress_file.empty()) { game::LoadStressConfig(stress_file, config); }
+            for (int i = 0; i < stress_options.size(); i++) { game::SetStressOption(config, stress_options[i].first, stress_options[i].second); }
+        }
+        catch (std::exception &e)
+        {
+            PrintException(e);
+            return 1;
+        }
+        if (!ticks_set) { ticks = config.frames; }
+    }
+    if (!replay_file.empty() && !ticks_set) { ticks = INT_MAX; }	// A headless replay runs until its input is used up
+
     game::Game app; // Game application
 
     try 
 	{
         // Initialize game
-        app.Init();
+        app.Init(headless);
+        game::Trace::Start(trace_frames);
+        if (stress) { app.SetStress(config); }
+        app.SetHitchBudget(hitch_budget);
+        if (!record_file.empty()) { app.SetInputRecord(record_file); }
+        if (!replay_file.empty()) { app.SetInputReplay(replay_file); }
         // Setup the main resources and scene in the game
         app.SetupResources();
         app.SetupScene();
         // Run game
-        app.MainLoop();
+        if (headless) { app.RunHeadless(ticks); }
+        else { app.MainLoop(); }
     }
     catch (std::exception &e)
 	{
         PrintException(e);
+		if (headless || stress || !replay_file.empty()) { return 1; }	// Nobody is watching the console of a headless or scripted run
 		while (1);
 	}
 
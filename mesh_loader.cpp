@@ -0,0 +1,647 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+#include "mesh_loader.h"
+
+// MESH LOADER
+namespace game
+{
+	void LoadObj(const char *filename, TriMesh &mesh) {
+
+		// Parse file
+		// Open file
+		std::ifstream f;
+		f.open(filename);
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + std::string(filename))); }
+
+		// Parse lines
+		std::string line;
+		std::string ignore(" \t\r\n");
+		std::string part_separator(" \t");
+		std::string face_separator("/");
+		bool added_normal = false;
+		while (std::getline(f, line)) {
+			// Clean extremities of the string
+			string_trim(line, ignore);
+			// Ignore comments
+			if ((line.size() <= 0) ||
+				(line[0] == '#')) {
+				continue;
+			}
+			// Parse string
+			std::vector<std::string> part = string_split(line, part_separator);
+			// Check commands
+			if (!part[0].compare(std::string("v"))) {
+				if (part.size() >= 4) {
+					glm::vec3 position(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
+					mesh.position.push_back(position);
+				}
+				else {
+					throw(std::ios_base::failure(std::string("Error: v command should have exactly 3 parameters")));
+				}
+			}
+			else if (!part[0].compare(std::string("vn"))) {
+				if (part.size() >= 4) {
+					glm::vec3 normal(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
+					mesh.normal.push_back(normal);
+					added_normal = true;
+				}
+				else {
+					throw(std::ios_base::failure(std::string("Error: vn command should have exactly 3 parameters")));
+				}
+			}
+			else if (!part[0].compare(std::string("vt"))) {
+				if (part.size() >= 3) {
+					glm::vec2 tex_coord(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()));
+					mesh.tex_coord.push_back(tex_coord);
+				}
+				else {
+					throw(std::ios_base::failure(std::string("Error: vt command should have exactly 2 parameters")));
+				}
+			}
+			else if (!part[0].compare(std::string("f"))) {
+				if (part.size() >= 4) {
+					if (part.size() > 5) {
+						throw(std::ios_base::failure(std::string("Error: f commands with more than 4 vertices not supported")));
+					}
+					else if (part.size() == 5) {
+						// Break a quad into two triangles
+						Quad quad;
+						for (int i = 0; i < 4; i++) {
+							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
+							if (fd.size() == 1) {
+								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								quad.t[i] = -1;
+								quad.n[i] = -1;
+							}
+							else if (fd.size() == 2) {
+								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
+								quad.n[i] = -1;
+							}
+							else if (fd.size() == 3) {
+								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								if (std::string("").compare(fd[1]) != 0) {
+									quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
+								}
+								else {
+									quad.t[i] = -1;
+								}
+								quad.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
+							}
+							else {
+								throw(std::ios_base::failure(std::string("Error: f parameter should have 1 or 3 parameters separated by '/'")));
+							}
+						}
+						Face face1, face2;
+						face1.i[0] = quad.i[0]; face1.i[1] = quad.i[1]; face1.i[2] = quad.i[2];
+						face1.n[0] = quad.n[0]; face1.n[1] = quad.n[1]; face1.n[2] = quad.n[2];
+						face1.t[0] = quad.t[0]; face1.t[1] = quad.t[1]; face1.t[2] = quad.t[2];
+						face2.i[0] = quad.i[0]; face2.i[1] = quad.i[2]; face2.i[2] = quad.i[3];
+						face2.n[0] = quad.n[0]; face2.n[1] = quad.n[2]; face2.n[2] = quad.n[3];
+						face2.t[0] = quad.t[0]; face2.t[1] = quad.t[2]; face2.t[2] = quad.t[3];
+						mesh.face.push_back(face1);
+						mesh.face.push_back(face2);
+					}
+					else if (part.size() == 4) {
+						Face face;
+						for (int i = 0; i < 3; i++) {
+							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
+							if (fd.size() == 1) {
+								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								face.t[i] = -1;
+								face.n[i] = -1;
+							}
+							else if (fd.size() == 2) {
+								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
+								face.n[i] = -1;
+							}
+							else if (fd.size() == 3) {
+								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
+								if (std::string("").compare(fd[1]) != 0) {
+									face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
+								}
+								else {
+									face.t[i] = -1;
+								}
+								face.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
+							}
+							else {
+								throw(std::ios_base::failure(std::string("Error: f parameter should have 1, 2, or 3 parameters separated by '/'")));
+							}
+						}
+						mesh.face.push_back(face);
+					}
+				}
+				else {
+					throw(std::ios_base::failure(std::string("Error: f command should have 3 or 4 parameters")));
+				}
+			}
+			// Ignore other commands
+		}
+
+		// Close file
+		f.close();
+
+		// Check if vertex references are correct
+		for (unsigned int i = 0; i < mesh.face.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				if (mesh.face[i].i[j] >= mesh.position.size()) {
+					throw(std::ios_base::failure(std::string("Error: index for triangle ") + num_to_str<int>(mesh.face[i].i[j]) + std::string(" is out of bounds")));
+				}
+			}
+		}
+
+		// Compute degree of each vertex
+		std::vector<int> degree(mesh.position.size(), 0);
+		for (unsigned int i = 0; i < mesh.face.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				degree[mesh.face[i].i[j]]++;
+			}
+		}
+
+		// Compute vertex normals if no normals were ever added
+		if (!added_normal) {
+			mesh.normal = std::vector<glm::vec3>(mesh.position.size(), glm::vec3(0.0, 0.0, 0.0));
+			for (unsigned int i = 0; i < mesh.face.size(); i++) {
+				// Compute face normal
+				glm::vec3 vec1, vec2;
+				vec1 = mesh.position[mesh.face[i].i[0]] -
+					mesh.position[mesh.face[i].i[1]];
+				vec2 = mesh.position[mesh.face[i].i[0]] -
+					mesh.position[mesh.face[i].i[2]];
+				glm::vec3 norm = glm::cross(vec1, vec2);
+				norm = glm::normalize(norm);
+				// Add face normal to vertices
+				mesh.normal[mesh.face[i].i[0]] += norm;
+				mesh.normal[mesh.face[i].i[1]] += norm;
+				mesh.normal[mesh.face[i].i[2]] += norm;
+			}
+			for (unsigned int i = 0; i < mesh.normal.size(); i++) {
+				if (degree[i] > 0) {
+					mesh.normal[i] /= degree[i];
+				}
+			}
+
+			// Computed normals are stored per position
+			for (unsigned int i = 0; i < mesh.face.size(); i++) {
+				for (int j = 0; j < 3; j++) {
+					mesh.face[i].n[j] = mesh.face[i].i[j];
+				}
+			}
+		}
+
+		// Debug
+		//print_mesh(mesh);
+	}
+
+
+	void BuildMeshGeometry(const TriMesh &mesh, GeometryData &geometry) {
+
+		// Face corners that reference the same position, normal and texture
+		// coordinate share one vertex, so vertex normals/texture coordinates
+		// that are not consistent over the mesh still get their own vertices
+
+		// Number of attributes for vertices and faces
+		const int vertex_att = 11;
+		const int face_att = 3;
+
+		std::vector<GLfloat> &vertex = geometry.vertex;
+		std::vector<GLuint> &face = geometry.face;
+		std::unordered_map<VertexKey, GLuint, VertexKeyHash> vertex_index;
+		vertex.reserve(mesh.position.size() * vertex_att);
+		face.reserve(mesh.face.size() * face_att);
+		vertex_index.reserve(mesh.position.size());
+
+		for (unsigned int i = 0; i < mesh.face.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				VertexKey key;
+				key.i = mesh.face[i].i[j];
+				key.n = mesh.face[i].n[j];
+				key.t = mesh.face[i].t[j];
+
+				// Reuse the vertex if this combination was already added
+				std::unordered_map<VertexKey, GLuint, VertexKeyHash>::const_iterator it = vertex_index.find(key);
+				if (it != vertex_index.end()) {
+					face.push_back(it->second);
+					continue;
+				}
+
+				GLuint index = (GLuint)(vertex.size() / vertex_att);
+				vertex_index[key] = index;
+				face.push_back(index);
+
+				GLfloat att[vertex_att] = { 0 };
+				// Position
+				att[0] = mesh.position[key.i][0];
+				att[1] = mesh.position[key.i][1];
+				att[2] = mesh.position[key.i][2];
+				// Normal
+				if (key.n >= 0) {
+					att[3] = mesh.normal[key.n][0];
+					att[4] = mesh.normal[key.n][1];
+					att[5] = mesh.normal[key.n][2];
+				}
+				// No color in (6, 7, 8)
+				// Texture coordinates
+				if (key.t >= 0) {
+					att[9] = mesh.tex_coord[key.t][0];
+					att[10] = mesh.tex_coord[key.t][1];
+				}
+				vertex.insert(vertex.end(), att, att + vertex_att);
+			}
+		}
+	}
+
+
+	void BuildSurfaceAreaTable(const TriMesh &mesh, std::vector<double> &cumulative_area) {
+
+		if (mesh.face.empty()) {
+			throw(std::ios_base::failure(std::string("Error: cannot sample particles from a mesh without faces")));
+		}
+
+		// Prefix sums, so a uniform value in [0, total area) picks each face with a probability proportional to its area
+		cumulative_area.resize(mesh.face.size());
+		double total = 0.0;
+		for (int i = 0; i < mesh.face.size(); i++)
+		{
+			const glm::vec3 &p0 = mesh.position[mesh.face[i].i[0]];
+			const glm::vec3 &p1 = mesh.position[mesh.face[i].i[1]];
+			const glm::vec3 &p2 = mesh.position[mesh.face[i].i[2]];
+			total += 0.5 * glm::length(glm::cross(p1 - p0, p2 - p0));
+			cumulative_area[i] = total;
+		}
+
+		if (total <= 0.0) {
+			throw(std::ios_base::failure(std::string("Error: cannot sample particles from a mesh without area")));
+		}
+	}
+
+
+	void SampleMeshParticles(const TriMesh &mesh, const std::vector<double> &cumulative_area, int num_particles, int first, int count, GeometryData &geometry) {
+
+		// Number of attributes for vertices
+		const int vertex_att = 11;
+
+		// Each chunk has its own stream, so the result does not depend on how chunks are spread over threads
+		std::seed_seq seed = { (unsigned int) num_particles, (unsigned int) first };
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<double> area_dist(0.0, cumulative_area.back());
+		std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+
+		for (int i = first; i < first + count; i++)
+		{
+			// Face by area, then a uniform point inside it
+			int u = std::upper_bound(cumulative_area.begin(), cumulative_area.end(), area_dist(generator)) - cumulative_area.begin();
+			if (u >= mesh.face.size()) { u = mesh.face.size() - 1; }
+			const Face &face = mesh.face[u];
+			float r1 = std::sqrt(unit_dist(generator));
+			float r2 = unit_dist(generator);
+			float w[3] = { 1.0f - r1, r1 * (1.0f - r2), r1 * r2 };
+
+			glm::vec3 position(0.0f), normal(0.0f);
+			for (int k = 0; k < 3; k++)
+			{
+				position += w[k] * mesh.position[face.i[k]];
+				if (face.n[k] >= 0) { normal += w[k] * mesh.normal[face.n[k]]; }
+			}
+			if (glm::length(normal) > 0.0f) { normal = glm::normalize(normal); }
+			glm::vec3 color(i / (float)num_particles, 0.0, 1.0 - (i / (float)num_particles));
+
+			GLfloat *out = &geometry.vertex[i * vertex_att];
+			for (int k = 0; k < 3; k++)
+			{
+				out[k] = position[k];
+				out[k + 3] = normal[k];
+				out[k + 6] = color[k];
+			}
+			// No texture coordinates in (9, 10)
+		}
+	}
+
+
+	void BuildMeshParticles(const TriMesh &mesh, int num_particles, GeometryData &geometry) {
+
+		// Number of attributes for vertices
+		const int vertex_att = 11;
+
+		std::vector<double> cumulative_area;
+		BuildSurfaceAreaTable(mesh, cumulative_area);
+
+		geometry.vertex.assign(num_particles * vertex_att, 0.0f);
+		geometry.face.clear();
+		for (int first = 0; first < num_particles; first += PARTICLE_SAMPLE_CHUNK)
+		{
+			SampleMeshParticles(mesh, cumulative_area, num_particles, first, std::min(PARTICLE_SAMPLE_CHUNK, num_particles - first), geometry);
+		}
+	}
+
+
+
+	void MergeGeometry(const std::vector<GeometryData> &part, GeometryData &geometry) {
+
+		// Number of attributes for vertices
+		const int vertex_att = 11;
+
+		geometry.vertex.clear();
+		geometry.face.clear();
+		for (int p = 0; p < part.size(); p++)
+		{
+			// Indices of this part start after the vertices of the previous parts
+			GLuint first_vertex = geometry.vertex.size() / vertex_att;
+			for (int i = 0; i < part[p].face.size(); i++)
+			{
+				geometry.face.push_back(part[p].face[i] + first_vertex);
+			}
+
+			// The red channel of the color holds the part index, like the particle id in point sets
+			int first_float = geometry.vertex.size();
+			geometry.vertex.insert(geometry.vertex.end(), part[p].vertex.begin(), part[p].vertex.end());
+			for (int i = first_float; i < geometry.vertex.size(); i += vertex_att)
+			{
+				geometry.vertex[i + 6] = (GLfloat) p;
+			}
+		}
+	}
+
+	void BuildSphereGeometry(float radius, int num_samples_theta, int num_samples_phi, GeometryData &geometry) {
+
+		// Create a sphere using a well-known parameterization
+
+		// Number of vertices and faces to be created
+		const GLuint vertex_num = num_samples_theta*num_samples_phi;
+		const GLuint face_num = num_samples_theta*(num_samples_phi - 1) * 2;
+
+		// Number of attributes for vertices and faces
+		const int vertex_att = 11;
+		const int face_att = 3;
+
+		geometry.vertex.resize(vertex_num * vertex_att);
+		geometry.face.resize(face_num * face_att);
+		GLfloat *vertex = &geometry.vertex[0];
+		GLuint *face = &geometry.face[0];
+
+		// Create vertices 
+		float theta, phi; // Angles for parametric equation
+		glm::vec3 vertex_position;
+		glm::vec3 vertex_normal;
+		glm::vec3 vertex_color;
+		glm::vec2 vertex_coord;
+
+		for (int i = 0; i < num_samples_theta; i++) {
+
+			theta = 2.0*glm::pi<GLfloat>()*i / (num_samples_theta - 1); // angle theta
+
+			for (int j = 0; j < num_samples_phi; j++) {
+
+				phi = glm::pi<GLfloat>()*j / (num_samples_phi - 1); // angle phi
+
+																	// Define position, normal and color of vertex
+				vertex_normal = glm::vec3(cos(theta)*sin(phi), sin(theta)*sin(phi), -cos(phi));
+				// We need z = -cos(phi) to make sure that the z coordinate runs from -1 to 1 as phi runs from 0 to pi
+				// Otherwise, the normal will be inverted
+				vertex_position = glm::vec3(vertex_normal.x*radius,
+					vertex_normal.y*radius,
+					vertex_normal.z*radius),
+					vertex_color = glm::vec3(((float)i) / ((float)num_samples_theta), 1.0 - ((float)j) / ((float)num_samples_phi), ((float)j) / ((float)num_samples_phi));
+				vertex_coord = glm::vec2(((float)i) / ((float)num_samples_theta), 1.0 - ((float)j) / ((float)num_samples_phi));
+
+				// Add vectors to the data buffer
+				for (int k = 0; k < 3; k++) {
+					vertex[(i*num_samples_phi + j)*vertex_att + k] = vertex_position[k];
+					vertex[(i*num_samples_phi + j)*vertex_att + k + 3] = vertex_normal[k];
+					vertex[(i*num_samples_phi + j)*vertex_att + k + 6] = vertex_color[k];
+				}
+				vertex[(i*num_samples_phi + j)*vertex_att + 9] = vertex_coord[0];
+				vertex[(i*num_samples_phi + j)*vertex_att + 10] = vertex_coord[1];
+			}
+		}
+
+		// Create faces
+		for (int i = 0; i < num_samples_theta; i++) {
+			for (int j = 0; j < (num_samples_phi - 1); j++) {
+				// Two triangles per quad
+				glm::vec3 t1(((i + 1) % num_samples_theta)*num_samples_phi + j,
+					i*num_samples_phi + (j + 1),
+					i*num_samples_phi + j);
+				glm::vec3 t2(((i + 1) % num_samples_theta)*num_samples_phi + j,
+					((i + 1) % num_samples_theta)*num_samples_phi + (j + 1),
+					i*num_samples_phi + (j + 1));
+				// Add two triangles to the data buffer
+				for (int k = 0; k < 3; k++) {
+					face[(i*(num_samples_phi - 1) + j)*face_att * 2 + k] = (GLuint)t1[k];
+					face[(i*(num_samples_phi - 1) + j)*face_att * 2 + k + face_att] = (GLuint)t2[k];
+				}
+			}
+		}
+	}
+
+	void BuildTorusGeometry(float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples, GeometryData &geometry)
+	{
+		// Create a torus
+		// The torus is built from a large loop with small circles around the loop
+
+		// Number of vertices and faces to be created
+		// Check the construction algorithm below to understand the numbers
+		// specified below
+		const GLuint vertex_num = num_loop_samples*num_circle_samples;
+		const GLuint face_num = num_loop_samples*num_circle_samples * 2;
+
+		// Number of attributes for vertices and faces
+		const int vertex_att = 11;
+		const int face_att = 3;
+
+		geometry.vertex.resize(vertex_num * vertex_att);
+		geometry.face.resize(face_num * face_att);
+		GLfloat *vertex = &geometry.vertex[0];
+		GLuint *face = &geometry.face[0];
+
+		// Create vertices 
+		float theta, phi; // Angles for circles
+		glm::vec3 loop_center;
+		glm::vec3 vertex_position;
+		glm::vec3 vertex_normal;
+		glm::vec3 vertex_color;
+		glm::vec2 vertex_coord;
+
+		for (int i = 0; i < num_loop_samples; i++) { // large loop
+
+			theta = 2.0*glm::pi<GLfloat>()*i / num_loop_samples; // loop sample (angle theta)
+			loop_center = glm::vec3(loop_radius*cos(theta), loop_radius*sin(theta), 0); // centre of a small circle
+
+			for (int j = 0; j < num_circle_samples; j++) { // small circle
+
+				phi = 2.0*glm::pi<GLfloat>()*j / num_circle_samples; // circle sample (angle phi)
+
+																	 // Define position, normal and color of vertex
+				vertex_normal = glm::vec3(cos(theta)*cos(phi), sin(theta)*cos(phi), sin(phi));
+				vertex_position = loop_center + vertex_normal*circle_radius;
+				vertex_color = glm::vec3(1.0 - ((float)i / (float)num_loop_samples),
+					(float)i / (float)num_loop_samples,
+					(float)j / (float)num_circle_samples);
+				vertex_coord = glm::vec2(theta / 2.0*glm::pi<GLfloat>(),
+					phi / 2.0*glm::pi<GLfloat>());
+
+				// Add vectors to the data buffer
+				for (int k = 0; k < 3; k++) {
+					vertex[(i*num_circle_samples + j)*vertex_att + k] = vertex_position[k];
+					vertex[(i*num_circle_samples + j)*vertex_att + k + 3] = vertex_normal[k];
+					vertex[(i*num_circle_samples + j)*vertex_att + k + 6] = vertex_color[k];
+				}
+				vertex[(i*num_circle_samples + j)*vertex_att + 9] = vertex_coord[0];
+				vertex[(i*num_circle_samples + j)*vertex_att + 10] = vertex_coord[1];
+			}
+		}
+
+		// Create triangles
+		for (int i = 0; i < num_loop_samples; i++) {
+			for (int j = 0; j < num_circle_samples; j++) {
+				// Two triangles per quad
+				glm::vec3 t1(((i + 1) % num_loop_samples)*num_circle_samples + j,
+					i*num_circle_samples + ((j + 1) % num_circle_samples),
+					i*num_circle_samples + j);
+				glm::vec3 t2(((i + 1) % num_loop_samples)*num_circle_samples + j,
+					((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
+					i*num_circle_samples + ((j + 1) % num_circle_samples));
+				// Add two triangles to the data buffer
+				for (int k = 0; k < 3; k++) {
+					face[(i*num_circle_samples + j)*face_att * 2 + k] = (GLuint)t1[k];
+					face[(i*num_circle_samples + j)*face_att * 2 + k + face_att] = (GLuint)t2[k];
+				}
+			}
+		}
+
+	}
+
+	void string_trim(std::string str, std::string to_trim) {
+
+		// Trim any character in to_trim from the beginning of the string str
+		while ((str.size() > 0) &&
+			(to_trim.find(str[0]) != std::string::npos)) {
+			str.erase(0);
+		}
+
+		// Trim any character in to_trim from the end of the string str
+		while ((str.size() > 0) &&
+			(to_trim.find(str[str.size() - 1]) != std::string::npos)) {
+			str.erase(str.size() - 1);
+		}
+	}
+
+
+	std::vector<std::string> string_split(std::string str, std::string separator) {
+
+		// Initialize output
+		std::vector<std::string> output;
+		output.push_back(std::string(""));
+		int string_index = 0;
+
+		// Analyze string
+		unsigned int i = 0;
+		while (i < str.size()) {
+			// Check if character i is a separator
+			if (separator.find(str[i]) != std::string::npos) {
+				// Split string
+				string_index++;
+				output.push_back(std::string(""));
+				// Skip separators
+				while ((i < str.size()) && (separator.find(str[i]) != std::string::npos)) {
+					i++;
+				}
+			}
+			else {
+				// Otherwise, copy string
+				output[string_index] += str[i];
+				i++;
+			}
+		}
+
+		return output;
+	}
+
+
+	std::vector<std::string> string_split_once(std::string str, std::string separator)
+	{
+		// Initialize output
+		std::vector<std::string> output;
+		output.push_back(std::string(""));
+		int string_index = 0;
+
+		// Analyze string
+		unsigned int i = 0;
+		while (i < str.size()) {
+			// Check if character i is a separator
+			if (separator.find(str[i]) != std::string::npos) {
+				// Split string
+				string_index++;
+				output.push_back(std::string(""));
+				// Skip single separator
+				i++;
+			}
+			else {
+				// Otherwise, copy string
+				output[string_index] += str[i];
+				i++;
+			}
+		}
+
+		return output;
+	}
+
+
+	void print_mesh(TriMesh &mesh) {
+
+		for (unsigned int i = 0; i < mesh.position.size(); i++) {
+			std::cout << "v " <<
+				mesh.position[i].x << " " <<
+				mesh.position[i].y << " " <<
+				mesh.position[i].z << std::endl;
+		}
+		for (unsigned int i = 0; i < mesh.normal.size(); i++) {
+			std::cout << "vn " <<
+				mesh.normal[i].x << " " <<
+				mesh.normal[i].y << " " <<
+				mesh.normal[i].z << std::endl;
+		}
+		for (unsigned int i = 0; i < mesh.tex_coord.size(); i++) {
+			std::cout << "vt " <<
+				mesh.tex_coord[i].x << " " <<
+				mesh.tex_coord[i].y << std::endl;
+		}
+		for (unsigned int i = 0; i < mesh.face.size(); i++) {
+			std::cout << "f " <<
+				mesh.face[i].i[0] << " " <<
+				mesh.face[i].i[1] << " " <<
+				mesh.face[i].i[2] << " " << std::endl;
+		}
+	}
+
+
+	template <typename T> std::string num_to_str(T num) {
+
+		std::ostringstream ss;
+		ss << num;
+		return ss.str();
+	}
+
+
+	template <typename T> T str_to_num(const std::string &str) {
+
+		std::istringstream ss(str);
+		T result;
+		ss >> result;
+		if (ss.fail()) {
+			throw(std::ios_base::failure(std::string("Invalid number: ") + str));
+		}
+		return result;
+	}
+} // namespace game
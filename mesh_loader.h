@@ -0,0 +1,36 @@
+#ifndef MESH_LOADER_H_
+#define MESH_LOADER_H_
+
+#include <vector>
+#include "gl_types.h"
+
+#include "model_loader.h"
+
+// Particles sampled by each chunk of a point set, chunks can run on different threads
+#define PARTICLE_SAMPLE_CHUNK 16384
+
+// MESH LOADER
+// CPU side of mesh loading: parsing and building the vertex/index arrays.
+// None of these functions touch OpenGL, so they can run on a worker thread
+namespace game
+{
+	// Vertex and index arrays of a geometry, ready to be copied to OpenGL buffers
+	// 11 attributes per vertex: 3D position (3), 3D normal (3), RGB color (3), 2D texture coordinates (2)
+	struct GeometryData
+	{
+		std::vector<GLfloat> vertex;	// Vertex attributes
+		std::vector<GLuint> face;		// Vertex indices (3 per triangle), empty for point sets
+		std::vector<GLsizei> lod_size;	// Indices in each level of detail, stored one after the other in face; empty for a single level
+	};
+
+	void LoadObj(const char *filename, TriMesh &mesh);												// Parse an obj file, computing normals if the file has none
+	void BuildMeshGeometry(const TriMesh &mesh, GeometryData &geometry);							// Build indexed triangles, sharing identical vertices
+	void BuildSurfaceAreaTable(const TriMesh &mesh, std::vector<double> &cumulative_area);			// Prefix sums of the face areas, for sampling particles
+	// Sample particles [first, first + count) uniformly over the surface of the mesh, into vertices already allocated in geometry
+	void SampleMeshParticles(const TriMesh &mesh, const std::vector<double> &cumulative_area, int num_particles, int first, int count, GeometryData &geometry);
+	void BuildMeshParticles(const TriMesh &mesh, int num_particles, GeometryData &geometry);		// Sample particles uniformly over the surface of the mesh
+	void MergeGeometry(const std::vector<GeometryData> &part, GeometryData &geometry);				// Concatenate mesh geometries, storing the part index in the red color channel
+	void BuildSphereGeometry(float radius, int num_samples_theta, int num_samples_phi, GeometryData &geometry);	// Indexed triangles of a sphere centered at the origin
+	void BuildTorusGeometry(float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples, GeometryData &geometry);	// Indexed triangles of a torus around the z axis
+} // namespace game
+#endif // MESH_LOADER_H_
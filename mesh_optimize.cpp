@@ -0,0 +1,260 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "mesh_optimize.h"
+
+// Forsyth's scoring parameters
+#define CACHE_DECAY_POWER 1.5f
+#define LAST_TRIANGLE_SCORE 0.75f
+#define VALENCE_BOOST_SCALE 2.0f
+#define VALENCE_BOOST_POWER 0.5f
+
+// MESH OPTIMIZATION
+namespace game
+{
+	/* Helpers */
+
+	// Score of a vertex from its position in the cache and its number of triangles still to draw
+	static float VertexScore(int cache_position, int remaining)
+	{
+		if (remaining == 0) { return -1.0f; }
+
+		float score = 0.0f;
+		if (cache_position >= 0)
+		{
+			// The vertices of the last triangle get a fixed score, so it is not immediately repeated
+			if (cache_position < 3) { score = LAST_TRIANGLE_SCORE; }
+			else
+			{
+				float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+				score = pow(1.0f - (cache_position - 3) * scale, CACHE_DECAY_POWER);
+			}
+		}
+
+		// Vertices with few triangles left are finished first, so they leave the cache for good
+		score += VALENCE_BOOST_SCALE * pow((float)remaining, -VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	float ComputeAcmr(const GLuint *index, int num_indices, int cache_size)
+	{
+		if (num_indices < 3) { return 0.0f; }
+
+		std::vector<GLuint> cache;
+		int misses = 0;
+		for (int i = 0; i < num_indices; i++)
+		{
+			if (std::find(cache.begin(), cache.end(), index[i]) != cache.end()) { continue; }
+
+			misses++;
+			cache.push_back(index[i]);
+			if (cache.size() > cache_size) { cache.erase(cache.begin()); }
+		}
+		return misses / (float)(num_indices / 3);
+	}
+
+	void OptimizeVertexCache(GLuint *index, int num_indices, int num_vertices)
+	{
+		int num_triangles = num_indices / 3;
+		if (num_triangles == 0) { return; }
+
+		// Triangles of each vertex
+		std::vector<int> remaining(num_vertices, 0);
+		for (int i = 0; i < num_indices; i++) { remaining[index[i]]++; }
+		std::vector<int> first_triangle(num_vertices + 1, 0);
+		for (int v = 0; v < num_vertices; v++) { first_triangle[v + 1] = first_triangle[v] + remaining[v]; }
+		std::vector<int> vertex_triangles(num_indices);
+		std::vector<int> fill(first_triangle.begin(), first_triangle.end() - 1);
+		for (int i = 0; i < num_indices; i++) { vertex_triangles[fill[index[i]]++] = i / 3; }
+
+		// Initial scores
+		std::vector<int> cache_position(num_vertices, -1);
+		std::vector<float> vertex_score(num_vertices);
+		for (int v = 0; v < num_vertices; v++) { vertex_score[v] = VertexScore(-1, remaining[v]); }
+		std::vector<float> triangle_score(num_triangles);
+		std::vector<bool> drawn(num_triangles, false);
+		for (int t = 0; t < num_triangles; t++)
+		{
+			triangle_score[t] = vertex_score[index[t * 3]] + vertex_score[index[t * 3 + 1]] + vertex_score[index[t * 3 + 2]];
+		}
+
+		std::vector<GLuint> order;
+		order.reserve(num_indices);
+		std::vector<GLuint> cache, new_cache;
+		int next_unused = 0;	// Triangles before this one are all drawn
+		for (int n = 0; n < num_triangles; n++)
+		{
+			// Best triangle touching the cache; when the cache has none, the best one overall
+			int best = -1;
+			float best_score = -1.0f;
+			for (int c = 0; c < cache.size(); c++)
+			{
+				GLuint v = cache[c];
+				for (int j = first_triangle[v]; j < first_triangle[v + 1]; j++)
+				{
+					int t = vertex_triangles[j];
+					if (!drawn[t] && triangle_score[t] > best_score) { best = t; best_score = triangle_score[t]; }
+				}
+			}
+			if (best < 0)
+			{
+				while (drawn[next_unused]) { next_unused++; }
+				best = next_unused;
+				for (int t = next_unused; t < num_triangles; t++)
+				{
+					if (!drawn[t] && triangle_score[t] > best_score) { best = t; best_score = triangle_score[t]; }
+				}
+			}
+
+			// Draw it and move its vertices to the front of the cache
+			drawn[best] = true;
+			const GLuint *tri = &index[best * 3];
+			order.insert(order.end(), tri, tri + 3);
+			new_cache.assign(tri, tri + 3);
+			for (int k = 0; k < 3; k++) { remaining[tri[k]]--; }
+			for (int c = 0; c < cache.size(); c++)
+			{
+				if (cache[c] != tri[0] && cache[c] != tri[1] && cache[c] != tri[2]) { new_cache.push_back(cache[c]); }
+			}
+
+			// Vertices pushed out of the cache lose their cache score
+			for (int c = VERTEX_CACHE_SIZE; c < new_cache.size(); c++) { cache_position[new_cache[c]] = -1; }
+			if (new_cache.size() > VERTEX_CACHE_SIZE) { new_cache.resize(VERTEX_CACHE_SIZE); }
+			cache.swap(new_cache);
+
+			// Update the scores of the vertices still in the cache, and of their triangles
+			for (int c = 0; c < cache.size(); c++) { cache_position[cache[c]] = c; }
+			for (int c = 0; c < cache.size(); c++)
+			{
+				GLuint v = cache[c];
+				float score = VertexScore(c, remaining[v]);
+				float delta = score - vertex_score[v];
+				vertex_score[v] = score;
+				for (int j = first_triangle[v]; j < first_triangle[v + 1]; j++) { triangle_score[vertex_triangles[j]] += delta; }
+			}
+		}
+
+		std::copy(order.begin(), order.end(), index);
+	}
+
+	void OptimizeOverdraw(const GLfloat *vertex, GLuint *index, int num_indices)
+	{
+		int num_triangles = num_indices / 3;
+		if (num_triangles == 0) { return; }
+
+		// Split the triangles where the cache order restarts anyway: a triangle whose
+		// three vertices all miss the cache costs the same at the start of any cluster
+		std::vector<int> cluster_start;
+		std::vector<GLuint> cache;
+		for (int t = 0; t < num_triangles; t++)
+		{
+			int misses = 0;
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint v = index[t * 3 + k];
+				if (std::find(cache.begin(), cache.end(), v) != cache.end()) { continue; }
+				misses++;
+				cache.push_back(v);
+				if (cache.size() > ACMR_CACHE_SIZE) { cache.erase(cache.begin()); }
+			}
+			if (t == 0 || misses == 3) { cluster_start.push_back(t); }
+		}
+		int num_clusters = cluster_start.size();
+		cluster_start.push_back(num_triangles);
+
+		// Center of the mesh, weighting each triangle by its area
+		std::vector<glm::vec3> centroid(num_clusters);
+		std::vector<glm::vec3> normal(num_clusters);
+		std::vector<float> area(num_clusters, 0.0f);
+		glm::vec3 mesh_centroid(0.0f);
+		float mesh_area = 0.0f;
+		for (int c = 0; c < num_clusters; c++)
+		{
+			for (int t = cluster_start[c]; t < cluster_start[c + 1]; t++)
+			{
+				const GLfloat *p0 = &vertex[index[t * 3] * VERTEX_FLOATS];
+				const GLfloat *p1 = &vertex[index[t * 3 + 1] * VERTEX_FLOATS];
+				const GLfloat *p2 = &vertex[index[t * 3 + 2] * VERTEX_FLOATS];
+				glm::vec3 a(p0[0], p0[1], p0[2]), b(p1[0], p1[1], p1[2]), d(p2[0], p2[1], p2[2]);
+				glm::vec3 n = glm::cross(b - a, d - a);
+				float triangle_area = glm::length(n);
+				centroid[c] += (a + b + d) * (triangle_area / 3.0f);
+				normal[c] += n;
+				area[c] += triangle_area;
+			}
+			mesh_centroid += centroid[c];
+			mesh_area += area[c];
+			if (area[c] > 0.0f) { centroid[c] /= area[c]; }
+		}
+		if (mesh_area > 0.0f) { mesh_centroid /= mesh_area; }
+
+		// Clusters far out along their normal tend to hide the others, so draw them first
+		std::vector<float> key(num_clusters);
+		std::vector<int> sorted(num_clusters);
+		for (int c = 0; c < num_clusters; c++)
+		{
+			float length = glm::length(normal[c]);
+			key[c] = (length > 0.0f) ? glm::dot(centroid[c] - mesh_centroid, normal[c] / length) : 0.0f;
+			sorted[c] = c;
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [&key](int a, int b) { return key[a] > key[b]; });
+
+		std::vector<GLuint> order;
+		order.reserve(num_indices);
+		for (int i = 0; i < num_clusters; i++)
+		{
+			int c = sorted[i];
+			order.insert(order.end(), index + cluster_start[c] * 3, index + cluster_start[c + 1] * 3);
+		}
+		std::copy(order.begin(), order.end(), index);
+	}
+
+	void OptimizeVertexFetch(GeometryData &geometry)
+	{
+		// New number of each vertex, in the order of first use; unused vertices are dropped
+		int num_vertices = geometry.vertex.size() / VERTEX_FLOATS;
+		std::vector<GLuint> remap(num_vertices, (GLuint)-1);
+		std::vector<GLfloat> vertex;
+		vertex.reserve(geometry.vertex.size());
+		GLuint next = 0;
+		for (int i = 0; i < geometry.face.size(); i++)
+		{
+			GLuint v = geometry.face[i];
+			if (remap[v] == (GLuint)-1)
+			{
+				remap[v] = next++;
+				vertex.insert(vertex.end(), &geometry.vertex[v * VERTEX_FLOATS], &geometry.vertex[v * VERTEX_FLOATS] + VERTEX_FLOATS);
+			}
+			geometry.face[i] = remap[v];
+		}
+		geometry.vertex.swap(vertex);
+	}
+
+	void OptimizeMesh(GeometryData &geometry, float &acmr_before, float &acmr_after)
+	{
+		int num_vertices = geometry.vertex.size() / VERTEX_FLOATS;
+		GLsizei full_size = geometry.lod_size.empty() ? geometry.face.size() : geometry.lod_size[0];
+		acmr_before = ComputeAcmr(geometry.face.empty() ? NULL : &geometry.face[0], full_size);
+
+		// Each level of detail is drawn on its own, so each is ordered on its own
+		std::vector<GLsizei> level_size(geometry.lod_size);
+		if (level_size.empty()) { level_size.push_back(geometry.face.size()); }
+		GLsizei first = 0;
+		for (int l = 0; l < level_size.size(); l++)
+		{
+			if (level_size[l] > 0)
+			{
+				OptimizeVertexCache(&geometry.face[first], level_size[l], num_vertices);
+				OptimizeOverdraw(&geometry.vertex[0], &geometry.face[first], level_size[l]);
+			}
+			first += level_size[l];
+		}
+
+		// The vertices follow the full detail level, which uses all of them
+		OptimizeVertexFetch(geometry);
+
+		acmr_after = ComputeAcmr(geometry.face.empty() ? NULL : &geometry.face[0], full_size);
+	}
+} // namespace game
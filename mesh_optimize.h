@@ -0,0 +1,28 @@
+#ifndef MESH_OPTIMIZE_H_
+#define MESH_OPTIMIZE_H_
+
+#include <vector>
+
+#include "mesh_loader.h"
+#include "vertex_format.h"
+
+// Size of the vertex cache the triangle order is optimized for
+#define VERTEX_CACHE_SIZE 32
+// Size of the FIFO cache used to report the average cache miss ratio
+#define ACMR_CACHE_SIZE 16
+
+// MESH OPTIMIZATION
+// Reorders the triangles and vertices of a loaded mesh for the GPU, without changing what is drawn:
+// vertex cache order, then overdraw order, then vertex fetch order
+namespace game
+{
+	float ComputeAcmr(const GLuint *index, int num_indices, int cache_size = ACMR_CACHE_SIZE);	// Vertices transformed per triangle with a FIFO cache
+	void OptimizeVertexCache(GLuint *index, int num_indices, int num_vertices);					// Forsyth's linear-speed vertex cache optimization
+	void OptimizeOverdraw(const GLfloat *vertex, GLuint *index, int num_indices);					// Put clusters facing away from the center first, keeping the cache order inside them
+	void OptimizeVertexFetch(GeometryData &geometry);											// Renumber vertices in the order they are first used
+
+	// Optimize every level of detail of a mesh; returns the average cache miss ratio
+	// of the full detail level before and after
+	void OptimizeMesh(GeometryData &geometry, float &acmr_before, float &acmr_after);
+} // namespace game
+#endif // MESH_OPTIMIZE_H_
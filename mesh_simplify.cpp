@@ -0,0 +1,226 @@
+#include <vector>
+#include <queue>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "mesh_simplify.h"
+
+// MESH SIMPLIFICATION
+namespace game
+{
+	/* Helpers */
+
+	// Symmetric 4x4 error matrix of a set of planes, stored as its 10 distinct coefficients
+	struct Quadric
+	{
+		double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+	};
+
+	// Edge collapse moving vertex from onto vertex to, valid while both versions are unchanged
+	struct Collapse
+	{
+		double cost;
+		GLuint from, to;
+		unsigned int from_version, to_version;
+
+		bool operator>(const Collapse &other) const { return cost > other.cost; }
+	};
+
+	static void AddPlane(Quadric &q, glm::vec3 n, float d, double weight)
+	{
+		q.a2 += weight * n.x * n.x; q.ab += weight * n.x * n.y; q.ac += weight * n.x * n.z; q.ad += weight * n.x * d;
+		q.b2 += weight * n.y * n.y; q.bc += weight * n.y * n.z; q.bd += weight * n.y * d;
+		q.c2 += weight * n.z * n.z; q.cd += weight * n.z * d;
+		q.d2 += weight * d * d;
+	}
+
+	static void AddQuadric(Quadric &q, const Quadric &other)
+	{
+		q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+		q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+		q.c2 += other.c2; q.cd += other.cd;
+		q.d2 += other.d2;
+	}
+
+	// Sum of the squared distances of p to the planes of q
+	static double QuadricError(const Quadric &q, glm::vec3 p)
+	{
+		double x = p.x, y = p.y, z = p.z;
+		return q.a2 * x * x + 2 * q.ab * x * y + 2 * q.ac * x * z + 2 * q.ad * x
+			+ q.b2 * y * y + 2 * q.bc * y * z + 2 * q.bd * y
+			+ q.c2 * z * z + 2 * q.cd * z
+			+ q.d2;
+	}
+
+	static glm::vec3 FaceNormal(const std::vector<glm::vec3> &position, GLuint i0, GLuint i1, GLuint i2)
+	{
+		return glm::cross(position[i1] - position[i0], position[i2] - position[i0]);
+	}
+
+	void BuildMeshLods(GeometryData &geometry)
+	{
+		geometry.lod_size.clear();
+		if (geometry.face.size() < LOD_MIN_INDICES) { return; }
+
+		int num_vertices = geometry.vertex.size() / VERTEX_FLOATS;
+		int num_faces = geometry.face.size() / 3;
+		std::vector<glm::vec3> position(num_vertices);
+		for (int i = 0; i < num_vertices; i++)
+		{
+			const GLfloat *v = &geometry.vertex[i * VERTEX_FLOATS];
+			position[i] = glm::vec3(v[0], v[1], v[2]);
+		}
+
+		// Working copy of the faces, and the faces around each vertex
+		std::vector<GLuint> face(geometry.face);
+		std::vector<bool> face_alive(num_faces, true);
+		std::vector<std::vector<int> > vertex_faces(num_vertices);
+		for (int f = 0; f < num_faces; f++)
+		{
+			for (int k = 0; k < 3; k++) { vertex_faces[face[f * 3 + k]].push_back(f); }
+		}
+
+		// Each vertex starts with the planes of its faces, weighted by area
+		Quadric zero = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		std::vector<Quadric> quadric(num_vertices, zero);
+		std::map<std::pair<GLuint, GLuint>, int> edge_count;
+		for (int f = 0; f < num_faces; f++)
+		{
+			GLuint *i = &face[f * 3];
+			glm::vec3 n = FaceNormal(position, i[0], i[1], i[2]);
+			float area2 = glm::length(n);
+			if (area2 > 0)
+			{
+				n /= area2;
+				for (int k = 0; k < 3; k++) { AddPlane(quadric[i[k]], n, -glm::dot(n, position[i[0]]), 0.5 * area2); }
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint a = i[k], b = i[(k + 1) % 3];
+				edge_count[std::make_pair(std::min(a, b), std::max(a, b))]++;
+			}
+		}
+
+		// Edges with one face are open borders or texture seams: add a plane through the
+		// edge, perpendicular to the face, so collapses keep them in place
+		for (int f = 0; f < num_faces; f++)
+		{
+			GLuint *i = &face[f * 3];
+			glm::vec3 n = FaceNormal(position, i[0], i[1], i[2]);
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint a = i[k], b = i[(k + 1) % 3];
+				if (edge_count[std::make_pair(std::min(a, b), std::max(a, b))] != 1) { continue; }
+
+				glm::vec3 edge = position[b] - position[a];
+				glm::vec3 border = glm::cross(edge, n);
+				float length = glm::length(border);
+				if (length == 0) { continue; }
+				border /= length;
+				double weight = LOD_BOUNDARY_WEIGHT * glm::dot(edge, edge);
+				AddPlane(quadric[a], border, -glm::dot(border, position[a]), weight);
+				AddPlane(quadric[b], border, -glm::dot(border, position[a]), weight);
+			}
+		}
+
+		// Queue both directions of every edge, cheapest first
+		std::vector<bool> vertex_alive(num_vertices, true);
+		std::vector<unsigned int> version(num_vertices, 0);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > queue;
+		std::vector<Quadric> &q = quadric;
+		auto push = [&](GLuint from, GLuint to) {
+			Quadric sum = q[from];
+			AddQuadric(sum, q[to]);
+			Collapse c = { QuadricError(sum, position[to]), from, to, version[from], version[to] };
+			queue.push(c);
+		};
+		for (int f = 0; f < num_faces; f++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				push(face[f * 3 + k], face[f * 3 + (k + 1) % 3]);
+				push(face[f * 3 + (k + 1) % 3], face[f * 3 + k]);
+			}
+		}
+
+		// Collapse down to each level in turn, so every level refines the next one
+		geometry.lod_size.push_back(geometry.face.size());
+		int live_faces = num_faces;
+		for (int level = 1; level < MAX_LOD_LEVELS; level++)
+		{
+			int target = num_faces >> level;
+			while (live_faces > target && !queue.empty())
+			{
+				Collapse c = queue.top();
+				queue.pop();
+				if (!vertex_alive[c.from] || !vertex_alive[c.to] || version[c.from] != c.from_version || version[c.to] != c.to_version) { continue; }
+
+				// The vertices must still share a face, and no other face may flip
+				bool shared = false, flipped = false;
+				for (int j = 0; j < vertex_faces[c.from].size() && !flipped; j++)
+				{
+					int f = vertex_faces[c.from][j];
+					if (!face_alive[f]) { continue; }
+					GLuint *i = &face[f * 3];
+					if (i[0] == c.to || i[1] == c.to || i[2] == c.to) { shared = true; continue; }
+
+					GLuint moved[3] = { i[0], i[1], i[2] };
+					for (int k = 0; k < 3; k++) { if (moved[k] == c.from) { moved[k] = c.to; } }
+					glm::vec3 before = FaceNormal(position, i[0], i[1], i[2]);
+					glm::vec3 after = FaceNormal(position, moved[0], moved[1], moved[2]);
+					if (glm::dot(before, after) <= 0) { flipped = true; }
+				}
+				if (!shared || flipped) { continue; }
+
+				// Faces on the edge disappear, the others move to the kept vertex
+				for (int j = 0; j < vertex_faces[c.from].size(); j++)
+				{
+					int f = vertex_faces[c.from][j];
+					if (!face_alive[f]) { continue; }
+					GLuint *i = &face[f * 3];
+					if (i[0] == c.to || i[1] == c.to || i[2] == c.to)
+					{
+						face_alive[f] = false;
+						live_faces--;
+						continue;
+					}
+					for (int k = 0; k < 3; k++) { if (i[k] == c.from) { i[k] = c.to; } }
+					vertex_faces[c.to].push_back(f);
+				}
+				vertex_alive[c.from] = false;
+				AddQuadric(q[c.to], q[c.from]);
+				version[c.to]++;
+
+				// Costs around the kept vertex changed
+				for (int j = 0; j < vertex_faces[c.to].size(); j++)
+				{
+					int f = vertex_faces[c.to][j];
+					if (!face_alive[f]) { continue; }
+					for (int k = 0; k < 3; k++)
+					{
+						GLuint w = face[f * 3 + k];
+						if (w == c.to) { continue; }
+						push(c.to, w);
+						push(w, c.to);
+					}
+				}
+			}
+
+			// Stop when the mesh cannot get much simpler
+			GLsizei previous = geometry.lod_size.back();
+			GLsizei size = live_faces * 3;
+			if (size > previous * (1.0 - LOD_MIN_REDUCTION)) { break; }
+
+			for (int f = 0; f < num_faces; f++)
+			{
+				if (face_alive[f]) { geometry.face.insert(geometry.face.end(), &face[f * 3], &face[f * 3] + 3); }
+			}
+			geometry.lod_size.push_back(size);
+		}
+
+		// A single level is the same as no levels
+		if (geometry.lod_size.size() == 1) { geometry.lod_size.clear(); }
+	}
+} // namespace game
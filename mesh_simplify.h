@@ -0,0 +1,24 @@
+#ifndef MESH_SIMPLIFY_H_
+#define MESH_SIMPLIFY_H_
+
+#include "mesh_loader.h"
+#include "resource.h"
+
+// Meshes with fewer indices than this are drawn at full detail only
+#define LOD_MIN_INDICES (3 * 256)
+// A level is only kept if it removes at least this fraction of the triangles of the previous one
+#define LOD_MIN_REDUCTION 0.2
+// Weight of the planes that keep open borders and texture seams in place
+#define LOD_BOUNDARY_WEIGHT 100.0
+
+// MESH SIMPLIFICATION
+// Levels of detail built when a mesh is loaded. Each level is a coarser set of triangles
+// over the same vertices, so all levels share one vertex range in the mesh buffers
+namespace game
+{
+	// Simplify the faces of a mesh with quadric error edge collapses, appending up to
+	// MAX_LOD_LEVELS - 1 coarser levels, with half the triangles of the previous one each,
+	// after the full detail faces. Fills geometry.lod_size
+	void BuildMeshLods(GeometryData &geometry);
+} // namespace game
+#endif // MESH_SIMPLIFY_H_
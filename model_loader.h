@@ -5,9 +5,9 @@
 #include <string>
 #include <fstream>
 #include <sstream>
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include <vector>
+#include <cstddef>
+#include "gl_types.h"
 #include <glm/glm.hpp>
 
 namespace game {
@@ -28,6 +28,28 @@ struct Quad {
     int t[4];
 };
 
+// Indices of one face corner (position, normal, texture coordinate). Corners
+// with the same key can share a single vertex in the vertex buffer
+struct VertexKey {
+    int i;
+    int n;
+    int t;
+
+    bool operator==(const VertexKey &other) const {
+        return (i == other.i) && (n == other.n) && (t == other.t);
+    }
+};
+
+// Hash function for VertexKey, so it can be used in unordered containers
+struct VertexKeyHash {
+    std::size_t operator()(const VertexKey &key) const {
+        std::size_t h = (std::size_t)key.i * 73856093u;
+        h ^= (std::size_t)key.n * 19349663u;
+        h ^= (std::size_t)key.t * 83492791u;
+        return h;
+    }
+};
+
 // A mesh stored in memory
 struct TriMesh {
     std::vector<glm::vec3> position;
@@ -1,30 +1,78 @@
+#include <algorithm>
+
 #include "particleNode.h"
+#include "clock.h"
 #include "time.h"
 
 namespace game
 {
+	/* Particle budget shared by all systems */
+	std::vector<ParticleNode *> ParticleNode::systems;
+	int ParticleNode::budget = PARTICLE_BUDGET;
+
 	/* Constructor */
 	ParticleNode::ParticleNode(SceneNode *part) {
 		particle = part; 
 		particle->SetVisible(false);
 		particle->SetBlending(true);
 		shouldDisappear = false;
+		gpu = NULL;
+		instances = NULL;
+		timer = 999;	// Not animating until startAnimate
+		systems.push_back(this);
+	}
+
+	ParticleNode::ParticleNode(SceneNode *part, ParticleSimulation *system) {
+		// Always drawn, dead particles are discarded by the shaders
+		particle = part;
+		particle->SetBlending(true);
+		shouldDisappear = false;
+		gpu = system;
+		instances = NULL;
+		timer = 999;
+		lasttime = Clock::GetTime();
+		systems.push_back(this);
+	}
+
+	ParticleNode::ParticleNode(SceneNode *part, const ParticleInstances *copies) {
+		// The node starts and expires its copies itself, the system only shares the budget
+		particle = part;
+		shouldDisappear = false;
+		gpu = NULL;
+		instances = copies;
+		timer = 999;
+		systems.push_back(this);
 	}
 
 	/* Destructor */
-	ParticleNode::~ParticleNode() {}
+	ParticleNode::~ParticleNode() 
+	{
+		systems.erase(std::remove(systems.begin(), systems.end(), this), systems.end());
+		delete gpu;
+	}
 
 	/* Getters */
 	SceneNode *ParticleNode::getParticle() { return particle; }
+	ParticleSimulation *ParticleNode::getSystem() { return gpu; }
 
 	/* Updates */
 	void ParticleNode::update() 
 	{
+		// Step the GPU simulation and draw its latest state
+		if (gpu)
+		{
+			double now = Clock::GetTime();
+			gpu->Update((float)std::min(now - lasttime, 0.1));
+			lasttime = now;
+			particle->SetArrayBuffer(gpu->GetArrayBuffer());
+			return;
+		}
+
 		if (timer == 999) return;
 		if (timer > 0)
 		{
-			timer -= (glfwGetTime() - lasttime);
-			lasttime = glfwGetTime();
+			timer -= (Clock::GetTime() - lasttime);
+			lasttime = Clock::GetTime();
 			if (timer < 0)
 				shouldDisappear = true;
 		}
@@ -40,9 +88,73 @@ namespace game
 		particle->updateTime();
 		particle->SetVisible(true);
 		timer = duration;
-		lasttime = glfwGetTime();
+		lasttime = Clock::GetTime();
 		shouldDisappear = false;
 	}
 
 	void ParticleNode::deleteNode() { particle->del = true; }
+
+	void ParticleNode::emit(int count, glm::vec3 position, glm::vec3 velocity, float speed, float lifetime)
+	{
+		if (gpu) { gpu->Emit(count, position, velocity, speed, lifetime); }
+	}
+
+	/* Level of detail */
+	void ParticleNode::setBudget(int points) { budget = points; }
+
+	int ParticleNode::numCopies(void) const { return instances ? instances->GetNumInstances() : 1; }
+
+	int ParticleNode::desiredCount(const Camera *camera) const
+	{
+		// Centers of the copies, from the matrices of the last frame
+		std::vector<glm::vec3> center;
+		if (instances)
+		{
+			for (int i = 0; i < instances->GetNumInstances(); i++) { center.push_back(instances->GetInstanceCenter(i)); }
+		}
+		else
+		{
+			glm::mat4 world = particle->GetWorldMatrix();
+			center.push_back(glm::vec3(world[3].x, world[3].y, world[3].z));
+		}
+
+		// Radius on screen of the largest copy, all copies draw the same points
+		glm::vec3 scale = particle->GetScale();
+		float radius = particle->GetBoundingRadius() * std::max(scale.x, std::max(scale.y, scale.z));
+		float pixels = 0.0f;
+		for (int i = 0; i < center.size(); i++)
+		{
+			float distance = glm::length(center[i] - camera->GetPosition());
+			if (distance <= radius) { return particle->GetFullSize(); }
+			pixels = std::max(pixels, radius * camera->GetPixelScale() / distance);
+		}
+
+		// The points cover the area of the system, so keep their density on screen constant
+		float share = std::min(1.0f, (float)(pixels * pixels / (PARTICLE_FULL_DETAIL_PIXELS * PARTICLE_FULL_DETAIL_PIXELS)));
+		return std::max(PARTICLE_MIN_COUNT, (int)(particle->GetFullSize() * share));
+	}
+
+	void ParticleNode::selectDrawCounts(const Camera *camera)
+	{
+		// Systems whose node was deleted are never drawn again
+		for (int i = 0; i < systems.size(); i++)
+		{
+			if (systems[i]->particle->del) { systems.erase(systems.begin() + i); i--; }
+		}
+
+		// What each visible system wants, then scale everything down to fit the budget
+		std::vector<int> desired(systems.size(), 0);
+		long long total = 0;
+		for (int i = 0; i < systems.size(); i++)
+		{
+			if (!systems[i]->particle->IsDrawable() || systems[i]->gpu) { continue; }	// GPU systems have live particles anywhere in the buffer
+			desired[i] = systems[i]->desiredCount(camera);
+			total += (long long)desired[i] * systems[i]->numCopies();
+		}
+		double scale = (total > budget) ? budget / (double)total : 1.0;
+		for (int i = 0; i < systems.size(); i++)
+		{
+			if (desired[i] > 0) { systems[i]->particle->SetDrawCount(std::max(PARTICLE_MIN_COUNT, (int)(desired[i] * scale))); }
+		}
+	}
 }
@@ -1,15 +1,38 @@
 #ifndef PARTICLENODE_H
 #define PARTICLENODE_H
 
+#include <vector>
+
 #include "scene_node.h"
+#include "camera.h"
+#include "particle_simulation.h"
+
+// Projected radius in pixels at which a particle system draws all its points;
+// smaller systems draw a share of them proportional to their area on screen
+#define PARTICLE_FULL_DETAIL_PIXELS 150.0
+// Fewest points drawn by a visible particle system
+#define PARTICLE_MIN_COUNT 64
+// Default number of points drawn each frame by all particle systems together
+#define PARTICLE_BUDGET 150000
 
 // PARTICLE SYSTEM 
 namespace game
 {
+	// Node drawing several copies of its particles with one call, each copy at its own place
+	class ParticleInstances
+	{
+	public:
+		virtual ~ParticleInstances() {}
+		virtual int GetNumInstances(void) const = 0;
+		virtual glm::vec3 GetInstanceCenter(int index) const = 0;						// World position of a copy
+	};
+
 	class ParticleNode
 	{
 	public:
 		ParticleNode(SceneNode *);
+		ParticleNode(SceneNode *, ParticleSimulation *);									// particle system simulated elsewhere, like on the GPU, drawn by the node
+		ParticleNode(SceneNode *, const ParticleInstances *);								// copies of a system drawn by one node, only for the budget
 		~ParticleNode();
 
 		bool shouldDisappear;																// get rid of the particle system
@@ -19,11 +42,24 @@ namespace game
 		void updatePosition(glm::vec3 position);											// update particle system position
 		SceneNode *getParticle(void);														// getter for the particle
 		void deleteNode(void);																// delete the particle system by trying to delete the sceneNode
+		void emit(int count, glm::vec3 position, glm::vec3 velocity, float speed, float lifetime);	// spawn particles of a simulated system
+		ParticleSimulation *getSystem(void);												// simulation, NULL for systems animated by their shaders
+
+		static void setBudget(int budget);													// number of points all systems may draw in a frame
+		static void selectDrawCounts(const Camera *camera);									// pick how many points each visible system draws this frame
 
 	private:
 		double timer;																		// timer for the animations
 		double lasttime;																	// storing previous time to subtract from timer for animations
 		SceneNode *particle;																// SceneNode to store particle system
+		ParticleSimulation *gpu;															// simulation, NULL if the shaders animate the particles
+		const ParticleInstances *instances;													// copies drawn by the node, NULL if it draws the system once
+
+		int desiredCount(const Camera *camera) const;										// points worth drawing at the system's size on screen, for each copy
+		int numCopies(void) const;															// copies of the system drawn each frame
+
+		static std::vector<ParticleNode *> systems;											// all particle systems that were not deleted
+		static int budget;																	// points all systems may draw in a frame
 	};
 }
 #endif PARTICLENODE_H
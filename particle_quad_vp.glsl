@@ -0,0 +1,91 @@
+#version 400
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 normal;
+in vec3 color;
+in vec2 corner; // Corner of the quad, the same four vertices for every particle
+
+// Uniform (global) buffer
+uniform mat4 world_mat;
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+uniform mat4 normal_mat;
+uniform float timer;
+
+// Instances drawn in one call by the particle system manager
+#define MAX_PARTICLE_INSTANCES 16
+uniform int num_instances = 0; // 0 when the node is drawn on its own
+uniform mat4 instance_world_mat[MAX_PARTICLE_INSTANCES];
+uniform mat4 instance_normal_mat[MAX_PARTICLE_INSTANCES];
+uniform float instance_timer[MAX_PARTICLE_INSTANCES];
+
+// Attributes passed to the fragment shader
+out vec4 frag_color;
+out vec2 tex_coord;
+
+// Attributes of the particle, expanded to the quad below
+vec4 particle_color;
+float particle_id;
+
+// Size of the quad in camera space
+float particle_size = 0.05;
+
+// Simulation parameters (constants)
+uniform vec3 up_vec = vec3(0.0, 1.0, 0.0); // Up direction
+float accel = 1.2; // An acceleration applied to the particles coming from some attraction force
+float speed = 0.5; // Control the speed of the motion
+float grav = 1.2; // gravity
+
+// Define some useful constants
+const float pi = 3.1415926536;
+const float pi_over_two = 1.5707963268;
+const float two_pi = 2.0*pi;
+
+
+void main()
+{
+    // Matrices and timer of the instance, or of the node
+    mat4 world = world_mat;
+    mat4 normal_world = normal_mat;
+    float time = timer;
+    if (num_instances > 0)
+    {
+        int instance_index = gl_InstanceID % num_instances; // One call draws every instance, each particle once per instance
+        world = instance_world_mat[instance_index];
+        normal_world = instance_normal_mat[instance_index];
+        time = instance_timer[instance_index];
+    }
+
+    // Define particle id
+    particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
+                                   
+
+	float circtime = time - 4.0 * floor(time / 4);
+    float t = circtime - 1; // Our time parameter
+
+	vec4 position = world * vec4(vertex, 1.0);
+	vec4 norm = normal_world * vec4(normal, 1.0);
+
+
+    // First, work in local model coordinates (do not apply any transformation)
+	if (circtime > 1)
+	{
+		position.x += norm.x * t * speed - grav * speed * up_vec.x * t * t;
+		position.y += norm.y * t * speed - grav * speed * up_vec.y * t * t;
+		position.z += norm.z * t * speed - grav * speed * up_vec.z * t * t;
+	}
+
+	// Define output position but do not apply the projection matrix yet
+    gl_Position = view_mat * position;
+    
+    // Define amount of blending depending on the cyclic time
+    float alpha = 1.0 - circtime/3;
+    particle_color = vec4(color, alpha);
+
+    // Move to the corner of the quad in camera space, as the geometry shader does
+    gl_Position = projection_mat * (gl_Position + vec4((corner - 0.5) * particle_size, 0.0, 0.0));
+    int fid = int(floor(particle_id * 4.0)); // 0-3 used to pick sector from flame 2x2 drawing
+    tex_coord = vec2(corner.y*0.5 + 0.5*(fid / 2), corner.x*0.5 + 0.5*(fid % 2));
+    frag_color = particle_color;
+}
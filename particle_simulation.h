@@ -0,0 +1,24 @@
+#ifndef PARTICLE_SIMULATION_H_
+#define PARTICLE_SIMULATION_H_
+
+#include <glm/glm.hpp>
+
+#include "gl_types.h"
+
+// PARTICLE SIMULATION
+namespace game
+{
+	// Particles simulated outside of their particle node, like on the GPU. The node
+	// only steps the simulation and draws its latest state, so it needs no OpenGL
+	class ParticleSimulation
+	{
+	public:
+		virtual ~ParticleSimulation() {}
+
+		// Spawn count particles at position, moving with velocity plus a random direction of the given speed
+		virtual void Emit(int count, glm::vec3 position, glm::vec3 velocity, float speed, float lifetime) = 0;
+		virtual void Update(float delta_time) = 0;		// Advance the simulation and spawn the emitted particles
+		virtual GLuint GetArrayBuffer(void) const = 0;	// Buffer holding the latest state, to draw from
+	}; // class ParticleSimulation
+} // namespace game
+#endif // PARTICLE_SIMULATION_H_
@@ -0,0 +1,135 @@
+#include <stdexcept>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "particle_system_manager.h"
+#include "clock.h"
+#include "gl_calls.h"
+
+// PARTICLE SYSTEM MANAGER
+namespace game
+{
+	/* Constructor */
+	ParticleEffectNode::ParticleEffectNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture) : SceneNode(name, geometry, material, texture)
+	{
+		SetVisible(false);
+		SetBlending(true);
+		budget_ = new ParticleNode(this, this);
+	}
+
+	/* Destructor */
+	ParticleEffectNode::~ParticleEffectNode() { delete budget_; }
+
+	int ParticleEffectNode::GetNumInstances(void) const { return instances_.size(); }
+
+	glm::vec3 ParticleEffectNode::GetInstanceCenter(int index) const
+	{
+		// The instances are placed in the frame of the parent, like in SetupShader
+		glm::mat4 parent = GetWorldMatrix() * glm::scale(glm::mat4(1.0), 1.0f / GetScale());
+		glm::vec4 center = parent * glm::vec4(instances_[index].position, 1.0f);
+		return glm::vec3(center.x, center.y, center.z);
+	}
+
+	void ParticleEffectNode::Start(glm::vec3 position, glm::quat orientation, double duration)
+	{
+		if (instances_.size() == MAX_PARTICLE_INSTANCES) { instances_.erase(instances_.begin()); }
+
+		ParticleInstance instance;
+		instance.position = position;
+		instance.orientation = orientation;
+		instance.start_time = Clock::GetTime();
+		instance.duration = duration;
+		instances_.push_back(instance);
+
+		SetInstanceCount(instances_.size());
+		SetVisible(true);
+	}
+
+	void ParticleEffectNode::Expire(double time, std::vector<ParticleInstance> &expired)
+	{
+		for (int i = 0; i < instances_.size(); i++)
+		{
+			if (time - instances_[i].start_time >= instances_[i].duration)
+			{
+				expired.push_back(instances_[i]);
+				instances_.erase(instances_.begin() + i);
+				i--;
+			}
+		}
+
+		SetInstanceCount(instances_.size());
+		SetVisible(!instances_.empty());
+	}
+
+	void ParticleEffectNode::SetupShader(GLuint program)
+	{
+		SceneNode::SetupShader(program);
+
+		// The node stays at the origin of its parent, so its world matrix is the parent's with the scaling of the effect
+		glm::mat4 scaling = glm::scale(glm::mat4(1.0), GetScale());
+		glm::mat4 parent = GetWorldMatrix() * glm::scale(glm::mat4(1.0), 1.0f / GetScale());
+
+		glm::mat4 instance_mat[MAX_PARTICLE_INSTANCES];
+		glm::mat4 instance_normal_mat[MAX_PARTICLE_INSTANCES];
+		GLfloat instance_timer[MAX_PARTICLE_INSTANCES];
+		double current_time = Clock::GetTime();
+		for (int i = 0; i < instances_.size(); i++)
+		{
+			glm::mat4 transf = parent * glm::translate(glm::mat4(1.0), instances_[i].position) * glm::mat4_cast(instances_[i].orientation);
+			instance_mat[i] = transf * scaling;
+			instance_normal_mat[i] = glm::transpose(glm::inverse(transf));
+			instance_timer[i] = (GLfloat)(current_time - instances_[i].start_time);
+		}
+
+		GLint num_instances_var = glGetUniformLocation(program, "num_instances");
+		Gl::Uniform1i(num_instances_var, instances_.size());
+		if (instances_.empty()) { return; }
+		GLint instance_mat_var = glGetUniformLocation(program, "instance_world_mat");
+		Gl::UniformMatrix4fv(instance_mat_var, instances_.size(), GL_FALSE, glm::value_ptr(instance_mat[0]));
+		GLint instance_normal_mat_var = glGetUniformLocation(program, "instance_normal_mat");
+		Gl::UniformMatrix4fv(instance_normal_mat_var, instances_.size(), GL_FALSE, glm::value_ptr(instance_normal_mat[0]));
+		GLint instance_timer_var = glGetUniformLocation(program, "instance_timer");
+		Gl::Uniform1fv(instance_timer_var, instances_.size(), instance_timer);
+	}
+
+	/* Constructor */
+	ParticleSystemManager::ParticleSystemManager(void) {}
+
+	/* Destructor */
+	ParticleSystemManager::~ParticleSystemManager() {}
+
+	void ParticleSystemManager::AddEffect(const std::string name, ParticleEffectNode *node, double duration, const std::string next)
+	{
+		Effect effect;
+		effect.node = node;
+		effect.duration = duration;
+		effect.next = next;
+		effects_[name] = effect;
+	}
+
+	void ParticleSystemManager::Start(const std::string name, glm::vec3 position, glm::quat orientation)
+	{
+		std::map<std::string, Effect>::iterator it = effects_.find(name);
+		if (it == effects_.end()) { throw(std::invalid_argument(std::string("Unknown particle effect ") + name)); }
+
+		it->second.node->Start(position, orientation, it->second.duration);
+	}
+
+	void ParticleSystemManager::Update(void)
+	{
+		double current_time = Clock::GetTime();
+
+		// Collect everything that expired first, so chained effects do not expire in the same update
+		std::vector<std::pair<std::string, ParticleInstance> > chained;
+		for (std::map<std::string, Effect>::iterator it = effects_.begin(); it != effects_.end(); it++)
+		{
+			std::vector<ParticleInstance> expired;
+			it->second.node->Expire(current_time, expired);
+			if (it->second.next.empty()) { continue; }
+			for (int i = 0; i < expired.size(); i++) { chained.push_back(std::make_pair(it->second.next, expired[i])); }
+		}
+
+		for (int i = 0; i < chained.size(); i++) { Start(chained[i].first, chained[i].second.position, chained[i].second.orientation); }
+	}
+} // namespace game
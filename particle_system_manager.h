@@ -0,0 +1,76 @@
+#ifndef PARTICLE_SYSTEM_MANAGER_H_
+#define PARTICLE_SYSTEM_MANAGER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "scene_node.h"
+#include "particleNode.h"
+
+// Instances of one effect drawn together, must match the size of the instance arrays in the particle shaders
+#define MAX_PARTICLE_INSTANCES 16
+
+// PARTICLE SYSTEM MANAGER
+namespace game
+{
+	// One running copy of an effect
+	struct ParticleInstance
+	{
+		glm::vec3 position;
+		glm::quat orientation;
+		double start_time;		// Time the effect started, its shaders animate from there
+		double duration;		// Seconds before it expires
+	};
+
+	// Draws all running instances of an effect in one instanced call. The shaders
+	// read the matrices and timer of gl_InstanceID instead of those of the node.
+	// The instances share the particle budget, drawing as many points as the largest one on screen
+	class ParticleEffectNode : public SceneNode, public ParticleInstances
+	{
+	public:
+		ParticleEffectNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture = 0);
+		~ParticleEffectNode();
+
+		// Start an instance; when all are running, the oldest one is restarted
+		void Start(glm::vec3 position, glm::quat orientation, double duration);
+		// Remove the instances whose duration has passed at the given time, adding them to expired
+		void Expire(double time, std::vector<ParticleInstance> &expired);
+		int GetNumInstances(void) const;
+		glm::vec3 GetInstanceCenter(int index) const;
+
+	protected:
+		void SetupShader(GLuint program);	// Also set the matrices and timers of the instances
+
+	private:
+		std::vector<ParticleInstance> instances_;	// Running instances, oldest first
+		ParticleNode *budget_;						// Share of the particle budget
+	}; // class ParticleEffectNode
+
+	// Pools of particle effects. Any number of copies of an effect can run at the same
+	// time, they expire on their own and may start another effect where they end
+	class ParticleSystemManager
+	{
+	public:
+		ParticleSystemManager(void);
+		~ParticleSystemManager();
+
+		// Add an effect lasting duration seconds, then starting the effect named next if there is one
+		void AddEffect(const std::string name, ParticleEffectNode *node, double duration, const std::string next = "");
+		// Start a copy of an effect
+		void Start(const std::string name, glm::vec3 position, glm::quat orientation);
+		// Expire the effects that are done and start the ones they lead to
+		void Update(void);
+
+	private:
+		struct Effect
+		{
+			ParticleEffectNode *node;	// Node drawing the instances
+			double duration;
+			std::string next;			// Effect started when an instance expires
+		};
+
+		std::map<std::string, Effect> effects_;
+	}; // class ParticleSystemManager
+} // namespace game
+#endif // PARTICLE_SYSTEM_MANAGER_H_
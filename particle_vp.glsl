@@ -11,6 +11,13 @@ uniform mat4 view_mat;
 uniform mat4 normal_mat;
 uniform float timer;
 
+// Instances drawn in one call by the particle system manager
+#define MAX_PARTICLE_INSTANCES 16
+uniform int num_instances = 0; // 0 when the node is drawn on its own
+uniform mat4 instance_world_mat[MAX_PARTICLE_INSTANCES];
+uniform mat4 instance_normal_mat[MAX_PARTICLE_INSTANCES];
+uniform float instance_timer[MAX_PARTICLE_INSTANCES];
+
 // Attributes forwarded to the geometry shader
 out vec4 particle_color;
 out float particle_id;
@@ -29,15 +36,26 @@ const float two_pi = 2.0*pi;
 
 void main()
 {
+    // Matrices and timer of the instance, or of the node
+    mat4 world = world_mat;
+    mat4 normal_world = normal_mat;
+    float time = timer;
+    if (num_instances > 0)
+    {
+        world = instance_world_mat[gl_InstanceID];
+        normal_world = instance_normal_mat[gl_InstanceID];
+        time = instance_timer[gl_InstanceID];
+    }
+
     // Define particle id
     particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
                                    
 
-	float circtime = timer - 4.0 * floor(timer / 4);
+	float circtime = time - 4.0 * floor(time / 4);
     float t = circtime - 1; // Our time parameter
 
-	vec4 position = world_mat * vec4(vertex, 1.0);
-	vec4 norm = normal_mat * vec4(normal, 1.0);
+	vec4 position = world * vec4(vertex, 1.0);
+	vec4 norm = normal_world * vec4(normal, 1.0);
 
 
     // First, work in local model coordinates (do not apply any transformation)
@@ -0,0 +1,95 @@
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+// PROFILER
+namespace game
+{
+	Profiler::Scope Profiler::scope_[PROFILER_MAX_SCOPES];
+	std::atomic<int> Profiler::num_scopes_(0);
+	std::mutex Profiler::register_mutex_;
+	int Profiler::frame_ = 0;
+
+	int Profiler::Register(const char *name, bool gpu)
+	{
+		std::lock_guard<std::mutex> lock(register_mutex_);
+
+		// Scopes with the same name add up
+		int num_scopes = num_scopes_;
+		for (int i = 0; i < num_scopes; i++)
+		{
+			if (scope_[i].gpu == gpu && strcmp(scope_[i].name, name) == 0) { return i; }
+		}
+		if (num_scopes == PROFILER_MAX_SCOPES) { throw(std::invalid_argument(std::string("Too many profiler scopes, cannot add ") + name)); }
+
+		Scope &scope = scope_[num_scopes];
+		scope.name = name;
+		scope.gpu = gpu;
+		scope.frame_time = 0;
+		scope.num_samples = 0;
+		scope.next_sample = 0;
+		scope.next_query = 0;
+		for (int i = 0; i < PROFILER_QUERIES; i++)
+		{
+			scope.query[i] = 0;
+			scope.pending[i] = false;
+		}
+		num_scopes_ = num_scopes + 1;
+		return num_scopes;
+	}
+
+	void Profiler::AddCpuTime(int slot, long long nanoseconds) { scope_[slot].frame_time += nanoseconds; }
+
+	int Profiler::GetNumScopes(void) { return num_scopes_; }
+	const char *Profiler::GetName(int slot) { return scope_[slot].name; }
+	bool Profiler::IsGpu(int slot) { return scope_[slot].gpu; }
+
+	double Profiler::GetAverage(int slot)
+	{
+		const Scope &scope = scope_[slot];
+		if (scope.num_samples == 0) { return 0.0; }
+		double sum = 0.0;
+		for (int i = 0; i < scope.num_samples; i++) { sum += scope.history[i]; }
+		return sum / scope.num_samples;
+	}
+
+	void Profiler::AddSample(Scope &scope, double milliseconds)
+	{
+		scope.history[scope.next_sample] = milliseconds;
+		scope.next_sample = (scope.next_sample + 1) % PROFILER_AVERAGE_FRAMES;
+		if (scope.num_samples < PROFILER_AVERAGE_FRAMES) { scope.num_samples++; }
+	}
+
+	void Profiler::Report(void)
+	{
+		// Rows are in the order of the bars of the overlay
+		std::cout << "Profiler, ms per frame over the last " << PROFILER_AVERAGE_FRAMES << " frames:" << std::endl;
+		int num_scopes = num_scopes_;
+		for (int i = 0; i < num_scopes; i++)
+		{
+			std::cout << "  " << std::setw(2) << i << " " << (scope_[i].gpu ? "gpu " : "cpu ") << std::left << std::setw(20) << scope_[i].name
+				<< std::right << std::fixed << std::setprecision(3) << std::setw(9) << GetAverage(i) << std::endl;
+		}
+	}
+
+	/* Constructor */
+	ProfileScope::ProfileScope(int slot)
+	{
+		slot_ = slot;
+		start_ = std::chrono::steady_clock::now();
+	}
+
+	/* Destructor */
+	ProfileScope::~ProfileScope()
+	{
+		Profiler::AddCpuTime(slot_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+	}
+} // namespace game
+
+#endif // ENABLE_PROFILER
@@ -0,0 +1,112 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "gl_types.h"
+
+// Scopes the profiler can time, must match the profile array in screen_space_fp.glsl
+#define PROFILER_MAX_SCOPES 32
+// Frames in the rolling average of each scope
+#define PROFILER_AVERAGE_FRAMES 60
+// Timer queries in flight for each GPU scope, results are read once the GPU is done with them
+#define PROFILER_QUERIES 8
+// Frames between two reports of the averages on the console
+#define PROFILER_REPORT_FRAMES 300
+
+// Build with ENABLE_PROFILER to time the scopes below; without it the macros
+// expand to nothing and the profiler costs nothing
+//   PROFILE_SCOPE("name")		CPU time until the end of the enclosing block, from any thread
+//   PROFILE_GPU_SCOPE("name")	GPU time of the OpenGL commands until the end of the block, main thread only, scopes cannot nest
+//   PROFILE_END_FRAME()		Close the frame: update the averages and report them
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#define PROFILER_ENABLED true
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) \
+	static const int PROFILE_CONCAT(profile_slot_, __LINE__) = game::Profiler::Register(name, false); \
+	game::ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(PROFILE_CONCAT(profile_slot_, __LINE__))
+#define PROFILE_GPU_SCOPE(name) \
+	static const int PROFILE_CONCAT(profile_gpu_slot_, __LINE__) = game::Profiler::Register(name, true); \
+	game::GpuProfileScope PROFILE_CONCAT(profile_gpu_scope_, __LINE__)(PROFILE_CONCAT(profile_gpu_slot_, __LINE__))
+#define PROFILE_END_FRAME() game::Profiler::EndFrame()
+
+// PROFILER
+namespace game
+{
+	// Rolling averages of the time spent in named scopes
+	class Profiler
+	{
+	public:
+		static int Register(const char *name, bool gpu);	// Slot of a scope, name must outlive the profiler
+		static void AddCpuTime(int slot, long long nanoseconds);
+
+		static int GetNumScopes(void);
+		static const char *GetName(int slot);
+		static bool IsGpu(int slot);
+		static double GetAverage(int slot);			// Milliseconds per frame
+
+		// Render side, these make OpenGL calls
+		static bool BeginQuery(int slot);			// Start timing a GPU scope, false if timer queries are not supported
+		static void EndFrame(void);					// Read the finished queries, add the frame to the averages and report them regularly
+		static void SetupShader(GLuint program);	// Averages for the overlay of the screen-space program
+
+	private:
+		struct Scope
+		{
+			const char *name;
+			bool gpu;
+			std::atomic<long long> frame_time;		// Nanoseconds in this frame, CPU scopes
+			double history[PROFILER_AVERAGE_FRAMES];	// Last samples in milliseconds
+			int num_samples;
+			int next_sample;
+			GLuint query[PROFILER_QUERIES];			// GPU scopes
+			bool pending[PROFILER_QUERIES];
+			int next_query;
+		};
+
+		static Scope scope_[PROFILER_MAX_SCOPES];
+		static std::atomic<int> num_scopes_;
+		static std::mutex register_mutex_;
+		static int frame_;
+
+		static void AddSample(Scope &scope, double milliseconds);
+		static void Report(void);
+	}; // class Profiler
+
+	// Adds the time until it is destroyed to a CPU scope
+	class ProfileScope
+	{
+	public:
+		ProfileScope(int slot);
+		~ProfileScope();
+
+	private:
+		int slot_;
+		std::chrono::steady_clock::time_point start_;
+	}; // class ProfileScope
+
+	// Times the OpenGL commands until it is destroyed with a GL_TIME_ELAPSED query
+	class GpuProfileScope
+	{
+	public:
+		GpuProfileScope(int slot);
+		~GpuProfileScope();
+
+	private:
+		bool active_;
+	}; // class GpuProfileScope
+} // namespace game
+
+#else
+
+#define PROFILER_ENABLED false
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_END_FRAME()
+
+#endif // ENABLE_PROFILER
+#endif // PROFILER_H_
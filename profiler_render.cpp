@@ -0,0 +1,89 @@
+#include "profiler.h"
+#include "gl_calls.h"
+
+#ifdef ENABLE_PROFILER
+
+// GPU side of the profiler, built into the renderer library
+namespace game
+{
+	bool Profiler::BeginQuery(int slot)
+	{
+		static const bool supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+		if (!supported) { return false; }
+
+		// The oldest query is reused, waiting for it only if the GPU is that far behind
+		Scope &scope = scope_[slot];
+		int i = scope.next_query;
+		if (scope.pending[i])
+		{
+			GLuint64 elapsed;
+			glGetQueryObjectui64v(scope.query[i], GL_QUERY_RESULT, &elapsed);
+			AddSample(scope, elapsed / 1.0e6);
+		}
+		if (!scope.query[i]) { glGenQueries(1, &scope.query[i]); }
+
+		glBeginQuery(GL_TIME_ELAPSED, scope.query[i]);
+		scope.pending[i] = true;
+		scope.next_query = (i + 1) % PROFILER_QUERIES;
+		return true;
+	}
+
+	void Profiler::EndFrame(void)
+	{
+		int num_scopes = num_scopes_;
+		for (int i = 0; i < num_scopes; i++)
+		{
+			Scope &scope = scope_[i];
+			if (!scope.gpu)
+			{
+				AddSample(scope, scope.frame_time.exchange(0) / 1.0e6);
+				continue;
+			}
+
+			// Results of the GPU scopes arrive a few frames late, oldest first
+			for (int j = 0; j < PROFILER_QUERIES; j++)
+			{
+				int k = (scope.next_query + j) % PROFILER_QUERIES;
+				if (!scope.pending[k]) { continue; }
+				GLint available;
+				glGetQueryObjectiv(scope.query[k], GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) { break; }
+				GLuint64 elapsed;
+				glGetQueryObjectui64v(scope.query[k], GL_QUERY_RESULT, &elapsed);
+				AddSample(scope, elapsed / 1.0e6);
+				scope.pending[k] = false;
+			}
+		}
+
+		frame_++;
+		if (frame_ % PROFILER_REPORT_FRAMES == 0) { Report(); }
+	}
+
+	void Profiler::SetupShader(GLuint program)
+	{
+		// One bar per scope: milliseconds, then whether it is a GPU scope
+		GLfloat profile[PROFILER_MAX_SCOPES * 4];
+		int num_scopes = num_scopes_;
+		for (int i = 0; i < num_scopes; i++)
+		{
+			profile[i * 4 + 0] = (GLfloat)GetAverage(i);
+			profile[i * 4 + 1] = scope_[i].gpu ? 1.0f : 0.0f;
+			profile[i * 4 + 2] = 0.0f;
+			profile[i * 4 + 3] = 0.0f;
+		}
+
+		Gl::Uniform1i(glGetUniformLocation(program, "num_profile"), num_scopes);
+		if (num_scopes > 0) { Gl::Uniform4fv(glGetUniformLocation(program, "profile"), num_scopes, profile); }
+	}
+
+	/* Constructor */
+	GpuProfileScope::GpuProfileScope(int slot) { active_ = Profiler::BeginQuery(slot); }
+
+	/* Destructor */
+	GpuProfileScope::~GpuProfileScope()
+	{
+		if (active_) { glEndQuery(GL_TIME_ELAPSED); }
+	}
+} // namespace game
+
+#endif // ENABLE_PROFILER
@@ -1,4 +1,5 @@
 #include <exception>
+#include <stdexcept>
 
 #include "resource.h"
 
@@ -12,6 +13,13 @@ namespace game
 		name_ = name;
 		resource_ = resource;
 		size_ = size;
+		format_ = DefaultVertexFormat();
+		base_vertex_ = 0;
+		first_index_ = 0;
+		num_lods_ = 1;
+		lod_size_[0] = size;
+		bounding_radius_ = 0;
+		quad_particles_ = false;
 	}
 
 	Resource::Resource(ResourceType type, std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size) 
@@ -21,6 +29,13 @@ namespace game
 		array_buffer_ = array_buffer;
 		element_array_buffer_ = element_array_buffer;
 		size_ = size;
+		format_ = DefaultVertexFormat();
+		base_vertex_ = 0;
+		first_index_ = 0;
+		num_lods_ = 1;
+		lod_size_[0] = size;
+		bounding_radius_ = 0;
+		quad_particles_ = false;
 	}
 
 	Resource::Resource(ResourceType type, std::string name, GLfloat *data, GLsizei size) 
@@ -29,6 +44,13 @@ namespace game
 		name_ = name;
 		data_ = data;
 		size_ = size;
+		format_ = DefaultVertexFormat();
+		base_vertex_ = 0;
+		first_index_ = 0;
+		num_lods_ = 1;
+		lod_size_[0] = size;
+		bounding_radius_ = 0;
+		quad_particles_ = false;
 	}
 
 	/* Destructor */
@@ -42,4 +64,38 @@ namespace game
 	GLuint Resource::GetElementArrayBuffer(void) const	{ return element_array_buffer_; }
 	GLsizei Resource::GetSize(void) const				{ return size_; }
 	GLfloat *Resource::GetData(void) const				{ return data_; }
+	const VertexFormat &Resource::GetVertexFormat(void) const { return format_; }
+	GLint Resource::GetBaseVertex(void) const			{ return base_vertex_; }
+	GLsizei Resource::GetFirstIndex(void) const			{ return first_index_; }
+	int Resource::GetNumLods(void) const				{ return num_lods_; }
+	GLsizei Resource::GetLodSize(int lod) const			{ return lod_size_[lod]; }
+	float Resource::GetBoundingRadius(void) const		{ return bounding_radius_; }
+
+	GLsizei Resource::GetLodFirstIndex(int lod) const
+	{
+		GLsizei first = first_index_;
+		for (int i = 0; i < lod; i++) { first += lod_size_[i]; }
+		return first;
+	}
+
+	/* Setters */
+	void Resource::SetVertexFormat(const VertexFormat &format) { format_ = format; }
+	void Resource::SetDrawRange(GLint base_vertex, GLsizei first_index)
+	{
+		base_vertex_ = base_vertex;
+		first_index_ = first_index;
+	}
+
+	void Resource::SetLods(const GLsizei *lod_size, int num_lods)
+	{
+		if (num_lods > MAX_LOD_LEVELS) { throw(std::invalid_argument(std::string("Too many levels of detail in ") + name_)); }
+
+		num_lods_ = num_lods;
+		for (int i = 0; i < num_lods; i++) { lod_size_[i] = lod_size[i]; }
+		size_ = lod_size_[0];
+	}
+
+	void Resource::SetBoundingRadius(float radius) { bounding_radius_ = radius; }
+	bool Resource::GetQuadParticles(void) const { return quad_particles_; }
+	void Resource::SetQuadParticles(bool quad_particles) { quad_particles_ = quad_particles; }
 } // namespace game
@@ -2,9 +2,12 @@
 #define RESOURCE_H_
 
 #include <string>
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "gl_types.h"
+
+#include "vertex_format.h"
+
+// Maximum number of levels of detail of a mesh, including full detail
+#define MAX_LOD_LEVELS 4
 
 namespace game 
 {
@@ -18,6 +21,13 @@ namespace game
             ResourceType type_;		// Type of resource
             std::string name_;		// Reference name
 			GLsizei size_;			// Number of primitives in geometry
+			VertexFormat format_;	// Layout of the vertices in the array buffer
+			GLint base_vertex_;		// First vertex of the geometry in a shared array buffer
+			GLsizei first_index_;	// First index of the geometry in a shared element array buffer
+			int num_lods_;			// Number of levels of detail, stored one after the other from first_index_
+			GLsizei lod_size_[MAX_LOD_LEVELS];	// Number of indices in each level
+			float bounding_radius_;	// Distance of the farthest vertex from the origin of the geometry
+			bool quad_particles_;	// Material drawing points as instanced quads
             union {
                 struct {
                     GLuint resource_; // OpenGL handle for resource
@@ -44,6 +54,19 @@ namespace game
             GLuint GetElementArrayBuffer(void) const;	//get element array buffer
             GLsizei GetSize(void) const;				//get size 
 			GLfloat *GetData(void) const;
+			const VertexFormat &GetVertexFormat(void) const;	//get layout of the vertices
+			void SetVertexFormat(const VertexFormat &format);	//set layout of the vertices
+			GLint GetBaseVertex(void) const;					//get first vertex in the array buffer
+			GLsizei GetFirstIndex(void) const;					//get first index in the element array buffer
+			void SetDrawRange(GLint base_vertex, GLsizei first_index);	//set where the geometry starts in shared buffers
+			int GetNumLods(void) const;							//get number of levels of detail
+			GLsizei GetLodSize(int lod) const;					//get number of indices of a level of detail
+			GLsizei GetLodFirstIndex(int lod) const;			//get first index of a level of detail
+			void SetLods(const GLsizei *lod_size, int num_lods);	//set the levels of detail that follow the full detail indices
+			float GetBoundingRadius(void) const;				//get radius of the sphere around the origin holding the geometry
+			void SetBoundingRadius(float radius);				//set radius of the sphere around the origin holding the geometry
+			bool GetQuadParticles(void) const;					//get whether a material draws points as instanced quads
+			void SetQuadParticles(bool quad_particles);			//set whether a material draws points as instanced quads
     }; // class Resource
 } // namespace game
 
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+#include "resource_loader.h"
+#include "profiler.h"
+#include "trace.h"
+
+// RESOURCE LOADER
+namespace game
+{
+	/* Constructor */
+	ResourceLoader::ResourceLoader(ResourceManager *resman, unsigned int num_threads) : resman_(resman), pending_(0), stop_(false)
+	{
+		// Leave one core for the main thread
+		if (num_threads == 0)
+		{
+			num_threads = std::thread::hardware_concurrency();
+			num_threads = (num_threads > 1) ? num_threads - 1 : 1;
+		}
+
+		for (unsigned int i = 0; i < num_threads; i++) { workers_.push_back(std::thread(&ResourceLoader::WorkerLoop, this)); }
+	}
+
+	/* Destructor */
+	ResourceLoader::~ResourceLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(jobs_mutex_);
+			stop_ = true;
+		}
+		jobs_cond_.notify_all();
+		for (int i = 0; i < workers_.size(); i++) { workers_[i].join(); }
+	}
+
+	void ResourceLoader::LoadResource(ResourceType type, const std::string name, const char *filename, int num_particles)
+	{
+		ResourceManager *resman = resman_;
+		std::string file(filename);
+
+		// Each job keeps its loaded data alive until the upload ran
+		if (type == Material)
+		{
+			AddJob([resman, name, file]() -> Upload {
+				std::shared_ptr<MaterialSource> source(new MaterialSource());
+				ResourceManager::LoadMaterialSource(file.c_str(), *source);
+				return [resman, name, source]() { resman->QueueMaterial(name, *source); };
+			});
+		}
+		else if (type == Texture)
+		{
+			AddJob([resman, name, file]() -> Upload {
+				std::shared_ptr<ImageData> image(new ImageData());
+				ResourceManager::DecodeImage(file.c_str(), *image);
+				return [resman, name, image]() {
+					try { resman->CreateTexture(name, *image); }
+					catch (std::exception &e)
+					{
+						ResourceManager::FreeImage(*image);
+						throw;
+					}
+					ResourceManager::FreeImage(*image);
+				};
+			});
+		}
+		else if (type == Mesh)
+		{
+			std::string cache_directory = resman->GetMeshCacheDirectory();
+			AddJob([resman, name, file, cache_directory]() -> Upload {
+				std::shared_ptr<GeometryData> geometry(new GeometryData());
+				ResourceManager::LoadMeshGeometry(name, std::vector<std::string>(1, file), cache_directory, *geometry);
+				return [resman, name, geometry]() { resman->AddGeometry(Mesh, name, *geometry); };
+			});
+		}
+		else if (type == PointSet)
+		{
+			std::string cache_directory = resman->GetMeshCacheDirectory();
+			ResourceLoader *loader = this;
+			AddJob([loader, resman, name, file, num_particles, cache_directory]() -> Upload {
+				std::shared_ptr<GeometryData> geometry(new GeometryData());
+				unsigned long long key = ResourceManager::MeshParticlesKey(file, num_particles);
+				if (ResourceManager::LoadParticleCache(name, cache_directory, key, *geometry))
+				{
+					return [resman, name, geometry]() { resman->AddGeometry(PointSet, name, *geometry); };
+				}
+
+				std::shared_ptr<TriMesh> mesh(new TriMesh());
+				LoadObj(file.c_str(), *mesh);
+				std::shared_ptr<std::vector<double> > cumulative_area(new std::vector<double>());
+				BuildSurfaceAreaTable(*mesh, *cumulative_area);
+				geometry->vertex.assign(num_particles * VERTEX_FLOATS, 0.0f);
+
+				// Sample in chunks on all workers; the last chunk to finish saves the points and uploads them
+				int num_chunks = (num_particles + PARTICLE_SAMPLE_CHUNK - 1) / PARTICLE_SAMPLE_CHUNK;
+				std::shared_ptr<std::atomic<int> > remaining(new std::atomic<int>(num_chunks));
+				std::function<Upload(int)> sample = [resman, name, num_particles, cache_directory, key, geometry, mesh, cumulative_area, remaining](int chunk) -> Upload {
+					int first = chunk * PARTICLE_SAMPLE_CHUNK;
+					SampleMeshParticles(*mesh, *cumulative_area, num_particles, first, std::min(PARTICLE_SAMPLE_CHUNK, num_particles - first), *geometry);
+					if (--(*remaining) > 0) { return []() {}; }
+
+					ResourceManager::SaveParticleCache(name, cache_directory, key, *geometry);
+					return [resman, name, geometry]() { resman->AddGeometry(PointSet, name, *geometry); };
+				};
+				for (int chunk = 1; chunk < num_chunks; chunk++)
+				{
+					loader->AddJob([sample, chunk]() -> Upload { return sample(chunk); });
+				}
+				return sample(0);
+			});
+		}
+		else { throw(std::invalid_argument(std::string("Invalid type of resource"))); }
+	}
+
+	void ResourceLoader::LoadParticleMaterial(const std::string name, const char *filename, bool quads)
+	{
+		ResourceManager *resman = resman_;
+		std::string file(filename);
+		AddJob([resman, name, file, quads]() -> Upload {
+			std::shared_ptr<MaterialSource> source(new MaterialSource());
+			if (quads) { ResourceManager::LoadQuadMaterialSource(file.c_str(), *source); }
+			else	   { ResourceManager::LoadMaterialSource(file.c_str(), *source); }
+			return [resman, name, source]() { resman->QueueMaterial(name, *source); };
+		});
+	}
+
+	void ResourceLoader::LoadFeedbackMaterial(const std::string name, const char *filename, const std::vector<std::string> &varyings)
+	{
+		ResourceManager *resman = resman_;
+		std::string file(filename);
+		AddJob([resman, name, file, varyings]() -> Upload {
+			std::shared_ptr<MaterialSource> source(new MaterialSource());
+			ResourceManager::LoadMaterialSource(file.c_str(), *source);
+			source->feedback_varyings = varyings;
+			return [resman, name, source]() { resman->QueueMaterial(name, *source); };
+		});
+	}
+
+	void ResourceLoader::LoadMergedMesh(const std::string name, const std::vector<std::string> &filenames)
+	{
+		ResourceManager *resman = resman_;
+		std::string cache_directory = resman->GetMeshCacheDirectory();
+		AddJob([resman, name, filenames, cache_directory]() -> Upload {
+			std::shared_ptr<GeometryData> geometry(new GeometryData());
+			ResourceManager::LoadMeshGeometry(name, filenames, cache_directory, *geometry);
+			return [resman, name, geometry]() { resman->AddGeometry(Mesh, name, *geometry); };
+		});
+	}
+
+	void ResourceLoader::AddJob(Job job)
+	{
+		pending_++;
+		{
+			std::lock_guard<std::mutex> lock(jobs_mutex_);
+			jobs_.push_back(job);
+		}
+		jobs_cond_.notify_one();
+	}
+
+	void ResourceLoader::AddUpload(Upload upload)
+	{
+		pending_++;
+		{
+			std::lock_guard<std::mutex> lock(uploads_mutex_);
+			uploads_.push_back(upload);
+		}
+		uploads_cond_.notify_one();
+	}
+
+	void ResourceLoader::WorkerLoop(void)
+	{
+		Trace::SetThreadName("loader");
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(jobs_mutex_);
+				jobs_cond_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+				if (stop_) { return; }
+				job = jobs_.front();
+				jobs_.pop_front();
+			}
+
+			// Errors are thrown again on the main thread, when the upload runs
+			Upload upload;
+			try
+			{
+				PROFILE_SCOPE("load_job");
+				TRACE_SCOPE("load_job");
+				upload = job();
+			}
+			catch (...)
+			{
+				std::exception_ptr error = std::current_exception();
+				upload = [error]() { std::rethrow_exception(error); };
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(uploads_mutex_);
+				uploads_.push_back(upload);
+			}
+			uploads_cond_.notify_one();
+		}
+	}
+
+	bool ResourceLoader::RunUpload(void)
+	{
+		Upload upload;
+		{
+			std::lock_guard<std::mutex> lock(uploads_mutex_);
+			if (uploads_.empty()) { return false; }
+			upload = uploads_.front();
+			uploads_.pop_front();
+		}
+
+		pending_--;
+		upload();
+		return true;
+	}
+
+	void ResourceLoader::ProcessUploads(double time_budget)
+	{
+		PROFILE_SCOPE("load_upload");
+		TRACE_SCOPE("load_upload");
+
+		// Always run at least one upload so loading makes progress on slow frames
+		double start = glfwGetTime();
+		while (RunUpload())
+		{
+			if (glfwGetTime() - start >= time_budget) { break; }
+		}
+	}
+
+	void ResourceLoader::Finish(void)
+	{
+		while (!IsDone())
+		{
+			if (RunUpload()) { continue; }
+
+			std::unique_lock<std::mutex> lock(uploads_mutex_);
+			uploads_cond_.wait(lock, [this]() { return !uploads_.empty(); });
+		}
+	}
+
+	bool ResourceLoader::IsDone(void) const { return pending_ == 0; }
+	int ResourceLoader::GetNumPending(void) const { return pending_; }
+} // namespace game
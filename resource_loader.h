@@ -0,0 +1,58 @@
+#ifndef RESOURCE_LOADER_H_
+#define RESOURCE_LOADER_H_
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <atomic>
+
+#include "resource_manager.h"
+
+// RESOURCE LOADER
+namespace game
+{
+	// Loads resources in two stages. Worker threads read, parse and decode the files,
+	// then the OpenGL objects are created on the main thread by ProcessUploads, so the
+	// game can keep rendering while loading
+	class ResourceLoader
+	{
+	public:
+		typedef std::function<void(void)> Upload;		// Work that needs the OpenGL context
+		typedef std::function<Upload(void)> Job;		// Work for a worker thread, returns its upload
+
+		ResourceLoader(ResourceManager *resman, unsigned int num_threads = 0);	// 0 picks a thread count from the hardware
+		~ResourceLoader();
+
+		void LoadResource(ResourceType type, const std::string name, const char *filename, int num_particles = 20000);	// Queue a file to load in the background
+		void LoadParticleMaterial(const std::string name, const char *filename, bool quads);	// Queue a particle program, drawn as instanced quads or expanded by its geometry program
+		void LoadFeedbackMaterial(const std::string name, const char *filename, const std::vector<std::string> &varyings);	// Queue a shader program whose outputs are captured with transform feedback
+		void LoadMergedMesh(const std::string name, const std::vector<std::string> &filenames);	// Queue obj files to load as one mesh, see MergeGeometry
+		void AddJob(Job job);						// Queue custom work for a worker thread
+		void AddUpload(Upload upload);				// Queue work that only runs on the main thread
+		void ProcessUploads(double time_budget);	// Run finished uploads on the main thread, for about time_budget seconds
+		void Finish(void);							// Block until everything queued was loaded
+		bool IsDone(void) const;					// Whether everything queued was loaded
+		int GetNumPending(void) const;				// Number of queued resources that are not loaded yet
+
+	private:
+		ResourceManager *resman_;					// Where loaded resources are added
+		std::vector<std::thread> workers_;			// Worker threads
+		std::deque<Job> jobs_;						// Jobs waiting for a worker
+		std::deque<Upload> uploads_;				// Uploads waiting for the main thread
+		std::mutex jobs_mutex_;						// Protects jobs_ and stop_
+		std::mutex uploads_mutex_;					// Protects uploads_
+		std::condition_variable jobs_cond_;			// Signals new jobs to the workers
+		std::condition_variable uploads_cond_;		// Signals new uploads to Finish
+		std::atomic<int> pending_;					// Jobs and uploads that did not run yet
+		bool stop_;									// Tells the workers to exit
+
+		void WorkerLoop(void);						// Run jobs until stopped
+		bool RunUpload(void);						// Run one upload, if there is one
+	}; // class ResourceLoader
+} // namespace game
+#endif // RESOURCE_LOADER_H_
@@ -4,16 +4,24 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <random>
+#include <cstring>
 #include <SOIL/SOIL.h>
 
 #include "resource_manager.h"
-#include "model_loader.h"
+#include "trace.h"
+#include "counters.h"
+#include "mesh_loader.h"
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+#include "gl_calls.h"
 
 // RESOURCE MANAGER
 namespace game
 {
 	/* Constructor */
-	ResourceManager::ResourceManager(void) {}
+	ResourceManager::ResourceManager(void) : parallel_compile_(false) {}
 
 	/* Destructor */
 	ResourceManager::~ResourceManager() {}
@@ -24,6 +32,7 @@ namespace game
 		Resource *res;
 		res = new Resource(type, name, resource, size);
 		resource_.push_back(res);
+		Counters::Add(CounterResourcesCreated);
 	}
 
 	void ResourceManager::AddResource(ResourceType type, const std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size)
@@ -31,6 +40,17 @@ namespace game
 		Resource *res;
 		res = new Resource(type, name, array_buffer, element_array_buffer, size);
 		resource_.push_back(res);
+		Counters::Add(CounterResourcesCreated);
+	}
+
+	void ResourceManager::AddResource(ResourceType type, const std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size, const VertexFormat &format, float bounding_radius)
+	{
+		Resource *res;
+		res = new Resource(type, name, array_buffer, element_array_buffer, size);
+		res->SetVertexFormat(format);
+		res->SetBoundingRadius(bounding_radius);
+		resource_.push_back(res);
+		Counters::Add(CounterResourcesCreated);
 	}
 
 	void ResourceManager::AddResource(ResourceType type, const std::string name, GLfloat *data, GLsizei size) 
@@ -38,6 +58,7 @@ namespace game
 		Resource *res;
 		res = new Resource(type, name, data, size);
 		resource_.push_back(res);
+		Counters::Add(CounterResourcesCreated);
 	}
 
 	void ResourceManager::LoadResource(ResourceType type, const std::string name, const char *filename, int num_particles) 
@@ -61,98 +82,352 @@ namespace game
 	}
 
 	void ResourceManager::LoadMaterial(const std::string name, const char *prefix) 
+	{
+		MaterialSource source;
+		LoadMaterialSource(prefix, source);
+		QueueMaterial(name, source);
+		FinishMaterials();
+	}
+
+	void ResourceManager::LoadMaterialSource(const char *prefix, MaterialSource &source)
 	{
 		// Load vertex program source code
 		std::string filename = std::string(prefix) + std::string(VERTEX_PROGRAM_EXTENSION);
-		std::string vp = LoadTextFile(filename.c_str());
+		source.vp = LoadTextFile(filename.c_str());
 
 		// Load fragment program source code
 		filename = std::string(prefix) + std::string(FRAGMENT_PROGRAM_EXTENSION);
-		std::string fp = LoadTextFile(filename.c_str());
+		source.fp = LoadTextFile(filename.c_str());
+
+		// Try to also load a geometry shader
+		filename = std::string(prefix) + std::string(GEOMETRY_PROGRAM_EXTENSION);
+		source.geometry_program = false;
+		source.gp = "";
+		try {
+			source.gp = LoadTextFile(filename.c_str());
+			source.geometry_program = true;
+		}
+		catch (std::exception &e) {
+		}
+		source.quad_particles = false;
+	}
 
-		// Create a shader from the vertex program source code
-		GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-		const char *source_vp = vp.c_str();
-		glShaderSource(vs, 1, &source_vp, NULL);
-		glCompileShader(vs);
+	void ResourceManager::LoadQuadMaterialSource(const char *prefix, MaterialSource &source)
+	{
+		// The quad vertex program does the work of the geometry program, the fragment program is shared
+		std::string filename = std::string(prefix) + std::string(QUAD_VERTEX_PROGRAM_EXTENSION);
+		source.vp = LoadTextFile(filename.c_str());
+		filename = std::string(prefix) + std::string(FRAGMENT_PROGRAM_EXTENSION);
+		source.fp = LoadTextFile(filename.c_str());
+		source.gp = "";
+		source.geometry_program = false;
+		source.quad_particles = true;
+	}
 
-		// Check if shader compiled successfully
-		GLint status;
-		glGetShaderiv(vs, GL_COMPILE_STATUS, &status);
-		if (status != GL_TRUE) {
-			char buffer[512];
-			glGetShaderInfoLog(vs, 512, NULL, buffer);
-			throw(std::ios_base::failure(std::string("Error compiling vertex shader: ") + std::string(buffer)));
+	void ResourceManager::QueueMaterial(const std::string name, const MaterialSource &source)
+	{
+		// Let the driver compile on its own threads when it can
+		if (!parallel_compile_ && (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)) {
+			if (GLEW_KHR_parallel_shader_compile) { glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); }
+			else								  { glMaxShaderCompilerThreadsARB(0xFFFFFFFF); }
+			parallel_compile_ = true;
 		}
 
-		// Create a shader from the fragment program source code
-		GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-		const char *source_fp = fp.c_str();
-		glShaderSource(fs, 1, &source_fp, NULL);
-		glCompileShader(fs);
+		PendingMaterial pending;
+		pending.name = name;
+		pending.source = source;
+		pending.vs = pending.fs = pending.gs = 0;
+		pending.cache_key = 0;
+		pending.from_cache = false;
 
-		// Check if shader compiled successfully
-		glGetShaderiv(fs, GL_COMPILE_STATUS, &status);
-		if (status != GL_TRUE) {
-			char buffer[512];
-			glGetShaderInfoLog(fs, 512, NULL, buffer);
-			throw(std::ios_base::failure(std::string("Error compiling fragment shader: ") + std::string(buffer)));
+		// Try the program binary cache first, so that warm starts skip compiling
+		pending.use_cache = ProgramCacheSupported();
+		if (pending.use_cache) {
+			pending.cache_key = ProgramCacheKey(source);
+			pending.from_cache = LoadProgramBinary(name, pending.cache_key, pending.program);
+		}
+		if (!pending.from_cache) {
+			SubmitProgram(pending);
 		}
 
-		// Try to also load a geometry shader
-		filename = std::string(prefix) + std::string(GEOMETRY_PROGRAM_EXTENSION);
-		bool geometry_program = false;
-		std::string gp = "";
-		GLuint gs;
-		try {
-			gp = LoadTextFile(filename.c_str());
-			geometry_program = true;
+		pending_materials_.push_back(pending);
+	}
+
+	void ResourceManager::SubmitProgram(PendingMaterial &pending)
+	{
+		TRACE_SCOPE("shader_compile");
+
+		// Compile and link without waiting for the status, FinishMaterials checks it
+		pending.vs = CompileShader(GL_VERTEX_SHADER, pending.source.vp);
+		pending.fs = CompileShader(GL_FRAGMENT_SHADER, pending.source.fp);
+		if (pending.source.geometry_program) {
+			pending.gs = CompileShader(GL_GEOMETRY_SHADER, pending.source.gp);
 		}
-		catch (std::exception &e) {
+
+		// Create a shader program linking all shaders together
+		pending.program = glCreateProgram();
+		glAttachShader(pending.program, pending.vs);
+		glAttachShader(pending.program, pending.fs);
+		if (pending.gs) {
+			glAttachShader(pending.program, pending.gs);
+		}
+		if (pending.use_cache) {
+			glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		// Transform feedback outputs have to be known before linking
+		if (!pending.source.feedback_varyings.empty()) {
+			std::vector<const char *> varyings;
+			for (int i = 0; i < pending.source.feedback_varyings.size(); i++) {
+				varyings.push_back(pending.source.feedback_varyings[i].c_str());
+			}
+			glTransformFeedbackVaryings(pending.program, varyings.size(), &varyings[0], GL_INTERLEAVED_ATTRIBS);
+		}
+
+		// The corners of the quad go first, so attribute 0 is never an instanced array
+		if (pending.source.quad_particles) {
+			glBindAttribLocation(pending.program, 0, "corner");
+		}
+		glLinkProgram(pending.program);
+	}
+
+	GLuint ResourceManager::CompileShader(GLenum type, const std::string &source)
+	{
+		GLuint shader = glCreateShader(type);
+		const char *source_str = source.c_str();
+		glShaderSource(shader, 1, &source_str, NULL);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	bool ResourceManager::MaterialsReady(void) const
+	{
+		// Without parallel compilation, querying the status is what does the work
+		if (!parallel_compile_) {
+			return true;
+		}
+
+		for (int i = 0; i < pending_materials_.size(); i++) {
+			GLint done;
+			glGetProgramiv(pending_materials_[i].program, GL_COMPLETION_STATUS_KHR, &done);
+			if (!done) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void ResourceManager::FinishMaterials(void)
+	{
+		TRACE_SCOPE("shader_link");
+
+		// Collect the status of every queued program, reporting all errors at once
+		std::string errors;
+		for (int i = 0; i < pending_materials_.size(); i++) {
+			PendingMaterial &pending = pending_materials_[i];
+
+			GLint status;
+			glGetProgramiv(pending.program, GL_LINK_STATUS, &status);
+
+			// A cached binary the driver rejected is built from source instead
+			if (status != GL_TRUE && pending.from_cache) {
+				glDeleteProgram(pending.program);
+				pending.from_cache = false;
+				SubmitProgram(pending);
+				glGetProgramiv(pending.program, GL_LINK_STATUS, &status);
+			}
+
+			if (status != GL_TRUE) {
+				errors += std::string("Error building material ") + pending.name + std::string(": ") + GetBuildLog(pending);
+				glDeleteProgram(pending.program);
+			}
+			else if (pending.use_cache && !pending.from_cache) {
+				// Store the linked program for the next start
+				SaveProgramBinary(pending.name, pending.cache_key, pending.program);
+			}
+
+			// Delete memory used by shaders, since they were already compiled
+			// and linked
+			if (pending.vs) { glDeleteShader(pending.vs); }
+			if (pending.fs) { glDeleteShader(pending.fs); }
+			if (pending.gs) { glDeleteShader(pending.gs); }
+
+			// Add a resource for the shader program
+			if (status == GL_TRUE) {
+				AddResource(Material, pending.name, pending.program, 0);
+				GetResource(pending.name)->SetQuadParticles(pending.source.quad_particles);
+			}
 		}
+		pending_materials_.clear();
 
-		if (geometry_program) {
-			// Create a shader from the geometry program source code
-			gs = glCreateShader(GL_GEOMETRY_SHADER);
-			const char *source_gp = gp.c_str();
-			glShaderSource(gs, 1, &source_gp, NULL);
-			glCompileShader(gs);
+		if (!errors.empty()) {
+			throw(std::ios_base::failure(errors));
+		}
+	}
 
-			// Check if shader compiled successfully
+	std::string ResourceManager::GetBuildLog(const PendingMaterial &pending)
+	{
+		// Report the shaders that failed to compile, or the link log if they all compiled
+		GLuint shader[3] = { pending.vs, pending.fs, pending.gs };
+		const char *stage[3] = { "vertex", "fragment", "geometry" };
+		std::string log;
+		for (int i = 0; i < 3; i++) {
+			if (!shader[i]) {
+				continue;
+			}
 			GLint status;
-			glGetShaderiv(gs, GL_COMPILE_STATUS, &status);
+			glGetShaderiv(shader[i], GL_COMPILE_STATUS, &status);
 			if (status != GL_TRUE) {
-				char buffer[512];
-				glGetShaderInfoLog(gs, 512, NULL, buffer);
-				throw(std::ios_base::failure(std::string("Error compiling geometry shader: ") + std::string(buffer)));
+				log += std::string("Error compiling ") + std::string(stage[i]) + std::string(" shader: ") + GetShaderLog(shader[i]);
 			}
 		}
+		if (log.empty()) {
+			log = std::string("Error linking shaders: ") + GetProgramLog(pending.program);
+		}
+		return log;
+	}
+
+	std::string ResourceManager::GetShaderLog(GLuint shader)
+	{
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		if (length <= 0) {
+			return std::string("\n");
+		}
+		std::vector<char> buffer(length);
+		glGetShaderInfoLog(shader, length, NULL, &buffer[0]);
+		return std::string(&buffer[0]);
+	}
+
+	std::string ResourceManager::GetProgramLog(GLuint program)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		if (length <= 0) {
+			return std::string("\n");
+		}
+		std::vector<char> buffer(length);
+		glGetProgramInfoLog(program, length, NULL, &buffer[0]);
+		return std::string(&buffer[0]);
+	}
+
+	void ResourceManager::SetShaderCacheDirectory(const std::string directory)
+	{
+		shader_cache_directory_ = directory;
+	}
+
+	void ResourceManager::SetMeshCacheDirectory(const std::string directory)
+	{
+		mesh_cache_directory_ = directory;
+	}
+
+	const std::string &ResourceManager::GetMeshCacheDirectory(void) const
+	{
+		return mesh_cache_directory_;
+	}
+
+	bool ResourceManager::ProgramCacheSupported(void) const
+	{
+		if (shader_cache_directory_.empty() || !GLEW_ARB_get_program_binary) {
+			return false;
+		}
+
+		// Some drivers expose the extension without any binary format
+		GLint num_formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+		return num_formats > 0;
+	}
+
+	unsigned long long ResourceManager::HashString(const std::string &str, unsigned long long hash)
+	{
+		// 64-bit FNV-1a, including a terminating zero so that "ab"+"c" and "a"+"bc" differ
+		const unsigned long long prime = 1099511628211ULL;
+		for (unsigned int i = 0; i < str.size(); i++) {
+			hash ^= (unsigned char)str[i];
+			hash *= prime;
+		}
+		hash *= prime;
+		return hash;
+	}
+
+	unsigned long long ResourceManager::ProgramCacheKey(const MaterialSource &source)
+	{
+		// Binaries are only valid for the driver that created them
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		const char *version = (const char *)glGetString(GL_VERSION);
+
+		unsigned long long hash = 14695981039346656037ULL;
+		hash = HashString(source.vp, hash);
+		hash = HashString(source.fp, hash);
+		hash = HashString(source.gp, hash);
+		for (int i = 0; i < source.feedback_varyings.size(); i++) {
+			hash = HashString(source.feedback_varyings[i], hash);
+		}
+		hash = HashString(renderer ? std::string(renderer) : std::string(""), hash);
+		hash = HashString(version ? std::string(version) : std::string(""), hash);
+		return hash;
+	}
+
+	bool ResourceManager::LoadProgramBinary(const std::string name, unsigned long long key, GLuint &program)
+	{
+		// Open file, a missing file just means the cache is cold
+		std::string filename = shader_cache_directory_ + std::string("/") + name + std::string(PROGRAM_BINARY_EXTENSION);
+		std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary);
+		if (f.fail()) {
+			return false;
+		}
 
-		// Create a shader program linking both vertex and fragment shaders
-		// together
-		GLuint sp = glCreateProgram();
-		glAttachShader(sp, vs);
-		glAttachShader(sp, fs);
-		if (geometry_program) {
-			glAttachShader(sp, gs);
+		// Header: magic number, key of the sources and driver, binary format and length
+		char magic[4];
+		unsigned long long file_key;
+		GLenum format;
+		GLint length;
+		f.read(magic, 4);
+		f.read((char *)&file_key, sizeof(file_key));
+		f.read((char *)&format, sizeof(format));
+		f.read((char *)&length, sizeof(length));
+		if (f.fail() || std::string(magic, 4) != std::string(PROGRAM_BINARY_MAGIC, 4) || file_key != key || length <= 0) {
+			return false;
 		}
-		glLinkProgram(sp);
 
-		// Check if shaders were linked successfully
-		glGetProgramiv(sp, GL_LINK_STATUS, &status);
-		if (status != GL_TRUE) {
-			char buffer[512];
-			glGetShaderInfoLog(sp, 512, NULL, buffer);
-			throw(std::ios_base::failure(std::string("Error linking shaders: ") + std::string(buffer)));
+		std::vector<char> binary(length);
+		f.read(&binary[0], length);
+		if (f.fail()) {
+			return false;
 		}
+		f.close();
 
-		// Delete memory used by shaders, since they were already compiled
-		// and linked
-		glDeleteShader(vs);
-		glDeleteShader(fs);
+		// The driver can still reject the binary, for example after an update;
+		// FinishMaterials checks the status and falls back to the sources
+		program = glCreateProgram();
+		glProgramBinary(program, format, &binary[0], length);
+		return true;
+	}
 
-		// Add a resource for the shader program
-		AddResource(Material, name, sp, 0);
+	void ResourceManager::SaveProgramBinary(const std::string name, unsigned long long key, GLuint program)
+	{
+		// Get binary from the driver
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		std::vector<char> binary(length);
+		GLenum format;
+		glGetProgramBinary(program, length, &length, &format, &binary[0]);
+
+		// Write file, the cache is only an optimization so errors are ignored
+		std::string filename = shader_cache_directory_ + std::string("/") + name + std::string(PROGRAM_BINARY_EXTENSION);
+		std::ofstream f(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (f.fail()) {
+			return;
+		}
+		f.write(PROGRAM_BINARY_MAGIC, 4);
+		f.write((const char *)&key, sizeof(key));
+		f.write((const char *)&format, sizeof(format));
+		f.write((const char *)&length, sizeof(length));
+		f.write(&binary[0], length);
+		f.close();
 	}
 
 	std::string ResourceManager::LoadTextFile(const char *filename) {
@@ -380,125 +655,21 @@ namespace game
 			}
 		}
 
-		GLuint vbo, ebo;
-		// Create buffer for vertices
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
-
-		// Create buffer for faces
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
+		// Copy vertices and faces to the shared mesh buffers
+		AddMesh(object_name, vertex, vertex_num, face, face_num * face_att);
 
 		// Free data buffers
 		delete[] vertex;
 		delete[] face;
-
-		// Create resource
-		AddResource(Mesh, object_name, vbo, ebo, face_num * face_att);
 	}
 
 	void ResourceManager::CreateTorus(std::string object_name, float loop_radius, float circle_radius, int num_loop_samples, int num_circle_samples)
 	{
-		// Create a torus
-		// The torus is built from a large loop with small circles around the loop
-
-		// Number of vertices and faces to be created
-		// Check the construction algorithm below to understand the numbers
-		// specified below
-		const GLuint vertex_num = num_loop_samples*num_circle_samples;
-		const GLuint face_num = num_loop_samples*num_circle_samples * 2;
-
-		// Number of attributes for vertices and faces
-		const int vertex_att = 11;
-		const int face_att = 3;
-
-		// Data buffers for the torus
-		GLfloat *vertex = NULL;
-		GLuint *face = NULL;
-
-		// Allocate memory for buffers
-		try {
-			vertex = new GLfloat[vertex_num * vertex_att]; // 11 attributes per vertex: 3D position (3), 3D normal (3), RGB color (3), 2D texture coordinates (2)
-			face = new GLuint[face_num * face_att]; // 3 indices per face
-		}
-		catch (std::exception &e) {
-			throw e;
-		}
-
-		// Create vertices 
-		float theta, phi; // Angles for circles
-		glm::vec3 loop_center;
-		glm::vec3 vertex_position;
-		glm::vec3 vertex_normal;
-		glm::vec3 vertex_color;
-		glm::vec2 vertex_coord;
-
-		for (int i = 0; i < num_loop_samples; i++) { // large loop
-
-			theta = 2.0*glm::pi<GLfloat>()*i / num_loop_samples; // loop sample (angle theta)
-			loop_center = glm::vec3(loop_radius*cos(theta), loop_radius*sin(theta), 0); // centre of a small circle
-
-			for (int j = 0; j < num_circle_samples; j++) { // small circle
-
-				phi = 2.0*glm::pi<GLfloat>()*j / num_circle_samples; // circle sample (angle phi)
-
-																	 // Define position, normal and color of vertex
-				vertex_normal = glm::vec3(cos(theta)*cos(phi), sin(theta)*cos(phi), sin(phi));
-				vertex_position = loop_center + vertex_normal*circle_radius;
-				vertex_color = glm::vec3(1.0 - ((float)i / (float)num_loop_samples),
-					(float)i / (float)num_loop_samples,
-					(float)j / (float)num_circle_samples);
-				vertex_coord = glm::vec2(theta / 2.0*glm::pi<GLfloat>(),
-					phi / 2.0*glm::pi<GLfloat>());
-
-				// Add vectors to the data buffer
-				for (int k = 0; k < 3; k++) {
-					vertex[(i*num_circle_samples + j)*vertex_att + k] = vertex_position[k];
-					vertex[(i*num_circle_samples + j)*vertex_att + k + 3] = vertex_normal[k];
-					vertex[(i*num_circle_samples + j)*vertex_att + k + 6] = vertex_color[k];
-				}
-				vertex[(i*num_circle_samples + j)*vertex_att + 9] = vertex_coord[0];
-				vertex[(i*num_circle_samples + j)*vertex_att + 10] = vertex_coord[1];
-			}
-		}
-
-		// Create triangles
-		for (int i = 0; i < num_loop_samples; i++) {
-			for (int j = 0; j < num_circle_samples; j++) {
-				// Two triangles per quad
-				glm::vec3 t1(((i + 1) % num_loop_samples)*num_circle_samples + j,
-					i*num_circle_samples + ((j + 1) % num_circle_samples),
-					i*num_circle_samples + j);
-				glm::vec3 t2(((i + 1) % num_loop_samples)*num_circle_samples + j,
-					((i + 1) % num_loop_samples)*num_circle_samples + ((j + 1) % num_circle_samples),
-					i*num_circle_samples + ((j + 1) % num_circle_samples));
-				// Add two triangles to the data buffer
-				for (int k = 0; k < 3; k++) {
-					face[(i*num_circle_samples + j)*face_att * 2 + k] = (GLuint)t1[k];
-					face[(i*num_circle_samples + j)*face_att * 2 + k + face_att] = (GLuint)t2[k];
-				}
-			}
-		}
-
-		// Create OpenGL buffers and copy data
-		GLuint vbo, ebo;
+		GeometryData geometry;
+		BuildTorusGeometry(loop_radius, circle_radius, num_loop_samples, num_circle_samples, geometry);
 
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
-
-		// Free data buffers
-		delete[] vertex;
-		delete[] face;
-
-		// Create resource
-		AddResource(Mesh, object_name, vbo, ebo, face_num * face_att);
+		// Copy vertices and faces to the shared mesh buffers
+		AddMesh(object_name, &geometry.vertex[0], geometry.vertex.size() / VERTEX_FLOATS, &geometry.face[0], geometry.face.size());
 	}
 
 
@@ -557,130 +728,77 @@ namespace game
 		};
 
 
-		// Create OpenGL buffers and copy data
-		GLuint vbo;
-
-		// Create buffer for vertices
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), vertex, GL_STATIC_DRAW);
-
+		// The vertices are not shared, so each one is indexed once
+		const GLsizei vertex_num = sizeof(vertex) / (sizeof(GLfloat) * VERTEX_FLOATS);
+		GLuint face[vertex_num];
+		for (GLsizei i = 0; i < vertex_num; i++) { face[i] = i; }
 
 		// Create resource
-		AddResource(Mesh, object_name, vbo, sizeof(vertex) / (sizeof(GLfloat) * 11));
+		AddMesh(object_name, vertex, vertex_num, face, vertex_num);
 	}
 
 
 
 	void ResourceManager::CreateSphere(std::string object_name, float radius, int num_samples_theta, int num_samples_phi) {
 
-		// Create a sphere using a well-known parameterization
+		GeometryData geometry;
+		BuildSphereGeometry(radius, num_samples_theta, num_samples_phi, geometry);
 
-		// Number of vertices and faces to be created
-		const GLuint vertex_num = num_samples_theta*num_samples_phi;
-		const GLuint face_num = num_samples_theta*(num_samples_phi - 1) * 2;
+		// Copy vertices and faces to the shared mesh buffers
+		AddMesh(object_name, &geometry.vertex[0], geometry.vertex.size() / VERTEX_FLOATS, &geometry.face[0], geometry.face.size());
+	}
 
-		// Number of attributes for vertices and faces
-		const int vertex_att = 11;
-		const int face_att = 3;
 
-		// Data buffers 
-		GLfloat *vertex = NULL;
-		GLuint *face = NULL;
+	void ResourceManager::LoadTexture(const std::string name, const char *filename) {
 
-		// Allocate memory for buffers
+		// Decode the image, then create the texture from it
+		ImageData image;
+		DecodeImage(filename, image);
 		try {
-			vertex = new GLfloat[vertex_num * vertex_att]; // 11 attributes per vertex: 3D position (3), 3D normal (3), RGB color (3), 2D texture coordinates (2)
-			face = new GLuint[face_num * face_att]; // 3 indices per face
+			CreateTexture(name, image);
 		}
 		catch (std::exception &e) {
-			throw e;
+			FreeImage(image);
+			throw;
 		}
+		FreeImage(image);
+	}
 
-		// Create vertices 
-		float theta, phi; // Angles for parametric equation
-		glm::vec3 vertex_position;
-		glm::vec3 vertex_normal;
-		glm::vec3 vertex_color;
-		glm::vec2 vertex_coord;
-
-		for (int i = 0; i < num_samples_theta; i++) {
-
-			theta = 2.0*glm::pi<GLfloat>()*i / (num_samples_theta - 1); // angle theta
-
-			for (int j = 0; j < num_samples_phi; j++) {
-
-				phi = glm::pi<GLfloat>()*j / (num_samples_phi - 1); // angle phi
-
-																	// Define position, normal and color of vertex
-				vertex_normal = glm::vec3(cos(theta)*sin(phi), sin(theta)*sin(phi), -cos(phi));
-				// We need z = -cos(phi) to make sure that the z coordinate runs from -1 to 1 as phi runs from 0 to pi
-				// Otherwise, the normal will be inverted
-				vertex_position = glm::vec3(vertex_normal.x*radius,
-					vertex_normal.y*radius,
-					vertex_normal.z*radius),
-					vertex_color = glm::vec3(((float)i) / ((float)num_samples_theta), 1.0 - ((float)j) / ((float)num_samples_phi), ((float)j) / ((float)num_samples_phi));
-				vertex_coord = glm::vec2(((float)i) / ((float)num_samples_theta), 1.0 - ((float)j) / ((float)num_samples_phi));
 
-				// Add vectors to the data buffer
-				for (int k = 0; k < 3; k++) {
-					vertex[(i*num_samples_phi + j)*vertex_att + k] = vertex_position[k];
-					vertex[(i*num_samples_phi + j)*vertex_att + k + 3] = vertex_normal[k];
-					vertex[(i*num_samples_phi + j)*vertex_att + k + 6] = vertex_color[k];
-				}
-				vertex[(i*num_samples_phi + j)*vertex_att + 9] = vertex_coord[0];
-				vertex[(i*num_samples_phi + j)*vertex_att + 10] = vertex_coord[1];
-			}
-		}
+	void ResourceManager::DecodeImage(const char *filename, ImageData &image) {
 
-		// Create faces
-		for (int i = 0; i < num_samples_theta; i++) {
-			for (int j = 0; j < (num_samples_phi - 1); j++) {
-				// Two triangles per quad
-				glm::vec3 t1(((i + 1) % num_samples_theta)*num_samples_phi + j,
-					i*num_samples_phi + (j + 1),
-					i*num_samples_phi + j);
-				glm::vec3 t2(((i + 1) % num_samples_theta)*num_samples_phi + j,
-					((i + 1) % num_samples_theta)*num_samples_phi + (j + 1),
-					i*num_samples_phi + (j + 1));
-				// Add two triangles to the data buffer
-				for (int k = 0; k < 3; k++) {
-					face[(i*(num_samples_phi - 1) + j)*face_att * 2 + k] = (GLuint)t1[k];
-					face[(i*(num_samples_phi - 1) + j)*face_att * 2 + k + face_att] = (GLuint)t2[k];
-				}
-			}
+		// Load image from file into memory
+		image.pixels = SOIL_load_image(filename, &image.width, &image.height, &image.channels, SOIL_LOAD_AUTO);
+		if (!image.pixels) {
+			throw(std::ios_base::failure(std::string("Error loading texture ") + std::string(filename) + std::string(": ") + std::string(SOIL_last_result())));
 		}
+		image.filename = filename;
+	}
 
-		// Create OpenGL buffers and copy data
-		GLuint vbo, ebo;
 
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
+	void ResourceManager::CreateTexture(const std::string name, const ImageData &image) {
 
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
+		// Create texture from the decoded image
+		GLuint texture = SOIL_create_OGL_texture(image.pixels, image.width, image.height, image.channels, SOIL_CREATE_NEW_ID, 0);
+		if (!texture) {
+			throw(std::ios_base::failure(std::string("Error loading texture ") + image.filename + std::string(": ") + std::string(SOIL_last_result())));
+		}
 
-		// Free data buffers
-		delete[] vertex;
-		delete[] face;
+		// Define texture interpolation once, instead of every time the texture is drawn
+		Gl::BindTexture(GL_TEXTURE_2D, texture);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		// Create resource
-		AddResource(Mesh, object_name, vbo, ebo, face_num * face_att);
+		AddResource(Texture, name, texture, 0);
 	}
 
 
-	void ResourceManager::LoadTexture(const std::string name, const char *filename) {
-
-		// Load texture from file
-		GLuint texture = SOIL_load_OGL_texture(filename, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, 0);
-		if (!texture) {
-			throw(std::ios_base::failure(std::string("Error loading texture ") + std::string(filename) + std::string(": ") + std::string(SOIL_last_result())));
-		}
+	void ResourceManager::FreeImage(ImageData &image) {
 
-		// Create resource
-		AddResource(Texture, name, texture, 0);
+		SOIL_free_image_data(image.pixels);
+		image.pixels = NULL;
 	}
 
 
@@ -688,378 +806,177 @@ namespace game
 
 		// First load model into memory. If that goes well, we transfer the
 		// mesh to an OpenGL buffer
-		TriMesh mesh;
+		GeometryData geometry;
+		LoadMeshGeometry(name, std::vector<std::string>(1, std::string(filename)), mesh_cache_directory_, geometry);
 
-		// Parse file
-		// Open file
-		std::ifstream f;
-		f.open(filename);
-		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + std::string(filename))); }
+		AddGeometry(Mesh, name, geometry);
+	}
 
-		// Parse lines
-		std::string line;
-		std::string ignore(" \t\r\n");
-		std::string part_separator(" \t");
-		std::string face_separator("/");
-		bool added_normal = false;
-		while (std::getline(f, line)) {
-			// Clean extremities of the string
-			string_trim(line, ignore);
-			// Ignore comments
-			if ((line.size() <= 0) ||
-				(line[0] == '#')) {
-				continue;
-			}
-			// Parse string
-			std::vector<std::string> part = string_split(line, part_separator);
-			// Check commands
-			if (!part[0].compare(std::string("v"))) {
-				if (part.size() >= 4) {
-					glm::vec3 position(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
-					mesh.position.push_back(position);
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: v command should have exactly 3 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("vn"))) {
-				if (part.size() >= 4) {
-					glm::vec3 normal(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
-					mesh.normal.push_back(normal);
-					added_normal = true;
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: vn command should have exactly 3 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("vt"))) {
-				if (part.size() >= 3) {
-					glm::vec2 tex_coord(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()));
-					mesh.tex_coord.push_back(tex_coord);
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: vt command should have exactly 2 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("f"))) {
-				if (part.size() >= 4) {
-					if (part.size() > 5) {
-						throw(std::ios_base::failure(std::string("Error: f commands with more than 4 vertices not supported")));
-					}
-					else if (part.size() == 5) {
-						// Break a quad into two triangles
-						Quad quad;
-						for (int i = 0; i < 4; i++) {
-							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
-							if (fd.size() == 1) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								quad.t[i] = -1;
-								quad.n[i] = -1;
-							}
-							else if (fd.size() == 2) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								quad.n[i] = -1;
-							}
-							else if (fd.size() == 3) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								if (std::string("").compare(fd[1]) != 0) {
-									quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								}
-								else {
-									quad.t[i] = -1;
-								}
-								quad.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
-							}
-							else {
-								throw(std::ios_base::failure(std::string("Error: f parameter should have 1 or 3 parameters separated by '/'")));
-							}
-						}
-						Face face1, face2;
-						face1.i[0] = quad.i[0]; face1.i[1] = quad.i[1]; face1.i[2] = quad.i[2];
-						face1.n[0] = quad.n[0]; face1.n[1] = quad.n[1]; face1.n[2] = quad.n[2];
-						face1.t[0] = quad.t[0]; face1.t[1] = quad.t[1]; face1.t[2] = quad.t[2];
-						face2.i[0] = quad.i[0]; face2.i[1] = quad.i[2]; face2.i[2] = quad.i[3];
-						face2.n[0] = quad.n[0]; face2.n[1] = quad.n[2]; face2.n[2] = quad.n[3];
-						face2.t[0] = quad.t[0]; face2.t[1] = quad.t[2]; face2.t[2] = quad.t[3];
-						mesh.face.push_back(face1);
-						mesh.face.push_back(face2);
-					}
-					else if (part.size() == 4) {
-						Face face;
-						for (int i = 0; i < 3; i++) {
-							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
-							if (fd.size() == 1) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								face.t[i] = -1;
-								face.n[i] = -1;
-							}
-							else if (fd.size() == 2) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								face.n[i] = -1;
-							}
-							else if (fd.size() == 3) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								if (std::string("").compare(fd[1]) != 0) {
-									face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								}
-								else {
-									face.t[i] = -1;
-								}
-								face.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
-							}
-							else {
-								throw(std::ios_base::failure(std::string("Error: f parameter should have 1, 2, or 3 parameters separated by '/'")));
-							}
-						}
-						mesh.face.push_back(face);
-					}
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: f command should have 3 or 4 parameters")));
-				}
-			}
-			// Ignore other commands
-		}
 
-		// Close file
-		f.close();
+	void ResourceManager::LoadMeshGeometry(const std::string name, const std::vector<std::string> &filenames, const std::string &cache_directory, GeometryData &geometry) {
 
-		// Check if vertex references are correct
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			for (int j = 0; j < 3; j++) {
-				if (mesh.face[i].i[j] >= mesh.position.size()) {
-					throw(std::ios_base::failure(std::string("Error: index for triangle ") + num_to_str<int>(mesh.face[i].i[j]) + std::string(" is out of bounds")));
-				}
-			}
+		// The key covers the contents of the files, so edited models are loaded again
+		unsigned long long key = 14695981039346656037ULL;
+		key = HashString(std::string(MESH_CACHE_MAGIC), key);
+		for (int i = 0; i < filenames.size(); i++) {
+			key = HashString(LoadTextFile(filenames[i].c_str()), key);
 		}
-
-		// Compute degree of each vertex
-		std::vector<int> degree(mesh.position.size(), 0);
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			for (int j = 0; j < 3; j++) {
-				degree[mesh.face[i].i[j]]++;
-			}
+		std::string cache_file = cache_directory + std::string("/") + name + std::string(MESH_CACHE_EXTENSION);
+		if (!cache_directory.empty() && LoadMeshCache(cache_file, key, geometry)) {
+			return;
 		}
 
-		// Compute vertex normals if no normals were ever added
-		if (!added_normal) {
-			mesh.normal = std::vector<glm::vec3>(mesh.position.size(), glm::vec3(0.0, 0.0, 0.0));
-			for (unsigned int i = 0; i < mesh.face.size(); i++) {
-				// Compute face normal
-				glm::vec3 vec1, vec2;
-				vec1 = mesh.position[mesh.face[i].i[0]] -
-					mesh.position[mesh.face[i].i[1]];
-				vec2 = mesh.position[mesh.face[i].i[0]] -
-					mesh.position[mesh.face[i].i[2]];
-				glm::vec3 norm = glm::cross(vec1, vec2);
-				norm = glm::normalize(norm);
-				// Add face normal to vertices
-				mesh.normal[mesh.face[i].i[0]] += norm;
-				mesh.normal[mesh.face[i].i[1]] += norm;
-				mesh.normal[mesh.face[i].i[2]] += norm;
-			}
-			for (unsigned int i = 0; i < mesh.normal.size(); i++) {
-				if (degree[i] > 0) {
-					mesh.normal[i] /= degree[i];
-				}
-			}
+		// Parse the files, merging them when there are several parts
+		std::vector<GeometryData> part(filenames.size());
+		for (int i = 0; i < filenames.size(); i++) {
+			TriMesh mesh;
+			LoadObj(filenames[i].c_str(), mesh);
+			BuildMeshGeometry(mesh, part[i]);
+		}
+		if (part.size() == 1) {
+			geometry = part[0];
+		}
+		else {
+			MergeGeometry(part, geometry);
 		}
 
-		// Debug
-		//print_mesh(mesh);
+		// Levels of detail, then the order of triangles and vertices in each level
+		BuildMeshLods(geometry);
+		float acmr_before, acmr_after;
+		OptimizeMesh(geometry, acmr_before, acmr_after);
 
-		// If we got to this point, the file was parsed successfully and the
-		// mesh is in memory
-		// Now, transfer the mesh to OpenGL buffers
-		// Create three new vertices for each face, in case vertex
-		// normals/texture coordinates are not consistent over the mesh
+		std::ostringstream report;
+		report << "Mesh " << name << ": ACMR " << acmr_before << " -> " << acmr_after << std::endl;
+		std::cout << report.str();
 
-		// Number of attributes for vertices and faces
-		const int vertex_att = 11;
-		const int face_att = 3;
+		if (!cache_directory.empty()) {
+			SaveMeshCache(cache_file, key, geometry);
+		}
+	}
 
-		// Create OpenGL buffers and copy data
-		GLuint vbo, ebo;
 
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, mesh.face.size() * 3 * vertex_att * sizeof(GLuint), 0, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.face.size() * face_att * sizeof(GLuint), 0, GL_STATIC_DRAW);
-
-		unsigned int vertex_index = 0;
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			// Add three vertices and their attributes
-			GLfloat att[3 * vertex_att] = { 0 };
-			for (int j = 0; j < 3; j++) {
-				// Position
-				att[j*vertex_att + 0] = mesh.position[mesh.face[i].i[j]][0];
-				att[j*vertex_att + 1] = mesh.position[mesh.face[i].i[j]][1];
-				att[j*vertex_att + 2] = mesh.position[mesh.face[i].i[j]][2];
-				// Normal
-				if (!added_normal) {
-					att[j*vertex_att + 3] = mesh.normal[mesh.face[i].i[j]][0];
-					att[j*vertex_att + 4] = mesh.normal[mesh.face[i].i[j]][1];
-					att[j*vertex_att + 5] = mesh.normal[mesh.face[i].i[j]][2];
-				}
-				else {
-					if (mesh.face[i].n[j] >= 0) {
-						att[j*vertex_att + 3] = mesh.normal[mesh.face[i].n[j]][0];
-						att[j*vertex_att + 4] = mesh.normal[mesh.face[i].n[j]][1];
-						att[j*vertex_att + 5] = mesh.normal[mesh.face[i].n[j]][2];
-					}
-				}
-				// No color in (6, 7, 8)
-				// Texture coordinates
-				if (mesh.face[i].t[j] >= 0) {
-					att[j*vertex_att + 9] = mesh.tex_coord[mesh.face[i].t[j]][0];
-					att[j*vertex_att + 10] = mesh.tex_coord[mesh.face[i].t[j]][1];
-				}
-			}
+	unsigned long long ResourceManager::MeshParticlesKey(const std::string &filename, int num_particles) {
+
+		// Same contents and number of particles give the same points, the sampler is deterministic
+		std::ostringstream count;
+		count << num_particles;
+		unsigned long long key = 14695981039346656037ULL;
+		key = HashString(std::string(PARTICLE_CACHE_VERSION), key);
+		key = HashString(count.str(), key);
+		return HashString(LoadTextFile(filename.c_str()), key);
+	}
 
-			// Copy attributes to buffer
-			glBufferSubData(GL_ARRAY_BUFFER, i * 3 * vertex_att * sizeof(GLfloat), 3 * vertex_att * sizeof(GLfloat), att);
 
-			// Add triangle
-			GLuint findex[face_att] = { 0 };
-			findex[0] = vertex_index;
-			findex[1] = vertex_index + 1;
-			findex[2] = vertex_index + 2;
-			vertex_index += 3;
+	bool ResourceManager::LoadParticleCache(const std::string name, const std::string &cache_directory, unsigned long long key, GeometryData &geometry) {
 
-			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, i * face_att * sizeof(GLuint), face_att * sizeof(GLuint), findex);
+		if (cache_directory.empty()) {
+			return false;
 		}
-
-		// Create resource
-		AddResource(Mesh, name, vbo, ebo, mesh.face.size() * face_att);
+		return LoadMeshCache(cache_directory + std::string("/") + name + std::string(PARTICLE_CACHE_EXTENSION), key, geometry);
 	}
 
 
-	void string_trim(std::string str, std::string to_trim) {
+	void ResourceManager::SaveParticleCache(const std::string name, const std::string &cache_directory, unsigned long long key, const GeometryData &geometry) {
 
-		// Trim any character in to_trim from the beginning of the string str
-		while ((str.size() > 0) &&
-			(to_trim.find(str[0]) != std::string::npos)) {
-			str.erase(0);
-		}
-
-		// Trim any character in to_trim from the end of the string str
-		while ((str.size() > 0) &&
-			(to_trim.find(str[str.size() - 1]) != std::string::npos)) {
-			str.erase(str.size() - 1);
+		if (!cache_directory.empty()) {
+			SaveMeshCache(cache_directory + std::string("/") + name + std::string(PARTICLE_CACHE_EXTENSION), key, geometry);
 		}
 	}
 
 
-	std::vector<std::string> string_split(std::string str, std::string separator) {
-
-		// Initialize output
-		std::vector<std::string> output;
-		output.push_back(std::string(""));
-		int string_index = 0;
-
-		// Analyze string
-		unsigned int i = 0;
-		while (i < str.size()) {
-			// Check if character i is a separator
-			if (separator.find(str[i]) != std::string::npos) {
-				// Split string
-				string_index++;
-				output.push_back(std::string(""));
-				// Skip separators
-				while ((i < str.size()) && (separator.find(str[i]) != std::string::npos)) {
-					i++;
-				}
-			}
-			else {
-				// Otherwise, copy string
-				output[string_index] += str[i];
-				i++;
-			}
-		}
+	bool ResourceManager::LoadMeshCache(const std::string &filename, unsigned long long key, GeometryData &geometry) {
 
-		return output;
+		// Open file, a missing file just means the cache is cold
+		std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary);
+		if (f.fail()) {
+			return false;
+		}
+
+		// Header: magic number, key of the obj files and size of each array
+		char magic[4];
+		unsigned long long file_key;
+		unsigned int num_floats, num_indices, num_lods;
+		f.read(magic, 4);
+		f.read((char *)&file_key, sizeof(file_key));
+		f.read((char *)&num_floats, sizeof(num_floats));
+		f.read((char *)&num_indices, sizeof(num_indices));
+		f.read((char *)&num_lods, sizeof(num_lods));
+		if (f.fail() || std::string(magic, 4) != std::string(MESH_CACHE_MAGIC, 4) || file_key != key || num_lods > MAX_LOD_LEVELS) {
+			return false;
+		}
+
+		geometry.vertex.resize(num_floats);
+		geometry.face.resize(num_indices);
+		geometry.lod_size.resize(num_lods);
+		if (num_floats > 0) f.read((char *)&geometry.vertex[0], num_floats * sizeof(GLfloat));
+		if (num_indices > 0) f.read((char *)&geometry.face[0], num_indices * sizeof(GLuint));
+		if (num_lods > 0) f.read((char *)&geometry.lod_size[0], num_lods * sizeof(GLsizei));
+		return !f.fail();
 	}
 
 
-	std::vector<std::string> string_split_once(std::string str, std::string separator)
-	{
-		// Initialize output
-		std::vector<std::string> output;
-		output.push_back(std::string(""));
-		int string_index = 0;
-
-		// Analyze string
-		unsigned int i = 0;
-		while (i < str.size()) {
-			// Check if character i is a separator
-			if (separator.find(str[i]) != std::string::npos) {
-				// Split string
-				string_index++;
-				output.push_back(std::string(""));
-				// Skip single separator
-				i++;
-			}
-			else {
-				// Otherwise, copy string
-				output[string_index] += str[i];
-				i++;
-			}
-		}
+	void ResourceManager::SaveMeshCache(const std::string &filename, unsigned long long key, const GeometryData &geometry) {
 
-		return output;
+		// Write file, the cache is only an optimization so errors are ignored
+		std::ofstream f(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (f.fail()) {
+			return;
+		}
+		unsigned int num_floats = geometry.vertex.size();
+		unsigned int num_indices = geometry.face.size();
+		unsigned int num_lods = geometry.lod_size.size();
+		f.write(MESH_CACHE_MAGIC, 4);
+		f.write((const char *)&key, sizeof(key));
+		f.write((const char *)&num_floats, sizeof(num_floats));
+		f.write((const char *)&num_indices, sizeof(num_indices));
+		f.write((const char *)&num_lods, sizeof(num_lods));
+		if (num_floats > 0) f.write((const char *)&geometry.vertex[0], num_floats * sizeof(GLfloat));
+		if (num_indices > 0) f.write((const char *)&geometry.face[0], num_indices * sizeof(GLuint));
+		if (num_lods > 0) f.write((const char *)&geometry.lod_size[0], num_lods * sizeof(GLsizei));
+		f.close();
 	}
 
 
-	void print_mesh(TriMesh &mesh) {
+	void ResourceManager::AddGeometry(ResourceType type, const std::string name, const GeometryData &geometry) {
 
-		for (unsigned int i = 0; i < mesh.position.size(); i++) {
-			std::cout << "v " <<
-				mesh.position[i].x << " " <<
-				mesh.position[i].y << " " <<
-				mesh.position[i].z << std::endl;
-		}
-		for (unsigned int i = 0; i < mesh.normal.size(); i++) {
-			std::cout << "vn " <<
-				mesh.normal[i].x << " " <<
-				mesh.normal[i].y << " " <<
-				mesh.normal[i].z << std::endl;
-		}
-		for (unsigned int i = 0; i < mesh.tex_coord.size(); i++) {
-			std::cout << "vt " <<
-				mesh.tex_coord[i].x << " " <<
-				mesh.tex_coord[i].y << std::endl;
-		}
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			std::cout << "f " <<
-				mesh.face[i].i[0] << " " <<
-				mesh.face[i].i[1] << " " <<
-				mesh.face[i].i[2] << " " << std::endl;
+		GLsizei num_vertices = geometry.vertex.size() / VERTEX_FLOATS;
+		const GLfloat *vertex = geometry.vertex.empty() ? NULL : &geometry.vertex[0];
+
+		// Meshes go to the shared mesh buffers
+		if (type == Mesh) {
+			AddMesh(name, vertex, num_vertices, geometry.face.empty() ? NULL : &geometry.face[0], geometry.face.size(),
+				geometry.lod_size.empty() ? NULL : &geometry.lod_size[0], geometry.lod_size.size());
+			return;
 		}
-	}
 
+		// Point sets are drawn without indices, from their own buffer
+		VertexFormat format;
+		float radius;
+		GLuint vbo = CreateVertexBuffer(vertex, num_vertices, format, radius);
+		AddResource(type, name, vbo, 0, num_vertices, format, radius);
+	}
 
-	template <typename T> std::string num_to_str(T num) {
 
-		std::ostringstream ss;
-		ss << num;
-		return ss.str();
-	}
+	void ResourceManager::AddMesh(const std::string name, const GLfloat *vertex, GLsizei num_vertices, const GLuint *face, GLsizei num_indices, const GLsizei *lod_size, int num_lods) {
 
+		// Pack the vertices and copy them, with the faces, to the arena
+		std::vector<unsigned char> packed;
+		VertexFormat format = PackVertexData(vertex, num_vertices, packed);
+		GLint base_vertex;
+		GLsizei first_index;
+		arena_.Allocate(packed.empty() ? NULL : &packed[0], packed.size(), format.stride, face, num_indices, base_vertex, first_index);
 
-	template <typename T> T str_to_num(const std::string &str) {
+		// Create resource
+		Resource *res;
+		res = new Resource(Mesh, name, arena_.GetArrayBuffer(), arena_.GetElementArrayBuffer(), num_indices);
+		res->SetVertexFormat(format);
+		res->SetDrawRange(base_vertex, first_index);
+		if (num_lods > 0) { res->SetLods(lod_size, num_lods); }
 
-		std::istringstream ss(str);
-		T result;
-		ss >> result;
-		if (ss.fail()) {
-			throw(std::ios_base::failure(std::string("Invalid number: ") + str));
-		}
-		return result;
+		// Size of the geometry, for choosing the level of detail
+		res->SetBoundingRadius(ComputeBoundingRadius(vertex, num_vertices));
+		resource_.push_back(res);
+		Counters::Add(CounterResourcesCreated);
 	}
 
 
@@ -1077,19 +994,8 @@ namespace game
 		GLuint face[] = { 0, 2, 1,
 			0, 3, 2 };
 
-		// Create OpenGL buffers and copy data
-		GLuint vbo, ebo;
-
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, 4 * 11 * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 2 * 3 * sizeof(GLuint), face, GL_STATIC_DRAW);
-
 		// Create resource
-		AddResource(Mesh, object_name, vbo, ebo, 2 * 3);
+		AddMesh(object_name, vertex, 4, face, 2 * 3);
 	}
 
 	void ResourceManager::CreateSphereParticles(std::string object_name, int num_particles) {
@@ -1105,7 +1011,7 @@ namespace game
 
 		// Allocate memory for buffer
 		try {
-			particle = new GLfloat[num_particles * particle_att];
+			particle = new GLfloat[num_particles * particle_att]();
 		}
 		catch (std::exception &e) {
 			throw e;
@@ -1144,15 +1050,15 @@ namespace game
 
 		// Create OpenGL buffers and copy data
 		GLuint vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle, GL_STATIC_DRAW);
+		VertexFormat format;
+		float radius;
+		vbo = CreateVertexBuffer(particle, num_particles, format, radius);
 
 		// Free data buffers
 		delete[] particle;
 
 		// Create resource
-		AddResource(PointSet, object_name, vbo, 0, num_particles);
+		AddResource(PointSet, object_name, vbo, 0, num_particles, format, radius);
 	}
 
 
@@ -1169,7 +1075,7 @@ namespace game
 
 		// Allocate memory for buffer
 		try {
-			particle = new GLfloat[num_particles * particle_att];
+			particle = new GLfloat[num_particles * particle_att]();
 		}
 		catch (std::exception &e) {
 			throw e;
@@ -1226,323 +1132,78 @@ namespace game
 
 		// Create OpenGL buffers and copy data
 		GLuint vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle, GL_STATIC_DRAW);
+		VertexFormat format;
+		float radius;
+		vbo = CreateVertexBuffer(particle, num_particles, format, radius);
 
 		// Free data buffers
 		delete[] particle;
 
 		// Create resource
-		AddResource(PointSet, object_name, vbo, 0, num_particles);
+		AddResource(PointSet, object_name, vbo, 0, num_particles, format, radius);
 	}
 
-	void ResourceManager::LoadMeshParticles(const std::string name, const char *filename, int num_particles) {
+	VertexFormat ResourceManager::PackVertexData(const GLfloat *vertex, GLsizei num_vertices, std::vector<unsigned char> &packed) {
 
-		// First load model into memory. If that goes well, we transfer the
-		// mesh to an OpenGL buffer
-		TriMesh mesh;
+		// Store the vertices in the smallest format that holds them
+		bool packed_normals = GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev;
+		VertexFormat format = ChooseVertexFormat(vertex, num_vertices, packed_normals);
+		PackVertices(vertex, num_vertices, format, packed);
+		return format;
+	}
 
-		// Parse file
-		// Open file
-		std::ifstream f;
-		f.open(filename);
-		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + std::string(filename))); }
 
-		// Parse lines
-		std::string line;
-		std::string ignore(" \t\r\n");
-		std::string part_separator(" \t");
-		std::string face_separator("/");
-		bool added_normal = false;
-		while (std::getline(f, line)) {
-			// Clean extremities of the string
-			string_trim(line, ignore);
-			// Ignore comments
-			if ((line.size() <= 0) ||
-				(line[0] == '#')) {
-				continue;
-			}
-			// Parse string
-			std::vector<std::string> part = string_split(line, part_separator);
-			// Check commands
-			if (!part[0].compare(std::string("v"))) {
-				if (part.size() >= 4) {
-					glm::vec3 position(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
-					mesh.position.push_back(position);
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: v command should have exactly 3 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("vn"))) {
-				if (part.size() >= 4) {
-					glm::vec3 normal(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()), str_to_num<float>(part[3].c_str()));
-					mesh.normal.push_back(normal);
-					added_normal = true;
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: vn command should have exactly 3 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("vt"))) {
-				if (part.size() >= 3) {
-					glm::vec2 tex_coord(str_to_num<float>(part[1].c_str()), str_to_num<float>(part[2].c_str()));
-					mesh.tex_coord.push_back(tex_coord);
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: vt command should have exactly 2 parameters")));
-				}
-			}
-			else if (!part[0].compare(std::string("f"))) {
-				if (part.size() >= 4) {
-					if (part.size() > 5) {
-						throw(std::ios_base::failure(std::string("Error: f commands with more than 4 vertices not supported")));
-					}
-					else if (part.size() == 5) {
-						// Break a quad into two triangles
-						Quad quad;
-						for (int i = 0; i < 4; i++) {
-							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
-							if (fd.size() == 1) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								quad.t[i] = -1;
-								quad.n[i] = -1;
-							}
-							else if (fd.size() == 2) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								quad.n[i] = -1;
-							}
-							else if (fd.size() == 3) {
-								quad.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								if (std::string("").compare(fd[1]) != 0) {
-									quad.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								}
-								else {
-									quad.t[i] = -1;
-								}
-								quad.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
-							}
-							else {
-								throw(std::ios_base::failure(std::string("Error: f parameter should have 1 or 3 parameters separated by '/'")));
-							}
-						}
-						Face face1, face2;
-						face1.i[0] = quad.i[0]; face1.i[1] = quad.i[1]; face1.i[2] = quad.i[2];
-						face1.n[0] = quad.n[0]; face1.n[1] = quad.n[1]; face1.n[2] = quad.n[2];
-						face1.t[0] = quad.t[0]; face1.t[1] = quad.t[1]; face1.t[2] = quad.t[2];
-						face2.i[0] = quad.i[0]; face2.i[1] = quad.i[2]; face2.i[2] = quad.i[3];
-						face2.n[0] = quad.n[0]; face2.n[1] = quad.n[2]; face2.n[2] = quad.n[3];
-						face2.t[0] = quad.t[0]; face2.t[1] = quad.t[2]; face2.t[2] = quad.t[3];
-						mesh.face.push_back(face1);
-						mesh.face.push_back(face2);
-					}
-					else if (part.size() == 4) {
-						Face face;
-						for (int i = 0; i < 3; i++) {
-							std::vector<std::string> fd = string_split_once(part[i + 1], face_separator);
-							if (fd.size() == 1) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								face.t[i] = -1;
-								face.n[i] = -1;
-							}
-							else if (fd.size() == 2) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								face.n[i] = -1;
-							}
-							else if (fd.size() == 3) {
-								face.i[i] = str_to_num<float>(fd[0].c_str()) - 1;
-								if (std::string("").compare(fd[1]) != 0) {
-									face.t[i] = str_to_num<float>(fd[1].c_str()) - 1;
-								}
-								else {
-									face.t[i] = -1;
-								}
-								face.n[i] = str_to_num<float>(fd[2].c_str()) - 1;
-							}
-							else {
-								throw(std::ios_base::failure(std::string("Error: f parameter should have 1, 2, or 3 parameters separated by '/'")));
-							}
-						}
-						mesh.face.push_back(face);
-					}
-				}
-				else {
-					throw(std::ios_base::failure(std::string("Error: f command should have 3 or 4 parameters")));
-				}
-			}
-			// Ignore other commands
-		}
+	GLuint ResourceManager::CreateVertexBuffer(const GLfloat *vertex, GLsizei num_vertices, VertexFormat &format, float &bounding_radius) {
 
-		// Close file
-		f.close();
+		std::vector<unsigned char> packed;
+		format = PackVertexData(vertex, num_vertices, packed);
+		bounding_radius = ComputeBoundingRadius(vertex, num_vertices);
 
-		// Check if vertex references are correct
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			for (int j = 0; j < 3; j++) {
-				if (mesh.face[i].i[j] >= mesh.position.size()) {
-					throw(std::ios_base::failure(std::string("Error: index for triangle ") + num_to_str<int>(mesh.face[i].i[j]) + std::string(" is out of bounds")));
-				}
-			}
+		// Point sets are drawn from a prefix when they are small on screen,
+		// so store them in random order to make any prefix a uniform sample
+		std::mt19937 generator(num_vertices);
+		std::vector<unsigned char> swap(format.stride);
+		for (GLsizei i = num_vertices - 1; i > 0; i--) {
+			GLsizei j = std::uniform_int_distribution<GLsizei>(0, i)(generator);
+			unsigned char *a = &packed[i * format.stride];
+			unsigned char *b = &packed[j * format.stride];
+			memcpy(&swap[0], a, format.stride);
+			memcpy(a, b, format.stride);
+			memcpy(b, &swap[0], format.stride);
 		}
 
-		// Compute degree of each vertex
-		std::vector<int> degree(mesh.position.size(), 0);
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-			for (int j = 0; j < 3; j++) {
-				degree[mesh.face[i].i[j]]++;
-			}
-		}
-
-		// Compute vertex normals if no normals were ever added
-		if (!added_normal) {
-			mesh.normal = std::vector<glm::vec3>(mesh.position.size(), glm::vec3(0.0, 0.0, 0.0));
-			for (unsigned int i = 0; i < mesh.face.size(); i++) {
-				// Compute face normal
-				glm::vec3 vec1, vec2;
-				vec1 = mesh.position[mesh.face[i].i[0]] -
-					mesh.position[mesh.face[i].i[1]];
-				vec2 = mesh.position[mesh.face[i].i[0]] -
-					mesh.position[mesh.face[i].i[2]];
-				glm::vec3 norm = glm::cross(vec1, vec2);
-				norm = glm::normalize(norm);
-				// Add face normal to vertices
-				mesh.normal[mesh.face[i].i[0]] += norm;
-				mesh.normal[mesh.face[i].i[1]] += norm;
-				mesh.normal[mesh.face[i].i[2]] += norm;
-			}
-			for (unsigned int i = 0; i < mesh.normal.size(); i++) {
-				if (degree[i] > 0) {
-					mesh.normal[i] /= degree[i];
-				}
-			}
-		}
-
-		// Debug
-		//print_mesh(mesh);
-
-		// If we got to this point, the file was parsed successfully and the
-		// mesh is in memory
-		// Now, transfer the mesh to OpenGL buffers
-		// Create three new vertices for each face, in case vertex
-		// normals/texture coordinates are not consistent over the mesh
-
-		// Number of attributes for vertices and faces
-		const int vertex_att = 11;
-		//const int face_att = 3;
-
-		// Create OpenGL buffers and copy data
-		//GLuint vbo, ebo;
-
-		/*glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, mesh.face.size() * 3 * vertex_att * sizeof(GLuint), 0, GL_STATIC_DRAW);
+		GLuint vbo;
+		glGenBuffers(1, &vbo);
+		Gl::BindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.empty() ? NULL : &packed[0], GL_STATIC_DRAW);
+		return vbo;
+	}
 
-		glGenBuffers(1, &ebo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.face.size() * face_att * sizeof(GLuint), 0, GL_STATIC_DRAW);*/
 
-		//GLfloat **particleSample = NULL;
-		GLfloat *outParticle = NULL;
-		try {
-			//particleSample = new GLfloat*[mesh.face.size()];
-			outParticle = new GLfloat[vertex_att * num_particles];
-		}
-		catch (std::exception &e) {
-			throw e;
-		}
+	float ResourceManager::ComputeBoundingRadius(const GLfloat *vertex, GLsizei num_vertices) {
 
-		/*unsigned int vertex_index = 0;
-		for (unsigned int i = 0; i < mesh.face.size(); i++) {
-		// Add three vertices and their attributes
-		GLfloat att[3 * vertex_att] = { 0 };
-		for (int j = 0; j < 3; j++) {
-		// Position
-		att[j*vertex_att + 0] = mesh.position[mesh.face[i].i[j]][0];
-		att[j*vertex_att + 1] = mesh.position[mesh.face[i].i[j]][1];
-		att[j*vertex_att + 2] = mesh.position[mesh.face[i].i[j]][2];
-		// Normal
-		if (!added_normal) {
-		att[j*vertex_att + 3] = mesh.normal[mesh.face[i].i[j]][0];
-		att[j*vertex_att + 4] = mesh.normal[mesh.face[i].i[j]][1];
-		att[j*vertex_att + 5] = mesh.normal[mesh.face[i].i[j]][2];
-		}
-		else {
-		if (mesh.face[i].n[j] >= 0) {
-		att[j*vertex_att + 3] = mesh.normal[mesh.face[i].n[j]][0];
-		att[j*vertex_att + 4] = mesh.normal[mesh.face[i].n[j]][1];
-		att[j*vertex_att + 5] = mesh.normal[mesh.face[i].n[j]][2];
-		}
-		}
-		// No color in (6, 7, 8)
-		// Texture coordinates
-		if (mesh.face[i].t[j] >= 0) {
-		att[j*vertex_att + 9] = mesh.tex_coord[mesh.face[i].t[j]][0];
-		att[j*vertex_att + 10] = mesh.tex_coord[mesh.face[i].t[j]][1];
-		}
+		float radius = 0;
+		for (int i = 0; i < num_vertices; i++)
+		{
+			radius = std::max(radius, glm::length(glm::vec3(vertex[i * VERTEX_FLOATS], vertex[i * VERTEX_FLOATS + 1], vertex[i * VERTEX_FLOATS + 2])));
 		}
-		particleSample[i] = att;
-
-		// Copy attributes to buffer
-		//glBufferSubData(GL_ARRAY_BUFFER, i * 3 * vertex_att * sizeof(GLfloat), 3 * vertex_att * sizeof(GLfloat), att);
-
-		// Add triangle
-		GLuint findex[face_att] = { 0 };
-		findex[0] = vertex_index;
-		findex[1] = vertex_index + 1;
-		findex[2] = vertex_index + 2;
-		vertex_index += 3;
-
-		//glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, i * face_att * sizeof(GLuint), face_att * sizeof(GLuint), findex);
-		}*/
+		return radius;
+	}
 
-		int u, v; //Work variables
-				  //randomly select particles from the sample
-		for (int i = 0; i < num_particles; i++)
-		{
-			u = rand() % mesh.position.size();
-			v = rand() % 3;
 
-			glm::vec3 position(mesh.position[mesh.face[u].i[v]][0], mesh.position[mesh.face[u].i[v]][1], mesh.position[mesh.face[u].i[v]][2]);
-			glm::vec3 normal;
-			if (!added_normal) {
-				normal = glm::vec3(mesh.normal[mesh.face[u].i[v]][0], mesh.normal[mesh.face[u].i[v]][1], mesh.normal[mesh.face[u].i[v]][2]);
-			}
-			else {
-				normal = glm::vec3(mesh.normal[mesh.face[u].n[v]][0], mesh.normal[mesh.face[u].n[v]][1], mesh.normal[mesh.face[u].n[v]][2]);
-			}
-			glm::vec3 color(i / (float)num_particles, 0.0, 1.0 - (i / (float)num_particles));
-			/*
-			glm::vec3 position(mesh.position[mesh.face[i].i[0]][0], mesh.position[mesh.face[i].i[0]][1], mesh.position[mesh.face[i].i[0]][2]);
-			glm::vec3 normal;
-			if (!added_normal) {
-			normal = glm::vec3(mesh.normal[mesh.face[i].i[0]][0], mesh.normal[mesh.face[i].i[0]][1], mesh.normal[mesh.face[i].i[0]][2]);
-			}
-			else {
-			normal = glm::vec3(mesh.normal[mesh.face[i].n[0]][0], mesh.normal[mesh.face[i].n[0]][1], mesh.normal[mesh.face[i].n[0]][2]);
-			}
-			glm::vec3 color(i / (float)num_particles, 0.0, 1.0 - (i / (float)num_particles));*/
+	void ResourceManager::LoadMeshParticles(const std::string name, const char *filename, int num_particles) {
 
-			for (int k = 0; k < 3; k++)
-			{
-				outParticle[i*vertex_att + k] = position[k];
-				outParticle[i*vertex_att + k + 3] = normal[k];
-				outParticle[i*vertex_att + k + 6] = color[k];
-			}
+		// Load model into memory, then sample the particles from its faces
+		GeometryData geometry;
+		unsigned long long key = MeshParticlesKey(filename, num_particles);
+		if (!LoadParticleCache(name, mesh_cache_directory_, key, geometry)) {
+			TriMesh mesh;
+			LoadObj(filename, mesh);
+			BuildMeshParticles(mesh, num_particles, geometry);
+			SaveParticleCache(name, mesh_cache_directory_, key, geometry);
 		}
 
-		GLuint vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, num_particles * vertex_att * sizeof(GLfloat), outParticle, GL_STATIC_DRAW);
-
-		delete[] outParticle;
-		//delete[] particleSample;
-
-		// Create resource
-		AddResource(PointSet, name, vbo, 0, num_particles);
+		AddGeometry(PointSet, name, geometry);
 	}
 
 	void ResourceManager::CreateControlPoints(std::string object_name, int num_control_points) {
@@ -1657,7 +1318,7 @@ namespace game
 
 		// Allocate memory for buffer
 		try {
-			particle = new GLfloat[num_particles * particle_att];
+			particle = new GLfloat[num_particles * particle_att]();
 		}
 		catch (std::exception &e) {
 			throw e;
@@ -1707,15 +1368,15 @@ namespace game
 
 		// Create OpenGL buffers and copy data
 		GLuint vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle, GL_STATIC_DRAW);
+		VertexFormat format;
+		float radius;
+		vbo = CreateVertexBuffer(particle, num_particles, format, radius);
 
 		// Free data buffers
 		delete[] particle;
 
 		// Create resource
-		AddResource(PointSet, object_name, vbo, 0, num_particles);
+		AddResource(PointSet, object_name, vbo, 0, num_particles, format, radius);
 	}
 
 } // namespace game;
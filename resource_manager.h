@@ -8,14 +8,49 @@
 #include <GLFW/glfw3.h>
 
 #include "resource.h"
+#include "mesh_loader.h"
+#include "geometry_arena.h"
 
 // Default extensions for different shader source files
 #define VERTEX_PROGRAM_EXTENSION "_vp.glsl"
 #define FRAGMENT_PROGRAM_EXTENSION "_fp.glsl"
 #define GEOMETRY_PROGRAM_EXTENSION "_gp.glsl"
+#define QUAD_VERTEX_PROGRAM_EXTENSION "_quad_vp.glsl"
+
+// Program binary cache files
+#define PROGRAM_BINARY_EXTENSION ".bin"
+#define PROGRAM_BINARY_MAGIC "PGB1"
+
+// Mesh cache files, holding meshes after simplification and optimization
+#define MESH_CACHE_EXTENSION ".mesh"
+#define MESH_CACHE_MAGIC "MSH1"
+// Point sets sampled from meshes, stored in the mesh cache format
+#define PARTICLE_CACHE_EXTENSION ".points"
+#define PARTICLE_CACHE_VERSION "PTS1"
 
 namespace game 
 {
+	// Shader program sources, loaded from files before the program is compiled
+	struct MaterialSource
+	{
+		std::string vp;				// Vertex program
+		std::string fp;				// Fragment program
+		std::string gp;				// Geometry program
+		bool geometry_program;		// Whether a geometry program was found
+		std::vector<std::string> feedback_varyings;	// Outputs captured with transform feedback, in buffer order
+		bool quad_particles;		// Points are drawn as instanced quads, the vertex program places the corners
+	};
+
+	// Image decoded into memory, before it is copied to an OpenGL texture
+	struct ImageData
+	{
+		unsigned char *pixels;		// Pixel data, freed with FreeImage
+		int width;					// Width in pixels
+		int height;					// Height in pixels
+		int channels;				// Number of color channels
+		std::string filename;		// File the image came from
+	};
+
     // Class that manages all resources
     class ResourceManager 
 	{
@@ -25,10 +60,31 @@ namespace game
 
 		void AddResource(ResourceType type, const std::string name, GLuint resource, GLsizei size);	// Add a resource that was already loaded and allocated to memory
 		void AddResource(ResourceType type, const std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size);
+		void AddResource(ResourceType type, const std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size, const VertexFormat &format, float bounding_radius = 0);
 		void AddResource(ResourceType type, const std::string name, GLfloat *data, GLsizei size);// Load a resource from a file, according to the specified type
 		void LoadResource(ResourceType type, const std::string name, const char *filename, int num_particles = 20000);	// Load a resource from a file, according to the specified type
 		Resource *GetResource(const std::string name) const;	// Get the resource with the specified name
 
+		// Loading is split in two stages so that files can be read on worker threads:
+		// the static methods only read and decode files, the others create the OpenGL objects
+		static std::string LoadTextFile(const char *filename);	 // Load a text file into memory (could be source code)
+		static void LoadMaterialSource(const char *prefix, MaterialSource &source);	// Load the sources of a shader program
+		static void LoadQuadMaterialSource(const char *prefix, MaterialSource &source);	// Load a particle program drawing instanced quads instead of using its geometry program
+		static void DecodeImage(const char *filename, ImageData &image);	// Decode an image file into memory
+		static void FreeImage(ImageData &image);	// Free a decoded image
+		static void LoadMeshGeometry(const std::string name, const std::vector<std::string> &filenames, const std::string &cache_directory, GeometryData &geometry);	// Load obj files as one optimized mesh, or read it from the mesh cache
+		static unsigned long long MeshParticlesKey(const std::string &filename, int num_particles);	// Key of a point set sampled from an obj file
+		static bool LoadParticleCache(const std::string name, const std::string &cache_directory, unsigned long long key, GeometryData &geometry);	// Read a sampled point set from the mesh cache
+		static void SaveParticleCache(const std::string name, const std::string &cache_directory, unsigned long long key, const GeometryData &geometry);	// Write a sampled point set to the mesh cache
+		void QueueMaterial(const std::string name, const MaterialSource &source);	// Start compiling and linking a shader program
+		bool MaterialsReady(void) const;	// Whether the queued programs are built, so FinishMaterials will not block
+		void FinishMaterials(void);	// Check the queued programs and add them as resources
+		void CreateTexture(const std::string name, const ImageData &image);	// Create a texture from a decoded image
+		void AddGeometry(ResourceType type, const std::string name, const GeometryData &geometry);	// Copy a mesh or point set to OpenGL buffers
+		void SetShaderCacheDirectory(const std::string directory);	// Cache linked programs in this directory, empty to disable
+		void SetMeshCacheDirectory(const std::string directory);	// Cache optimized meshes in this directory, empty to disable
+		const std::string &GetMeshCacheDirectory(void) const;
+
         // Methods to create Geometry
 		void CreateTorus(std::string object_name, float loop_radius = 0.6, float circle_radius = 0.2, int num_loop_samples = 90, int num_circle_samples = 30);
 		void CreateSphere(std::string object_name, float radius = 0.6, int num_samples_theta = 90, int num_samples_phi = 45);
@@ -42,13 +98,48 @@ namespace game
 		void CreateControlPoints(std::string object_name, int num_control_points);
 	private:
 		std::vector<Resource*> resource_;	// List storing all resources
+		GeometryArena arena_;	// Shared buffers for all meshes
+		std::string shader_cache_directory_;	// Where program binaries are cached
+		std::string mesh_cache_directory_;	// Where optimized meshes are cached
+		bool parallel_compile_;	// Whether the driver compiles shaders on its own threads
+
+		// Shader program that was submitted to the driver but not checked yet
+		struct PendingMaterial
+		{
+			std::string name;
+			MaterialSource source;
+			GLuint vs, fs, gs;				// Shaders, 0 when unused or loaded from the cache
+			GLuint program;
+			bool use_cache;					// Whether the program binary cache is used
+			bool from_cache;				// Whether the program came from the cache
+			unsigned long long cache_key;
+		};
+		std::vector<PendingMaterial> pending_materials_;	// Programs waiting for FinishMaterials
  
         // Methods to load specific types of resources
 		void LoadMaterial(const std::string name, const char *prefix);	// Load shaders programs
-		std::string LoadTextFile(const char *filename);	 // Load a text file into memory (could be source code)
+		void SubmitProgram(PendingMaterial &pending);	// Compile and link from source without checking the status
+		static GLuint CompileShader(GLenum type, const std::string &source);
+		static std::string GetBuildLog(const PendingMaterial &pending);	// Logs of a program that failed to build
+		static std::string GetShaderLog(GLuint shader);
+		static std::string GetProgramLog(GLuint program);
+
+		// Program binary cache, keyed by a hash of the sources and the driver
+		bool ProgramCacheSupported(void) const;
+		static unsigned long long HashString(const std::string &str, unsigned long long hash);
+		static unsigned long long ProgramCacheKey(const MaterialSource &source);
+		bool LoadProgramBinary(const std::string name, unsigned long long key, GLuint &program);
+		void SaveProgramBinary(const std::string name, unsigned long long key, GLuint program);
+		// Mesh cache, keyed by a hash of the obj files
+		static bool LoadMeshCache(const std::string &filename, unsigned long long key, GeometryData &geometry);
+		static void SaveMeshCache(const std::string &filename, unsigned long long key, const GeometryData &geometry);
 		void LoadTexture(const std::string name, const char *filename);	// Load a texture
 		void LoadMesh(const std::string name, const char *filename);	// Loads a mesh in obj format
 		void LoadMeshParticles(std::string name, const char *filename, int num_particles = 20000); //Load a mesh with particles only
+		static VertexFormat PackVertexData(const GLfloat *vertex, GLsizei num_vertices, std::vector<unsigned char> &packed);	// Pack unpacked vertices in the smallest format
+		GLuint CreateVertexBuffer(const GLfloat *vertex, GLsizei num_vertices, VertexFormat &format, float &bounding_radius);	// Pack unpacked point set vertices in random order and copy them to a new array buffer
+		static float ComputeBoundingRadius(const GLfloat *vertex, GLsizei num_vertices);	// Distance of the farthest vertex from the origin
+		void AddMesh(const std::string name, const GLfloat *vertex, GLsizei num_vertices, const GLuint *face, GLsizei num_indices, const GLsizei *lod_size = NULL, int num_lods = 0);	// Add a mesh to the shared mesh buffers, with its levels of detail
 
     };// class ResourceManager
 }// namespace game
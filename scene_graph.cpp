@@ -8,19 +8,48 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "scene_graph.h"
+#include "profiler.h"
+#include "trace.h"
+#include "gl_calls.h"
 
 namespace game
 {
 	/* Constructors and Destructors */
-	SceneGraph::SceneGraph(void) { background_color_ = glm::vec3(0.0, 0.0, 0.0); }
+	SceneGraph::SceneGraph(void)
+	{
+		background_color_ = glm::vec3(0.0, 0.0, 0.0);
+		time_particles_ = false;
+		particle_time_ = 0;
+		particle_frames_ = 0;
+	}
+
 	SceneGraph::~SceneGraph() {}
 
 	/* Setters */
 	void SceneGraph::SetBackgroundColor(glm::vec3 color) { background_color_ = color; }
+	void SceneGraph::SetIndirectProgram(GLuint program, GLuint indirect_program) { indirect_.SetIndirectProgram(program, indirect_program); }
 	void SceneGraph::SetRoot(SceneNode *node) { root_ = node; }
 
+	void SceneGraph::SetParticleTiming(bool enabled)
+	{
+		if (enabled && PROFILER_ENABLED)
+		{
+			std::cout << "Timer queries cannot nest, particle draws are not timed while the profiler times the render passes" << std::endl;
+			return;
+		}
+		if (enabled && !(GLEW_VERSION_3_3 || GLEW_ARB_timer_query))
+		{
+			std::cout << "Timer queries are not supported, particle draws cannot be timed" << std::endl;
+			return;
+		}
+		time_particles_ = enabled;
+		particle_time_ = 0;
+		particle_frames_ = 0;
+	}
+
 	/* Getters */
 	glm::vec3 SceneGraph::GetBackgroundColor(void) const { return background_color_; }
+	bool SceneGraph::GetParticleTiming(void) const { return time_particles_; }
 
 	SceneNode *SceneGraph::GetNode(std::string node_name) const 
 	{
@@ -52,34 +81,91 @@ namespace game
 			background_color_[2], 0.0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		// Draw all scene nodes
-		// Initialize stack of nodes
-		std::stack<SceneNode *> stck;
-		stck.push(root_);
-		// Initialize stack of transformations
-		std::stack<glm::mat4> transf;
-		transf.push(glm::mat4(1.0));
-		// Traverse hierarchy
-		while (stck.size() > 0) {
-			// Get next node to be processed and pop it from the stack
-			SceneNode *current = stck.top();
-			stck.pop();
-			// Get transformation corresponding to the parent of the next node
-			glm::mat4 parent_transf = transf.top();
-			transf.pop();
-			// Draw node based on parent transformation
-			glm::mat4 current_transf = current->Draw(camera, parent_transf);
-			// Push children of the node to the stack, along with the node's
-			// transformation
-			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
-				it != current->children_end(); it++) {
-				stck.push(*it);
-				transf.push(current_transf);
+		// Resources may have been loaded since the last frame
+		SceneNode::ResetBufferBindings();
+
+		DrawScene(camera);
+	}
+
+	void SceneGraph::TransformScene(Camera *camera)
+	{
+		TRACE_SCOPE("scene_traversal");
+
+		// Transform pass: update matrices and collect the nodes to draw
+		draw_list_.clear();
+		if (!camera)
+		{
+			SceneNode::TransformHierarchy(root_, NULL);
+			return;
+		}
+
+		indirect_.Begin();
+		drawable_.clear();
+		SceneNode::TransformHierarchy(root_, &drawable_);
+		for (int i = 0; i < drawable_.size(); i++)
+		{
+			drawable_[i]->SelectLod(camera);
+			if (!indirect_.Add(drawable_[i])) { draw_list_.push_back(drawable_[i]); }
+		}
+	}
+
+	void SceneGraph::DrawScene(Camera *camera)
+	{
+		// Both ways of drawing a frame come through here; timer queries cannot nest, so only this pass is timed
+		PROFILE_SCOPE("scene");
+		PROFILE_GPU_SCOPE("scene");
+
+		TransformScene(camera);
+
+		// Opaque meshes in a few indirect calls, then everything else in scene order
+		TRACE_SCOPE("gl_submit");
+		indirect_.Submit(camera);
+		int num_queries = 0;
+		for (int i = 0; i < draw_list_.size(); i++)
+		{
+			bool timed = time_particles_ && draw_list_[i]->GetMode() == GL_POINTS;
+			if (timed)
+			{
+				if (num_queries == particle_queries_.size())
+				{
+					GLuint query;
+					glGenQueries(1, &query);
+					particle_queries_.push_back(query);
+				}
+				glBeginQuery(GL_TIME_ELAPSED, particle_queries_[num_queries]);
+			}
+			draw_list_[i]->DrawGeometry(camera);
+			if (timed)
+			{
+				glEndQuery(GL_TIME_ELAPSED);
+				num_queries++;
 			}
 		}
+		if (time_particles_) { ReportParticleTime(num_queries); }
+	}
+
+	void SceneGraph::ReportParticleTime(int num_queries)
+	{
+		// Waits for the GPU to finish the frame, timing is only turned on to measure
+		for (int i = 0; i < num_queries; i++)
+		{
+			GLuint64 elapsed;
+			glGetQueryObjectui64v(particle_queries_[i], GL_QUERY_RESULT, &elapsed);
+			particle_time_ += elapsed;
+		}
+
+		particle_frames_++;
+		if (particle_frames_ == PARTICLE_TIMING_FRAMES)
+		{
+			std::cout << "Particle draws: " << particle_time_ / 1.0e6 / particle_frames_ << " ms per frame on the GPU" << std::endl;
+			particle_time_ = 0;
+			particle_frames_ = 0;
+		}
 	}
 
 	/* Update */
+	void SceneGraph::UpdateTransforms(void) { TransformScene(NULL); }
+
 	void SceneGraph::Update(void) 
 	{
 		// Traverse hierarchy to update all nodes and delete ones that need to be deleted
@@ -107,7 +193,7 @@ namespace game
 
 		// Set up target texture for rendering
 		glGenTextures(1, &texture_);
-		glBindTexture(GL_TEXTURE_2D, texture_);
+		Gl::BindTexture(GL_TEXTURE_2D, texture_);
 
 		// Set up an image for the texture
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, FRAME_BUFFER_WIDTH, FRAME_BUFFER_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
@@ -145,7 +231,7 @@ namespace game
 
 		// Create buffer for quad
 		glGenBuffers(1, &quad_array_buffer_);
-		glBindBuffer(GL_ARRAY_BUFFER, quad_array_buffer_);
+		Gl::BindBuffer(GL_ARRAY_BUFFER, quad_array_buffer_);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertex_data), quad_vertex_data, GL_STATIC_DRAW);
 	}
 
@@ -166,30 +252,11 @@ namespace game
 			background_color_[2], 0.0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// Resources may have been loaded since the last frame
+		SceneNode::ResetBufferBindings();
+
 		// Draw all scene nodes
-		std::stack<SceneNode *> stck;
-		stck.push(root_);
-		// Initialize stack of transformations
-		std::stack<glm::mat4> transf;
-		transf.push(glm::mat4(1.0));
-		// Traverse hierarchy
-		while (stck.size() > 0) {
-			// Get next node to be processed and pop it from the stack
-			SceneNode *current = stck.top();
-			stck.pop();
-			// Get transformation corresponding to the parent of the next node
-			glm::mat4 parent_transf = transf.top();
-			transf.pop();
-			// Draw node based on parent transformation
-			glm::mat4 current_transf = current->Draw(camera, parent_transf);
-			// Push children of the node to the stack, along with the node's
-			// transformation
-			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
-				it != current->children_end(); it++) {
-				stck.push(*it);
-				transf.push(current_transf);
-			}
-		}
+		DrawScene(camera);
 
 		// Reset frame buffer
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -201,15 +268,17 @@ namespace game
 
 	void SceneGraph::DisplayTexture(GLuint program) {
 
+		PROFILE_GPU_SCOPE("screen_space");
+
 		// Configure output to the screen
 		//glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glDisable(GL_DEPTH_TEST);
 
 		// Set up quad geometry
-		glBindBuffer(GL_ARRAY_BUFFER, quad_array_buffer_);
+		Gl::BindBuffer(GL_ARRAY_BUFFER, quad_array_buffer_);
 
 		// Select proper material (shader program)
-		glUseProgram(program);
+		Gl::UseProgram(program);
 
 		// Setup attributes of screen-space shader
 		GLint pos_att = glGetAttribLocation(program, "position");
@@ -223,16 +292,19 @@ namespace game
 		// Timer
 		GLint timer_var = glGetUniformLocation(program, "timer");
 		float current_time = glfwGetTime();
-		glUniform1f(timer_var, current_time);
+		Gl::Uniform1f(timer_var, current_time);
 
 		health_data.SetupShader(program);
+#ifdef ENABLE_PROFILER
+		Profiler::SetupShader(program);
+#endif
 
 		// Bind texture
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture_);
+		Gl::BindTexture(GL_TEXTURE_2D, texture_);
 
 		// Draw geometry
-		glDrawArrays(GL_TRIANGLES, 0, 6); // Quad: 6 coordinates
+		Gl::DrawArrays(GL_TRIANGLES, 0, 6); // Quad: 6 coordinates
 
 										  // Reset current geometry
 		glEnable(GL_DEPTH_TEST);
@@ -11,10 +11,14 @@
 #include "resource.h"
 #include "camera.h"
 #include "CameraNode.h"
+#include "indirect_renderer.h"
 
 #define FRAME_BUFFER_WIDTH 1920
 #define FRAME_BUFFER_HEIGHT 1080
 
+// Frames averaged for each report of the GPU time of the particle draws
+#define PARTICLE_TIMING_FRAMES 120
+
 namespace game {
 
     // Class that manages all the objects in a scene
@@ -38,6 +42,24 @@ namespace game {
 			//shader attribute for the health data
 			ShaderAttribute health_data;
 
+			// Opaque meshes drawn with multi-draw indirect
+			IndirectRenderer indirect_;
+			// Nodes with geometry this frame, then those of them drawn one by one
+			std::vector<SceneNode *> drawable_;
+			std::vector<SceneNode *> draw_list_;
+
+			// GPU time of the particle draws, to compare the ways of drawing them
+			bool time_particles_;
+			std::vector<GLuint> particle_queries_;		// One timer query per particle draw of a frame
+			GLuint64 particle_time_;					// Nanoseconds spent since the last report
+			int particle_frames_;						// Frames measured since the last report
+			void ReportParticleTime(int num_queries);	// Add the time of this frame's particle draws
+
+			// Transform all nodes, collecting the ones to draw when there is a camera
+			void TransformScene(Camera *camera);
+			// Transform all nodes, then draw them
+			void DrawScene(Camera *camera);
+
         public:
             SceneGraph(void);
             ~SceneGraph();
@@ -45,6 +67,13 @@ namespace game {
             // Background color
             void SetBackgroundColor(glm::vec3 color);
             glm::vec3 GetBackgroundColor(void) const;
+
+			// Draw nodes using program with indirect_program, a multi-draw indirect version of it
+			void SetIndirectProgram(GLuint program, GLuint indirect_program);
+
+			// Measure the GPU time of the particle draws and print it regularly
+			void SetParticleTiming(bool enabled);
+			bool GetParticleTiming(void) const;
             
             // Set root of the hierarchy
             void SetRoot(SceneNode *node);
@@ -56,6 +85,8 @@ namespace game {
 
             // Update entire scene
             void Update(void);
+            // Compute the positions and matrices of all nodes without drawing, no OpenGL calls
+            void UpdateTransforms(void);
 
 			// Setup the texture
 			void SetupDrawToTexture(void);
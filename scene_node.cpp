@@ -1,11 +1,13 @@
 #include <stdexcept>
 #define GLM_FORCE_RADIANS
-#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <stack>
 #include <time.h>
 
 #include "scene_node.h"
+#include "clock.h"
+#include "counters.h"
 
 namespace game
 {
@@ -30,8 +32,27 @@ namespace game
 			array_buffer_ = geometry->GetArrayBuffer();
 			element_array_buffer_ = geometry->GetElementArrayBuffer();
 			size_ = geometry->GetSize();
+			format_ = geometry->GetVertexFormat();
+			base_vertex_ = geometry->GetBaseVertex();
+			first_index_ = geometry->GetFirstIndex();
+
+			// Levels of detail
+			num_lods_ = geometry->GetNumLods();
+			for (int i = 0; i < num_lods_; i++)
+			{
+				lod_size_[i] = geometry->GetLodSize(i);
+				lod_first_index_[i] = geometry->GetLodFirstIndex(i);
+			}
+			bounding_radius_ = geometry->GetBoundingRadius();
+		}
+		else 
+		{ 
+			array_buffer_ = 0; 
+			num_lods_ = 1;
+			lod_size_[0] = 0;
+			bounding_radius_ = 0;
 		}
-		else { array_buffer_ = 0; }
+		lod_ = 0;
 
 		// Set material (shader program)
 		if (material)
@@ -39,8 +60,9 @@ namespace game
 			if (material->GetType() != Material) { throw(std::invalid_argument(std::string("Invalid type of material"))); }
 
 			material_ = material->GetResource();
+			quad_particles_ = material->GetQuadParticles();
 		}
-		else { material_ = 0; }
+		else { material_ = 0; quad_particles_ = false; }
 
 		// Set texture
 		if (texture) { texture_ = texture->GetResource(); }
@@ -50,11 +72,13 @@ namespace game
 		scale_ = glm::vec3(1.0, 1.0, 1.0);
 		blending_ = false;
 		visible_ = true;
+		merged_ = false;
+		instance_count_ = 1;
 
 		// Hierarchy
 		parent_ = NULL;
 
-		start_time_ = glfwGetTime();
+		start_time_ = Clock::GetTime();
 	}
 
 	/* Destructor */
@@ -70,7 +94,17 @@ namespace game
 	GLuint SceneNode::GetElementArrayBuffer(void) const     { return element_array_buffer_; }
 	GLsizei SceneNode::GetSize(void) const				    { return size_; }
 	GLuint SceneNode::GetMaterial(void) const			    { return material_; }
+	GLuint SceneNode::GetTexture(void) const			    { return texture_; }
+	GLint SceneNode::GetBaseVertex(void) const			    { return base_vertex_; }
+	GLsizei SceneNode::GetFirstIndex(void) const		    { return first_index_; }
+	const VertexFormat &SceneNode::GetVertexFormat(void) const { return format_; }
+	const glm::mat4 &SceneNode::GetWorldMatrix(void) const  { return world_matrix_; }
+	const glm::mat4 &SceneNode::GetNormalMatrix(void) const { return normal_matrix_; }
+	bool SceneNode::HasShaderAttributes(void) const		    { return !shader_att_.empty(); }
 	bool SceneNode::GetBlending(void) const					{ return blending_;  }
+	bool SceneNode::GetVisible(void) const					{ return visible_;  }
+	GLsizei SceneNode::GetFullSize(void) const				{ return lod_size_[0]; }
+	float SceneNode::GetBoundingRadius(void) const			{ return bounding_radius_; }
 	glm::vec3 SceneNode::getAbsolutePosition(void) const    { return absolutePosition; }
 	glm::vec3 SceneNode::getPrevAbsolutePosition(void) const { return prevAbsolutePosition; }
 	glm::quat SceneNode::getAbsoluteOrientation(void) const { return absoluteOrientation; }
@@ -81,6 +115,17 @@ namespace game
 	void SceneNode::SetScale(glm::vec3 scale) { scale_ = scale; }
 	void SceneNode::SetBlending(bool blending) { blending_ = blending; }
 	void SceneNode::SetVisible(bool visible) { visible_ = visible; }
+	void SceneNode::SetMerged(bool merged) { merged_ = merged; }
+
+	void SceneNode::SetArrayBuffer(GLuint array_buffer) { array_buffer_ = array_buffer; }
+
+	void SceneNode::SetDrawCount(GLsizei count)
+	{
+		if (mode_ != GL_POINTS) { return; }
+		size_ = (count < 0) ? 0 : ((count > lod_size_[0]) ? lod_size_[0] : count);
+	}
+
+	void SceneNode::SetInstanceCount(GLsizei count) { instance_count_ = count; }
 
 	/* Updaters */
 	void SceneNode::Translate(glm::vec3 trans) { position_ += trans; }
@@ -89,7 +134,8 @@ namespace game
 
 	/* Update a SceneNode */
 	void SceneNode::update(void) {}
-	void SceneNode::updateTime(void) { start_time_ = glfwGetTime(); }
+	void SceneNode::updateTime(void) { start_time_ = Clock::GetTime(); }
+	double SceneNode::GetStartTime(void) const { return start_time_; }
 
 	/* Iterators */
 	std::vector<SceneNode *>::const_iterator SceneNode::children_begin() const { return children_.begin(); }
@@ -133,8 +179,8 @@ namespace game
 		}
 	}
 
-	/* Draw */
-	glm::mat4 SceneNode::Draw(Camera *camera, glm::mat4 parent_transf)
+	/* Transform pass: compute the matrices of the node, without any OpenGL calls */
+	glm::mat4 SceneNode::UpdateTransform(glm::mat4 parent_transf)
 	{
 		if (!visible_) return parent_transf;
 		maintainChildren(); // Check children for deletion
@@ -147,45 +193,19 @@ namespace game
 			absoluteOrientation = parent_->getAbsoluteOrientation() * GetOrientation();
 		}
 
-		// Select blending or not
-		if (blending_) {
-			// Disable z-buffer
-			glDisable(GL_DEPTH_TEST);
-			
-			// Enable blending
-			glEnable(GL_BLEND);
-			//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Simpler form
-			glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			glBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
-		}
-		else {
-			// Enable z-buffer
-			glEnable(GL_DEPTH_TEST);
-			glDisable(GL_BLEND);
-			glDepthFunc(GL_LESS);
-		}
-
 		if ((array_buffer_ > 0) && (material_ > 0)) 
 		{
-			// Select proper material (shader program)
-			glUseProgram(material_);
-
-			// Set geometry to draw
-			glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer_);
-
-			// Set globals for camera
-			camera->SetupShader(material_);
-
-			// Set world matrix and other shader input variables
-			glm::mat4 transf = SetupShader(material_, parent_transf);
-
-			for (int i = 0; i < shader_att_.size(); i++){ shader_att_[i].SetupShader(material_); }
+			// World transformation
+			glm::mat4 scaling = glm::scale(glm::mat4(1.0), scale_);
+			glm::mat4 rotation = glm::mat4_cast(orientation_);
+			glm::mat4 translation = glm::translate(glm::mat4(1.0), position_);
+			glm::mat4 transf = parent_transf * translation * rotation;
+			world_matrix_ = transf * scaling;
 
-			// Draw geometry
-			if (mode_ == GL_POINTS) { glDrawArrays(mode_, 0, size_); }
-			else { glDrawElements(mode_, size_, GL_UNSIGNED_INT, 0); }
+			// Normal matrix
+			normal_matrix_ = glm::transpose(glm::inverse(transf));
 
+			// Return transformation of node combined with parent, without scaling
 			return transf;
 		}
 		else
@@ -199,63 +219,76 @@ namespace game
 		}
 	}
 
-	/* Setup for the shader */
-	glm::mat4 SceneNode::SetupShader(GLuint program, glm::mat4 parent_transf)
+	/* Transform pass over a hierarchy, without OpenGL calls */
+	void SceneNode::TransformHierarchy(SceneNode *root, std::vector<SceneNode *> *drawable)
 	{
-		// Set attributes for shaders
-		GLint vertex_att = glGetAttribLocation(program, "vertex");
-		glVertexAttribPointer(vertex_att, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), 0);
-		glEnableVertexAttribArray(vertex_att);
-
-		GLint normal_att = glGetAttribLocation(program, "normal");
-		glVertexAttribPointer(normal_att, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(normal_att);
-
-		GLint color_att = glGetAttribLocation(program, "color");
-		glVertexAttribPointer(color_att, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void *)(6 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(color_att);
-
-		GLint tex_att = glGetAttribLocation(program, "uv");
-		glVertexAttribPointer(tex_att, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void *)(9 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(tex_att);
-
-		// World transformation
-		glm::mat4 scaling = glm::scale(glm::mat4(1.0), scale_);
-		glm::mat4 rotation = glm::mat4_cast(orientation_);
-		glm::mat4 translation = glm::translate(glm::mat4(1.0), position_);
-		glm::mat4 transf = parent_transf * translation * rotation;
-		glm::mat4 local_transf = transf * scaling;
-
-		GLint world_mat = glGetUniformLocation(program, "world_mat");
-		glUniformMatrix4fv(world_mat, 1, GL_FALSE, glm::value_ptr(local_transf));
-
-		// Normal matrix
-		glm::mat4 normal_matrix = glm::transpose(glm::inverse(transf));
-		GLint normal_mat = glGetUniformLocation(program, "normal_mat");
-		glUniformMatrix4fv(normal_mat, 1, GL_FALSE, glm::value_ptr(normal_matrix));
-
-		// Texture
-		if (texture_) 
+		// Initialize stack of nodes
+		std::stack<SceneNode *> stck;
+		stck.push(root);
+		// Initialize stack of transformations
+		std::stack<glm::mat4> transf;
+		transf.push(glm::mat4(1.0));
+		int visited = 0, drawn = 0;
+		// Traverse hierarchy
+		while (stck.size() > 0) {
+			// Get next node to be processed and pop it from the stack
+			SceneNode *current = stck.top();
+			stck.pop();
+			// Get transformation corresponding to the parent of the next node
+			glm::mat4 parent_transf = transf.top();
+			transf.pop();
+			// Transform node based on parent transformation
+			glm::mat4 current_transf = current->UpdateTransform(parent_transf);
+			visited++;
+			if (drawable && current->IsDrawable())
+			{
+				drawable->push_back(current);
+				drawn++;
+			}
+			// Push children of the node to the stack, along with the node's
+			// transformation
+			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
+				it != current->children_end(); it++) {
+				stck.push(*it);
+				transf.push(current_transf);
+			}
+		}
+
+		// Nodes skipped by a pass that draws are culled: hidden, merged into another node or without geometry
+		Counters::Add(CounterNodesVisited, visited);
+		if (drawable)
 		{
-			GLint tex = glGetUniformLocation(program, "texture_map");
-			glUniform1i(tex, 0);							// Assign the first texture to the map
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, texture_);			// First texture we bind
-															// Define texture interpolation
-			glGenerateMipmap(GL_TEXTURE_2D);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			Counters::Add(CounterNodesDrawn, drawn);
+			Counters::Add(CounterNodesCulled, visited - drawn);
 		}
+	}
+
+	/* Choose the level of detail from the size of the node on screen, after the transform pass */
+	void SceneNode::SelectLod(const Camera *camera)
+	{
+		if (num_lods_ <= 1) { return; }
 
-		// Timer
-		GLint timer_var = glGetUniformLocation(program, "timer");
-		double current_time = glfwGetTime() - start_time_;
-		glUniform1f(timer_var, (float)current_time);
+		// Radius of the bounding sphere in pixels
+		glm::vec3 center = glm::vec3(world_matrix_[3].x, world_matrix_[3].y, world_matrix_[3].z);
+		float distance = glm::length(center - camera->GetPosition());
+		float radius = bounding_radius_ * glm::max(scale_.x, glm::max(scale_.y, scale_.z));
+		float pixels = (distance > radius) ? radius * camera->GetPixelScale() / distance : LOD_FULL_DETAIL_PIXELS;
 
-		// Return transformation of node combined with parent, without scaling
-		return transf;
+		// Level k is for nodes smaller than LOD_FULL_DETAIL_PIXELS / 2^(k - 1)
+		// Only switch once the size is well past the threshold, so nodes near it do not pop back and forth
+		while (lod_ > 0 && pixels > LOD_FULL_DETAIL_PIXELS / (1 << (lod_ - 1)) * (1.0 + LOD_HYSTERESIS)) { lod_--; }
+		while (lod_ < num_lods_ - 1 && pixels < LOD_FULL_DETAIL_PIXELS / (1 << lod_) * (1.0 - LOD_HYSTERESIS)) { lod_++; }
+
+		size_ = lod_size_[lod_];
+		first_index_ = lod_first_index_[lod_];
 	}
 
+	/* Whether the node has geometry to draw this frame */
+	bool SceneNode::IsDrawable(void) const { return visible_ && !merged_ && (instance_count_ > 0) && (array_buffer_ > 0) && (material_ > 0); }
+
+	/* Setup for the shader, the variables common to all nodes are set by DrawGeometry */
+	void SceneNode::SetupShader(GLuint program) {}
+
 	void SceneNode::AddShaderAttribute(std::string name, DataType type, int size, GLfloat *data) {
 
 		ShaderAttribute att(name, type, size, data);
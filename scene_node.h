@@ -3,9 +3,7 @@
 
 #include <string>
 #include <vector>
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "gl_types.h"
 #include <glm/glm.hpp>
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/quaternion.hpp>
@@ -14,6 +12,12 @@
 #include "camera.h"
 #include "shader_attribute.h"
 
+// Projected radius in pixels below which meshes switch to their first simplified level;
+// each further level is used below half the size of the previous one
+#define LOD_FULL_DETAIL_PIXELS 200.0
+// Fraction of a threshold a node must move past before the level changes
+#define LOD_HYSTERESIS 0.15
+
 namespace game {
 
     // Class that manages one object in a scene 
@@ -41,7 +45,18 @@ namespace game {
 			GLuint GetElementArrayBuffer(void) const;
 			GLsizei GetSize(void) const;
 			GLuint GetMaterial(void) const;
+			GLuint GetTexture(void) const;
+			GLint GetBaseVertex(void) const;
+			GLsizei GetFirstIndex(void) const;
+			const VertexFormat &GetVertexFormat(void) const;
+			const glm::mat4 &GetWorldMatrix(void) const;		// World matrix from the last transform pass, with scaling
+			const glm::mat4 &GetNormalMatrix(void) const;		// Normal matrix from the last transform pass
+			bool HasShaderAttributes(void) const;
 			bool GetBlending(void) const;
+			bool GetVisible(void) const;
+			GLsizei GetFullSize(void) const;				// Number of primitives at full detail
+			float GetBoundingRadius(void) const;			// Radius of the geometry around its origin, without scaling
+			double GetStartTime(void) const;				// Time the effects of the node started, see updateTime
 
             // Set node attributes
             void SetPosition(glm::vec3 position);
@@ -49,14 +64,25 @@ namespace game {
             void SetScale(glm::vec3 scale);
 			void SetBlending(bool blending);
 			void SetVisible(bool visible);
+			void SetArrayBuffer(GLuint array_buffer);	// Draw from another buffer with the same layout, for geometry updated on the GPU
+			void SetDrawCount(GLsizei count);	// Draw only the first count points of a point set
+			void SetMerged(bool merged);		// Whether another node draws this one as part of a merged mesh
+			void SetInstanceCount(GLsizei count);	// Number of copies drawn in one call, the shaders place them by gl_InstanceID
             
             // Perform transformations on node
             void Translate(glm::vec3 trans);
             void Rotate(glm::quat rot);
             void Scale(glm::vec3 scale);
 
-            virtual glm::mat4 Draw(Camera *camera, glm::mat4 parent_transf);	 // Draw the node according to scene parameters in 'camera'
+            glm::mat4 Draw(Camera *camera, glm::mat4 parent_transf);	 // Draw the node according to scene parameters in 'camera'
+            glm::mat4 UpdateTransform(glm::mat4 parent_transf);	// Compute the matrices of the node; returns its transformation without scaling
+            bool IsDrawable(void) const;						// Whether the node has geometry to draw
+            void DrawGeometry(Camera *camera);					// Draw the node with the matrices of the last UpdateTransform
+            static void SetupAttributes(GLuint program, const VertexFormat &format, GLuint divisor = 0);	// Point the attributes of a program at vertices in this format
             virtual void update(void);		// Update the node
+            void SelectLod(const Camera *camera);				// Choose the level of detail for the matrices of the last UpdateTransform
+            static void ResetBufferBindings(void);	// Call before drawing when other code bound buffers
+            static void TransformHierarchy(SceneNode *root, std::vector<SceneNode *> *drawable);	// Update the matrices of root and everything below it, adding the nodes to draw to drawable unless it is NULL
 
 			//for starting the animation
 			void updateTime(void);
@@ -71,12 +97,26 @@ namespace game {
 			void AddShaderAttribute(std::string name, DataType type, int size, GLfloat *data);
 			void RemoveShaderAttribute(std::string name);
 			void ClearShaderAttributes(void);
+        protected:
+            // Set the variables of derived nodes in a shader program, after the ones common to all nodes
+            virtual void SetupShader(GLuint program);
+
         private:
             std::string name_; // Name of the scene node
             GLuint array_buffer_; // References to geometry: vertex and array buffers
             GLuint element_array_buffer_;
             GLenum mode_; // Type of geometry
             GLsizei size_; // Number of primitives in geometry
+            VertexFormat format_; // Layout of the vertices in the array buffer
+            GLint base_vertex_; // First vertex of the geometry in the array buffer
+            GLsizei first_index_; // First index of the geometry in the element array buffer
+            int num_lods_; // Levels of detail of the geometry
+            int lod_; // Level of detail drawn, size_ and first_index_ point at its indices
+            GLsizei lod_size_[MAX_LOD_LEVELS]; // Number of indices in each level
+            GLsizei lod_first_index_[MAX_LOD_LEVELS]; // First index of each level
+            float bounding_radius_; // Radius of the geometry around its origin
+            static GLuint bound_array_buffer_; // Buffers bound by the last draw
+            static GLuint bound_element_array_buffer_;
             GLuint material_; // Reference to shader program
 			GLuint texture_; // Reference to texture
             glm::vec3 position_; // Relative Position of node
@@ -87,6 +127,11 @@ namespace game {
             glm::vec3 scale_; // Scale of node
 			bool blending_; //blending
 			bool visible_; //draw or not
+			bool merged_; //drawn by a merged node, only the matrices are computed
+			GLsizei instance_count_; //copies of the geometry drawn by each call
+			bool quad_particles_; //points drawn as instanced quads instead of by a geometry program
+			static GLuint quad_corner_buffer_; //corners of the quads
+			static std::vector<GLint> divided_attributes_; //attributes given a divisor by SetupAttributes, reset by DrawQuads
 			double start_time_; //start time for effects
 			
             // Hierarchy
@@ -94,10 +139,11 @@ namespace game {
             std::vector<SceneNode *> children_;		//children of the sceneNode
 
 			std::vector<ShaderAttribute> shader_att_; // Shader attributes
-            // Set matrices that transform the node in a shader program
-            // Return transformation of current node combined with
-            // parent transformation, without including scaling
-            glm::mat4 SetupShader(GLuint program, glm::mat4 parent_transf);
+            glm::mat4 world_matrix_; // World matrix of the last transform pass
+            glm::mat4 normal_matrix_; // Normal matrix of the last transform pass
+
+			void SetupCommonShader(GLuint program);	//set attributes, matrices and other variables of the node in a shader program
+			void DrawQuads(void);					//draw each point as an instanced quad
 			void maintainChildren();				//deletes nodes that need to be deleted from the graph before drawing them
     }; // class SceneNode
 } // namespace game
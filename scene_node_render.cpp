@@ -0,0 +1,179 @@
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "scene_node.h"
+#include "clock.h"
+#include "gl_calls.h"
+
+// Drawing of the scene nodes, built into the renderer library; the transformations
+// and hierarchy in scene_node.cpp are part of the simulation core
+namespace game
+{
+	/* Buffers bound by the last draw */
+	GLuint SceneNode::bound_array_buffer_ = 0;
+	GLuint SceneNode::bound_element_array_buffer_ = 0;
+
+	/* Corners of the quad drawn for each particle, created with the first one */
+	GLuint SceneNode::quad_corner_buffer_ = 0;
+	std::vector<GLint> SceneNode::divided_attributes_;
+
+	/* Forget the bound buffers, when other code may have bound its own */
+	void SceneNode::ResetBufferBindings(void)
+	{
+		bound_array_buffer_ = 0;
+		bound_element_array_buffer_ = 0;
+	}
+
+	/* Draw */
+	glm::mat4 SceneNode::Draw(Camera *camera, glm::mat4 parent_transf)
+	{
+		glm::mat4 transf = UpdateTransform(parent_transf);
+		if (IsDrawable()) { DrawGeometry(camera); }
+		return transf;
+	}
+
+	/* Draw pass: draw the node with the matrices of the last transform pass */
+	void SceneNode::DrawGeometry(Camera *camera)
+	{
+		// Select blending or not
+		if (blending_) {
+			// Disable z-buffer
+			glDisable(GL_DEPTH_TEST);
+			
+			// Enable blending
+			glEnable(GL_BLEND);
+			//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Simpler form
+			glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
+		}
+		else {
+			// Enable z-buffer
+			glEnable(GL_DEPTH_TEST);
+			glDisable(GL_BLEND);
+			glDepthFunc(GL_LESS);
+		}
+
+		// Select proper material (shader program)
+		Gl::UseProgram(material_);
+
+		// Set geometry to draw, meshes share their buffers so most draws skip this
+		if (array_buffer_ != bound_array_buffer_)
+		{
+			Gl::BindBuffer(GL_ARRAY_BUFFER, array_buffer_);
+			bound_array_buffer_ = array_buffer_;
+		}
+		if (element_array_buffer_ != bound_element_array_buffer_)
+		{
+			Gl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer_);
+			bound_element_array_buffer_ = element_array_buffer_;
+		}
+
+		// Set globals for camera
+		camera->SetupShader(material_);
+
+		// Set world matrix and other shader input variables, then those of derived nodes
+		SetupCommonShader(material_);
+		SetupShader(material_);
+
+		for (int i = 0; i < shader_att_.size(); i++){ shader_att_[i].SetupShader(material_); }
+
+		// Draw geometry
+		if (quad_particles_ && mode_ == GL_POINTS) { DrawQuads(); }
+		else if (instance_count_ > 1)
+		{
+			if (mode_ == GL_POINTS) { Gl::DrawArraysInstanced(mode_, 0, size_, instance_count_); }
+			else { Gl::DrawElementsInstancedBaseVertex(mode_, size_, GL_UNSIGNED_INT, (void *)(first_index_ * sizeof(GLuint)), instance_count_, base_vertex_); }
+		}
+		else if (mode_ == GL_POINTS) { Gl::DrawArrays(mode_, 0, size_); }
+		else { Gl::DrawElementsBaseVertex(mode_, size_, GL_UNSIGNED_INT, (void *)(first_index_ * sizeof(GLuint)), base_vertex_); }
+	}
+
+	/* Draw each point as a quad of four vertices, the attributes of the points advance once per quad */
+	void SceneNode::DrawQuads(void)
+	{
+		if (!quad_corner_buffer_)
+		{
+			GLfloat corner[] = { 0.0, 0.0,  1.0, 0.0,  0.0, 1.0,  1.0, 1.0 };	// Triangle strip
+			glGenBuffers(1, &quad_corner_buffer_);
+			Gl::BindBuffer(GL_ARRAY_BUFFER, quad_corner_buffer_);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(corner), corner, GL_STATIC_DRAW);
+		}
+		else { Gl::BindBuffer(GL_ARRAY_BUFFER, quad_corner_buffer_); }
+		bound_array_buffer_ = quad_corner_buffer_;
+
+		// Bound to location 0 when the program is linked
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+		glVertexAttribDivisor(0, 0);
+		glEnableVertexAttribArray(0);
+
+		// One call for every instance, gl_InstanceID is particle * instance_count_ + instance
+		Gl::DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, size_ * instance_count_);
+
+		// Code drawing without SetupAttributes expects no divisors
+		glDisableVertexAttribArray(0);
+		for (int i = 0; i < divided_attributes_.size(); i++)
+		{
+			glVertexAttribDivisor(divided_attributes_[i], 0);
+		}
+		divided_attributes_.clear();
+	}
+
+	/* Set the attributes of a program to read vertices in the given format */
+	void SceneNode::SetupAttributes(GLuint program, const VertexFormat &format, GLuint divisor)
+	{
+		for (int i = 0; i < NumVertexAttributes; i++)
+		{
+			const VertexAttributeFormat &att = format.attribute[i];
+			GLint location = glGetAttribLocation(program, GetVertexAttributeName((VertexAttributeType)i));
+			if (location < 0) { continue; }	// Not used by this shader
+
+			if (att.enabled)
+			{
+				glVertexAttribPointer(location, att.size, att.type, att.normalized, format.stride, (void *)(size_t)att.offset);
+				glVertexAttribDivisor(location, divisor);
+				glEnableVertexAttribArray(location);
+				if (divisor) { divided_attributes_.push_back(location); }	// Reset after the draw
+			}
+			else
+			{
+				// Attribute is not stored, give every vertex the same value
+				glDisableVertexAttribArray(location);
+				glVertexAttrib4fv(location, att.constant);
+			}
+		}
+	}
+
+	/* Setup for the shader, variables used by every node */
+	void SceneNode::SetupCommonShader(GLuint program)
+	{
+		// Set attributes for shaders, following the layout of the geometry
+		// Points drawn as quads read one vertex per quad, repeated for each instance
+		SetupAttributes(program, format_, (quad_particles_ && mode_ == GL_POINTS) ? instance_count_ : 0);
+
+		// World transformation
+		GLint world_mat = glGetUniformLocation(program, "world_mat");
+		Gl::UniformMatrix4fv(world_mat, 1, GL_FALSE, glm::value_ptr(world_matrix_));
+
+		// Normal matrix
+		GLint normal_mat = glGetUniformLocation(program, "normal_mat");
+		Gl::UniformMatrix4fv(normal_mat, 1, GL_FALSE, glm::value_ptr(normal_matrix_));
+
+		// Texture
+		if (texture_) 
+		{
+			GLint tex = glGetUniformLocation(program, "texture_map");
+			Gl::Uniform1i(tex, 0);							// Assign the first texture to the map
+			glActiveTexture(GL_TEXTURE0);
+			Gl::BindTexture(GL_TEXTURE_2D, texture_);			// First texture we bind, mipmaps and filtering are set when it is created
+		}
+
+		// Timer
+		GLint timer_var = glGetUniformLocation(program, "timer");
+		double current_time = Clock::GetTime() - start_time_;
+		Gl::Uniform1f(timer_var, (float)current_time);
+
+		// Particle shaders use their own matrices and timer unless the node draws instances
+		GLint num_instances_var = glGetUniformLocation(program, "num_instances");
+		Gl::Uniform1i(num_instances_var, 0);
+	}
+} // namespace game
@@ -7,6 +7,9 @@ in vec2 uv0;
 uniform float timer;
 uniform sampler2D texture_map;
 uniform vec3 health[1];
+// Rolling averages of the profiler scopes: milliseconds, then 1 for GPU scopes
+uniform vec4 profile[32];
+uniform int num_profile;
 
 void main() 
 {
@@ -21,5 +24,17 @@ void main()
 		pixel[0] = 1.0;
 	}
 
+	// Profiler overlay, one bar per scope from the top left corner, a full bar is a 60 Hz frame
+	float row = (0.98 - pos.y) / 0.015;
+	if (pos.x > 0.02 && pos.x < 0.42 && row > 0.0 && int(row) < num_profile)
+	{
+		vec4 scope = profile[int(row)];
+		pixel.rgb *= 0.4;
+		if (fract(row) < 0.75 && pos.x - 0.02 < 0.4 * min(scope.x / 16.667, 1.0))
+		{
+			pixel.rgb = (scope.y > 0.5) ? vec3(1.0, 0.6, 0.1) : vec3(0.2, 0.9, 0.3);
+		}
+	}
+
     gl_FragColor = pixel;
 }
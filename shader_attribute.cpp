@@ -45,20 +45,4 @@ void ShaderAttribute::SetData(GLfloat *data) {
 	data_ = data;
 }
 
-void ShaderAttribute::SetupShader(GLuint program){
-
-    // Set data in the shader
-    GLint location = glGetUniformLocation(program, name_.c_str());
-
-    if (type_ == FloatType){
-        glUniform3fv(location, size_, data_);
-    } else if (type_ == Vec2Type){
-        glUniform2fv(location, size_ / 2, data_);
-    } else if (type_ == Vec3Type){
-        glUniform3fv(location, size_ / 3, data_);
-    } else if (type_ == Vec4Type){
-        glUniform4fv(location, size_ / 4, data_);
-    }
-}
-
 } // namespace game
@@ -0,0 +1,23 @@
+#include "shader_attribute.h"
+#include "gl_calls.h"
+
+// Shader setup of the attributes, built into the renderer library
+namespace game {
+
+void ShaderAttribute::SetupShader(GLuint program){
+
+    // Set data in the shader
+    GLint location = glGetUniformLocation(program, name_.c_str());
+
+    if (type_ == FloatType){
+        Gl::Uniform3fv(location, size_, data_);
+    } else if (type_ == Vec2Type){
+        Gl::Uniform2fv(location, size_ / 2, data_);
+    } else if (type_ == Vec3Type){
+        Gl::Uniform3fv(location, size_ / 3, data_);
+    } else if (type_ == Vec4Type){
+        Gl::Uniform4fv(location, size_ / 4, data_);
+    }
+}
+
+} // namespace game
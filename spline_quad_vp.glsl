@@ -0,0 +1,87 @@
+#version 400
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 normal;
+in vec3 color;
+in vec2 corner; // Corner of the quad, the same four vertices for every particle
+
+// Uniform (global) buffer
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+uniform int num_instances = 1; // Webs drawn by the call
+uniform vec3 up_vec;
+
+// Webs drawn together by the web batch, with the spline they follow
+#define MAX_WEB_INSTANCES 64
+layout(std140) uniform WebBatch
+{
+    vec4 control_point[64];
+    mat4 web_world_mat[MAX_WEB_INSTANCES];
+    vec4 web_timer[MAX_WEB_INSTANCES]; // Only x is used
+};
+
+// Attributes passed to the fragment shader
+out vec4 frag_color;
+out vec2 tex_coord;
+
+// Attributes of the particle, expanded to the quad below
+float particle_id;
+vec4 particle_color;
+
+// Size of the quad in camera space
+float particle_size = 0.1;
+
+// Define some useful constants
+const float pi = 3.1415926536;
+const float pi_over_two = 1.5707963268;
+const float two_pi = 2.0*pi;
+
+
+void main()
+{   
+    // Every web is drawn by the same call, each particle once per web
+    int instance_index = gl_InstanceID % max(num_instances, 1);
+
+    // Transformation and timer of the web
+    mat4 world_mat = web_world_mat[instance_index];
+    float timer = web_timer[instance_index].x;
+
+    // Define particle id
+    particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
+
+    // The phase of the particle repeats in a cyclic manner and is dependent of the particle id
+    float phase = two_pi*particle_id;
+    float circtime = mod((timer * 12 + phase), 16.0); // A cycle lasts 16 seconds
+    
+    // Change position of the particle based on a spline
+    vec3 position = vertex;
+    float t = circtime - floor(circtime); // Fractional part, 0-1
+    // Spline evaluation
+    float p1w = (1 - t)*(1 - t)*(1 - t);
+    float p2w = 3 * t*(1 - t)*(1 - t);
+    float p3w = 3 * t*t*(1 - t);
+    float p4w = t*t*t; 
+    int wsec = int(floor(circtime))*4; // Picks which set of control points are used           
+    vec3 Bt = p1w*control_point[0+wsec].xyz + p2w*control_point[1+wsec].xyz + p3w*control_point[2+wsec].xyz + p4w*control_point[3+wsec].xyz;
+    position += Bt;
+
+    // Transform new position
+    vec4 out_position = view_mat * world_mat * vec4(position, 1.0);
+    gl_Position = out_position;
+
+	float alpha;
+	if (mod((timer * 1000) , 1000) > 880)
+		alpha = 0;
+	else if (mod((timer * 1000) , 300) > 150 && mod((timer * 1000) , 300) < 230)
+		alpha = 0;
+	else
+		alpha = 1;
+
+    particle_color = vec4(color, alpha);
+
+    // Move to the corner of the quad in camera space, as the geometry shader does
+    gl_Position = projection_mat * (gl_Position + vec4((corner - 0.5) * particle_size, 0.0, 0.0));
+    tex_coord = vec2(corner.y, corner.x);
+    frag_color = vec4(vec3(0, 0, 0), particle_color.a);
+}
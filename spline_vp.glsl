@@ -6,12 +6,18 @@ in vec3 normal;
 in vec3 color;
 
 // Uniform (global) buffer
-uniform mat4 world_mat;
 uniform mat4 view_mat;
-uniform float timer;
-uniform vec3 control_point[64];
 uniform vec3 up_vec;
 
+// Webs drawn together by the web batch, with the spline they follow
+#define MAX_WEB_INSTANCES 64
+layout(std140) uniform WebBatch
+{
+    vec4 control_point[64];
+    mat4 web_world_mat[MAX_WEB_INSTANCES];
+    vec4 web_timer[MAX_WEB_INSTANCES]; // Only x is used
+};
+
 // Attributes forwarded to the geometry shader
 out float particle_id;
 out vec4 particle_color;
@@ -24,6 +30,10 @@ const float two_pi = 2.0*pi;
 
 void main()
 {   
+    // Transformation and timer of the web
+    mat4 world_mat = web_world_mat[gl_InstanceID];
+    float timer = web_timer[gl_InstanceID].x;
+
     // Define particle id
     particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
 
@@ -40,7 +50,7 @@ void main()
     float p3w = 3 * t*t*(1 - t);
     float p4w = t*t*t; 
     int wsec = int(floor(circtime))*4; // Picks which set of control points are used           
-    vec3 Bt = p1w*control_point[0+wsec] + p2w*control_point[1+wsec] + p3w*control_point[2+wsec] + p4w*control_point[3+wsec];
+    vec3 Bt = p1w*control_point[0+wsec].xyz + p2w*control_point[1+wsec].xyz + p3w*control_point[2+wsec].xyz + p4w*control_point[3+wsec].xyz;
     position += Bt;
 
     // Transform new position
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "stress_scene.h"
+
+// STRESS SCENE
+namespace game
+{
+	/* Constructor, the world of the normal game */
+	StressConfig::StressConfig(void)
+	{
+		num_humans = 5;
+		num_spiders = 5;
+		num_dragonflies = 5;
+		num_blocks = 7;
+		layout = SpawnRooms;
+		seed = 1;	// Same as never seeding rand
+		frames = STRESS_DEFAULT_FRAMES;
+		camera_speed = STRESS_DEFAULT_CAMERA_SPEED;
+		fire_interval = 0;
+	}
+
+	template <typename T> static T ParseStressValue(const std::string key, const std::string value)
+	{
+		std::istringstream in(value);
+		T result;
+		in >> result;
+		if (in.fail() || !in.eof()) { throw(std::invalid_argument(std::string("Invalid value ") + value + std::string(" for stress option ") + key)); }
+		return result;
+	}
+
+	void SetStressOption(StressConfig &config, const std::string key, const std::string value)
+	{
+		if (key == "humans") { config.num_humans = ParseStressValue<int>(key, value); }
+		else if (key == "spiders") { config.num_spiders = ParseStressValue<int>(key, value); }
+		else if (key == "dragonflies") { config.num_dragonflies = ParseStressValue<int>(key, value); }
+		else if (key == "blocks") { config.num_blocks = ParseStressValue<int>(key, value); }
+		else if (key == "seed") { config.seed = ParseStressValue<unsigned int>(key, value); }
+		else if (key == "frames") { config.frames = ParseStressValue<int>(key, value); }
+		else if (key == "camera_speed") { config.camera_speed = ParseStressValue<float>(key, value); }
+		else if (key == "fire_interval") { config.fire_interval = ParseStressValue<int>(key, value); }
+		else if (key == "csv") { config.csv = value; }
+		else if (key == "write_counters") { config.write_counters = value; }
+		else if (key == "check_counters") { config.check_counters = value; }
+		else if (key == "layout")
+		{
+			if (value == "rooms") { config.layout = SpawnRooms; }
+			else if (value == "grid") { config.layout = SpawnGrid; }
+			else if (value == "cluster") { config.layout = SpawnCluster; }
+			else { throw(std::invalid_argument(std::string("Invalid value ") + value + std::string(" for stress option layout"))); }
+		}
+		else { throw(std::invalid_argument(std::string("Unknown stress option ") + key)); }
+	}
+
+	// Files named in a config file are next to it, wherever the game is started from
+	static std::string ResolveStressPath(const std::string filename, const std::string path)
+	{
+		if (path.empty() || path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':')) { return path; }	// Absolute
+		std::string::size_type slash = filename.find_last_of("/\\");
+		if (slash == std::string::npos) { return path; }
+		return filename.substr(0, slash + 1) + path;
+	}
+
+	void LoadStressConfig(const std::string filename, StressConfig &config)
+	{
+		std::ifstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		std::string line;
+		while (std::getline(f, line))
+		{
+			line = line.substr(0, line.find('#'));
+			std::istringstream in(line);
+			std::string key, value;
+			if (!(in >> key)) { continue; }	// Empty line
+			if (!(in >> value)) { throw(std::invalid_argument(std::string("Missing value for stress option ") + key + std::string(" in ") + filename)); }
+			if (key == "csv" || key == "write_counters" || key == "check_counters") { value = ResolveStressPath(filename, value); }
+			SetStressOption(config, key, value);
+		}
+	}
+
+	glm::vec3 SpawnPosition(SpawnLayout layout, int type, int index, int count, float height)
+	{
+		if (layout == SpawnGrid)
+		{
+			// Square grid over the first room, the kinds of entities are shifted inside each cell
+			int side = (int)std::ceil(std::sqrt((float)count));
+			float cell = 500.0f / side;
+			float shift = cell * type / 4.0f;
+			return glm::vec3(-250.0f + cell * (index % side) + shift, height, -250.0f + cell * (index / side) + shift);
+		}
+		else if (layout == SpawnCluster)
+		{
+			// Everything in the middle of the first room, the worst case for the collisions
+			return glm::vec3(rand() % 120 - 60, height, rand() % 120 - 60);
+		}
+
+		// Random room, then random position in the room
+		if (rand() % 2 == 0)
+		{
+			int x = rand() % 500 - 250;
+			int z = rand() % 500 - 250;
+			return glm::vec3(x, height, z);
+		}
+		int x = rand() % 500 + 230;
+		int z = rand() % 500 - 850;
+		return glm::vec3(x, height, z);
+	}
+
+	/* Constructor */
+	StressCameraPath::StressCameraPath(void)
+	{
+		// Around the first room, through the second one and back
+		waypoint_.push_back(glm::vec3(-150, 0, 150));
+		waypoint_.push_back(glm::vec3(150, 0, 150));
+		waypoint_.push_back(glm::vec3(200, 0, -200));
+		waypoint_.push_back(glm::vec3(480, 0, -450));
+		waypoint_.push_back(glm::vec3(630, 0, -600));
+		waypoint_.push_back(glm::vec3(480, 0, -750));
+		waypoint_.push_back(glm::vec3(330, 0, -600));
+		waypoint_.push_back(glm::vec3(-150, 0, -150));
+
+		distance_.push_back(0.0f);
+		for (int i = 0; i < waypoint_.size(); i++)
+		{
+			distance_.push_back(distance_.back() + glm::length(waypoint_[(i + 1) % waypoint_.size()] - waypoint_[i]));
+		}
+	}
+
+	/* Destructor */
+	StressCameraPath::~StressCameraPath() {}
+
+	void StressCameraPath::GetPose(int frame, float speed, glm::vec3 &position, glm::vec3 &look_at) const
+	{
+		float s = std::fmod(frame * speed, distance_.back());
+		int i = 0;
+		while (distance_[i + 1] < s) { i++; }
+
+		glm::vec3 from = waypoint_[i];
+		glm::vec3 to = waypoint_[(i + 1) % waypoint_.size()];
+		float t = (s - distance_[i]) / (distance_[i + 1] - distance_[i]);
+		position = from + t * (to - from);
+		look_at = position + glm::normalize(to - from);
+	}
+
+	/* Constructor */
+	StressRecorder::StressRecorder(void) { enabled_ = false; }
+
+	/* Destructor */
+	StressRecorder::~StressRecorder() {}
+
+	void StressRecorder::SetEnabled(bool enabled) { enabled_ = enabled; }
+	bool StressRecorder::GetEnabled(void) const { return enabled_; }
+	int StressRecorder::GetNumFrames(void) const { return frames_.size(); }
+
+	void StressRecorder::EndFrame(const FrameTimer &timer, int humans, int spiders, int dragonflies, int projectiles)
+	{
+		if (!enabled_) { return; }
+		Frame frame;
+		for (int i = 0; i < NUM_FRAME_PHASES; i++) { frame.phase_time[i] = timer.GetPhaseTime((FramePhase)i); }
+		frame.humans = humans;
+		frame.spiders = spiders;
+		frame.dragonflies = dragonflies;
+		frame.projectiles = projectiles;
+		frames_.push_back(frame);
+	}
+
+	void StressRecorder::WriteCsv(const std::string filename) const
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		f << "frame";
+		for (int j = 0; j < NUM_FRAME_PHASES; j++) { f << "," << FrameTimer::GetPhaseName((FramePhase)j) << "_ms"; }
+		f << ",humans,spiders,dragonflies,projectiles" << std::endl;
+		f << std::fixed << std::setprecision(4);
+		for (int i = 0; i < frames_.size(); i++)
+		{
+			f << i;
+			for (int j = 0; j < NUM_FRAME_PHASES; j++) { f << "," << frames_[i].phase_time[j] * 1000.0; }
+			f << "," << frames_[i].humans << "," << frames_[i].spiders << "," << frames_[i].dragonflies << "," << frames_[i].projectiles << std::endl;
+		}
+	}
+
+	void StressRecorder::PrintSummary(std::ostream &out) const
+	{
+		if (frames_.empty()) { return; }
+
+		out << "Stress run of " << frames_.size() << " frames" << std::endl;
+		std::vector<double> time(frames_.size());
+		for (int j = 0; j < NUM_FRAME_PHASES; j++)
+		{
+			for (int i = 0; i < frames_.size(); i++) { time[i] = frames_[i].phase_time[j]; }
+			std::sort(time.begin(), time.end());
+			double median = time[time.size() / 2];
+			double p99 = time[(int)std::ceil(0.99 * time.size()) - 1];	// Nearest rank
+			out << std::left << std::setw(12) << FrameTimer::GetPhaseName((FramePhase)j) << std::right << std::fixed << std::setprecision(3)
+				<< "median " << std::setw(9) << median * 1000.0 << " ms   p99 " << std::setw(9) << p99 * 1000.0 << " ms" << std::endl;
+		}
+	}
+} // namespace game
@@ -0,0 +1,92 @@
+#ifndef STRESS_SCENE_H_
+#define STRESS_SCENE_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <glm/glm.hpp>
+
+#include "frame_timer.h"
+
+// Frames of a stress run when the configuration does not set them
+#define STRESS_DEFAULT_FRAMES 1800
+// Distance covered by the scripted camera each frame
+#define STRESS_DEFAULT_CAMERA_SPEED 2.0
+
+// STRESS SCENE
+// Scripted scenes for finding the entity counts where each part of the frame falls over:
+// entity counts and spawn layout, a camera path that only depends on the frame number,
+// and the time spent in each phase of every frame
+namespace game
+{
+	// Where the entities of a scene are spawned
+	typedef enum SpawnLayoutType { SpawnRooms, SpawnGrid, SpawnCluster } SpawnLayout;
+
+	// Configuration of the world, the defaults are the normal game
+	struct StressConfig
+	{
+		StressConfig(void);
+
+		int num_humans;
+		int num_spiders;
+		int num_dragonflies;
+		int num_blocks;
+		SpawnLayout layout;
+		unsigned int seed;		// Seed of the positions and of everything random in the game
+		int frames;				// Length of a stress run
+		float camera_speed;		// Distance covered by the scripted camera each frame
+		int fire_interval;		// Frames between the rockets fired by the scripted player, 0 never fires
+		std::string csv;		// Per-frame timings of a stress run, not written if empty
+		std::string write_counters;	// Counters of the run, written as a baseline if not empty
+		std::string check_counters;	// Baseline the counters of the run must not go over, not checked if empty
+	};
+
+	// Set one option from its name and value as text, for config files and command-line flags
+	void SetStressOption(StressConfig &config, const std::string key, const std::string value);
+	// Read "key value" lines, # starts a comment; relative file names are relative to the config file
+	void LoadStressConfig(const std::string filename, StressConfig &config);
+	// Position of entity index out of count, type separates the kinds of entities on a grid
+	glm::vec3 SpawnPosition(SpawnLayout layout, int type, int index, int count, float height);
+
+	// Closed loop through both rooms, followed at a constant speed
+	class StressCameraPath
+	{
+	public:
+		StressCameraPath(void);
+		~StressCameraPath();
+
+		void GetPose(int frame, float speed, glm::vec3 &position, glm::vec3 &look_at) const;
+
+	private:
+		std::vector<glm::vec3> waypoint_;
+		std::vector<float> distance_;	// Length of the path up to each waypoint
+	}; // class StressCameraPath
+
+	// Time of each phase of the frames of a stress run
+	class StressRecorder
+	{
+	public:
+		StressRecorder(void);
+		~StressRecorder();
+
+		void SetEnabled(bool enabled);		// Nothing is recorded until enabled
+		bool GetEnabled(void) const;
+		int GetNumFrames(void) const;
+
+		void EndFrame(const FrameTimer &timer, int humans, int spiders, int dragonflies, int projectiles);	// Store the frame with its entity counts
+
+		void WriteCsv(const std::string filename) const;
+		void PrintSummary(std::ostream &out) const;	// Median and p99 of each phase
+
+	private:
+		struct Frame
+		{
+			double phase_time[NUM_FRAME_PHASES];
+			int humans, spiders, dragonflies, projectiles;
+		};
+
+		bool enabled_;
+		std::vector<Frame> frames_;
+	}; // class StressRecorder
+} // namespace game
+#endif // STRESS_SCENE_H_
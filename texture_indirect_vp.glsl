@@ -0,0 +1,54 @@
+#version 430
+#extension GL_ARB_shader_draw_parameters : require
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 normal;
+in vec3 color;
+in vec2 uv;
+
+// Per-draw matrices, one entry per command of the multi-draw
+struct DrawData
+{
+    mat4 world_mat;
+    mat4 normal_mat;
+};
+
+layout(std430, binding = 0) buffer DrawBuffer
+{
+    DrawData draw[];
+};
+
+// Uniform (global) buffer
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+uniform int draw_offset; // Index of the first draw of this call
+
+// Attributes forwarded to the fragment shader
+out vec3 position_interp;
+out vec3 normal_interp;
+out vec4 color_interp;
+out vec2 uv_interp;
+out vec3 light_pos;
+
+// Material attributes (constants)
+uniform vec3 light_position = vec3(-0.5, 100, 10.5);
+
+
+void main()
+{
+    mat4 world_mat = draw[draw_offset + gl_DrawIDARB].world_mat;
+    mat4 normal_mat = draw[draw_offset + gl_DrawIDARB].normal_mat;
+
+    gl_Position = projection_mat * view_mat * world_mat * vec4(vertex, 1.0);
+
+    position_interp = vec3(view_mat * world_mat * vec4(vertex, 1.0));
+    
+    normal_interp = vec3(normal_mat * vec4(normal, 0.0));
+
+    color_interp = vec4(color, 1.0);
+
+    uv_interp = uv;
+
+    light_pos = vec3(view_mat * vec4(light_position, 1.0));
+}
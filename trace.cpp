@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "trace.h"
+
+// TRACE
+namespace game
+{
+	std::atomic<bool> Trace::recording_(false);
+	int Trace::frames_left_ = 0;
+	long long Trace::record_start_ = 0;
+	long long Trace::frame_start_ = 0;
+	int Trace::num_traces_ = 0;
+	std::mutex Trace::buffers_mutex_;
+	std::vector<Trace::Buffer *> Trace::buffers_;
+
+	// Start of the timestamps, and name of each thread until its buffer exists
+	static const std::chrono::steady_clock::time_point trace_start_g = std::chrono::steady_clock::now();
+	static thread_local std::string trace_thread_name_g;
+
+	void Trace::Start(int frames)
+	{
+		if (recording_ || frames <= 0) { return; }
+		std::cout << "Tracing " << frames << " frames" << std::endl;
+		frames_left_ = frames;
+		record_start_ = Now();
+		frame_start_ = record_start_;
+		recording_ = true;
+	}
+
+	bool Trace::IsRecording(void) { return recording_.load(std::memory_order_relaxed); }
+	void Trace::SetThreadName(const std::string name) { trace_thread_name_g = name; }
+
+	long long Trace::Now(void)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start_g).count();
+	}
+
+	Trace::Buffer *Trace::GetBuffer(void)
+	{
+		static thread_local Buffer *buffer = NULL;
+		if (buffer) { return buffer; }
+
+		// Buffers live until the end of the program, the writer may read them after their thread is gone
+		buffer = new Buffer();
+		buffer->head = 0;
+		buffer->claimed = 0;
+		std::lock_guard<std::mutex> lock(buffers_mutex_);
+		buffer->tid = buffers_.size() + 1;
+		buffer->thread_name = trace_thread_name_g.empty() ? std::string("thread ") + std::to_string(buffer->tid) : trace_thread_name_g;
+		buffers_.push_back(buffer);
+		return buffer;
+	}
+
+	void Trace::AddEvent(const char *name, long long start, long long end)
+	{
+		// Claim the slot before rewriting it, so a reader copying it at the same time drops it
+		Buffer *buffer = GetBuffer();
+		unsigned int head = buffer->head.load(std::memory_order_relaxed);
+		buffer->claimed.store(head + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Slot &slot = buffer->slot[head % TRACE_BUFFER_EVENTS];
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.start.store(start, std::memory_order_relaxed);
+		slot.duration.store(end - start, std::memory_order_relaxed);
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+	void Trace::CopyEvents(Buffer *buffer, std::vector<Event> &events)
+	{
+		unsigned int head = buffer->head.load(std::memory_order_acquire);
+		unsigned int oldest = (head > TRACE_BUFFER_EVENTS) ? head - TRACE_BUFFER_EVENTS : 0;
+		events.clear();
+		for (unsigned int j = oldest; j < head; j++)
+		{
+			const Slot &slot = buffer->slot[j % TRACE_BUFFER_EVENTS];
+			Event event;
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.start = slot.start.load(std::memory_order_relaxed);
+			event.duration = slot.duration.load(std::memory_order_relaxed);
+			events.push_back(event);
+		}
+
+		// Slots claimed by the thread since then hold newer events, or parts of them
+		std::atomic_thread_fence(std::memory_order_acquire);
+		unsigned int claimed = buffer->claimed.load(std::memory_order_relaxed);
+		if (claimed > oldest + TRACE_BUFFER_EVENTS)
+		{
+			unsigned int torn = std::min(claimed - TRACE_BUFFER_EVENTS - oldest, (unsigned int)events.size());
+			events.erase(events.begin(), events.begin() + torn);
+		}
+	}
+
+	void Trace::EndFrame(void)
+	{
+		if (!recording_) { return; }
+
+		long long now = Now();
+		AddEvent("frame", frame_start_, now);
+		frame_start_ = now;
+		if (--frames_left_ > 0) { return; }
+
+		// Scopes still open on other threads are left out of this trace
+		recording_ = false;
+		std::ostringstream filename;
+		filename << "trace_" << ++num_traces_ << ".json";
+		Write(filename.str());
+		std::cout << "Trace written to " << filename.str() << std::endl;
+	}
+
+	void Trace::Write(const std::string filename)
+	{
+		std::ofstream f(filename.c_str());
+		if (f.fail()) { throw(std::ios_base::failure(std::string("Error opening file ") + filename)); }
+
+		std::vector<Buffer *> buffers;
+		{
+			std::lock_guard<std::mutex> lock(buffers_mutex_);
+			buffers = buffers_;
+		}
+
+		// Complete events ("X"), timestamps in microseconds
+		f << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+		f << std::fixed << std::setprecision(3);
+		bool first = true;
+		std::vector<Event> events;
+		for (int i = 0; i < buffers.size(); i++)
+		{
+			Buffer *buffer = buffers[i];
+			f << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+				<< ", \"args\": {\"name\": \"" << buffer->thread_name << "\"}}";
+			first = false;
+
+			CopyEvents(buffer, events);
+			for (int j = 0; j < events.size(); j++)
+			{
+				const Event &event = events[j];
+				if (event.start < record_start_) { continue; }
+				f << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+					<< ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0 << "}";
+			}
+		}
+		f << std::endl << "]}" << std::endl;
+	}
+
+	/* Constructor */
+	TraceScope::TraceScope(const char *name)
+	{
+		name_ = name;
+		active_ = Trace::IsRecording();
+		if (active_) { start_ = Trace::Now(); }
+	}
+
+	/* Destructor */
+	TraceScope::~TraceScope() { End(); }
+
+	void TraceScope::End(void)
+	{
+		if (!active_) { return; }
+		Trace::AddEvent(name_, start_, Trace::Now());
+		active_ = false;
+	}
+} // namespace game
@@ -0,0 +1,89 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+// Events kept for each thread, older ones are overwritten
+#define TRACE_BUFFER_EVENTS 65536
+// Frames recorded by a trace when no count is given
+#define TRACE_DEFAULT_FRAMES 300
+
+// Time the rest of the enclosing block as an event of the trace, while one is recorded
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) game::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+// TRACE
+// Timelines of a few frames in the Chrome trace event format, for chrome://tracing or Perfetto.
+// Each thread writes its events into its own ring buffer without locking; the main
+// thread writes them all to a file once the frames are recorded, skipping the events
+// that other threads overwrite while it reads them
+namespace game
+{
+	class Trace
+	{
+	public:
+		static void Start(int frames);						// Record the next frames, then write them to trace_N.json
+		static bool IsRecording(void);
+		static void SetThreadName(const std::string name);	// Name of the calling thread in the traces
+		static long long Now(void);							// Nanoseconds since the start of the program
+		static void AddEvent(const char *name, long long start, long long end);	// Event of the calling thread, name must be a literal
+		static void EndFrame(void);							// Main thread, once per frame
+
+	private:
+		struct Event
+		{
+			const char *name;
+			long long start;
+			long long duration;
+		};
+
+		// Slot of a ring buffer, read by the writer of the file while its thread may rewrite it
+		struct Slot
+		{
+			std::atomic<const char *> name;
+			std::atomic<long long> start;
+			std::atomic<long long> duration;
+		};
+
+		struct Buffer
+		{
+			int tid;
+			std::string thread_name;
+			Slot slot[TRACE_BUFFER_EVENTS];
+			std::atomic<unsigned int> head;		// Events written so far, the reader sees those before it
+			std::atomic<unsigned int> claimed;	// Events written or being written, the slots of older ones may be torn
+		};
+
+		static std::atomic<bool> recording_;
+		static int frames_left_;
+		static long long record_start_;		// Events older than this are from a previous trace
+		static long long frame_start_;
+		static int num_traces_;
+		static std::mutex buffers_mutex_;	// Protects buffers_, taken once per thread
+		static std::vector<Buffer *> buffers_;
+
+		static Buffer *GetBuffer(void);		// Buffer of the calling thread, created by its first event
+		static void CopyEvents(Buffer *buffer, std::vector<Event> &events);	// Events of a buffer that were not overwritten while copied
+		static void Write(const std::string filename);
+	}; // class Trace
+
+	// Adds an event from its construction to its destruction, or to End
+	class TraceScope
+	{
+	public:
+		TraceScope(const char *name);
+		~TraceScope();
+
+		void End(void);
+
+	private:
+		const char *name_;
+		long long start_;
+		bool active_;
+	}; // class TraceScope
+} // namespace game
+#endif // TRACE_H_
@@ -0,0 +1,209 @@
+#include <cstring>
+#include <cmath>
+
+#include "vertex_format.h"
+
+namespace game
+{
+	// Position of each attribute in an unpacked vertex, and its number of components
+	static const int attribute_first_g[NumVertexAttributes] = { 0, 3, 6, 9 };
+	static const int attribute_count_g[NumVertexAttributes] = { 3, 3, 3, 2 };
+	static const char *attribute_name_g[NumVertexAttributes] = { "vertex", "normal", "color", "uv" };
+
+	const char *GetVertexAttributeName(VertexAttributeType attribute) { return attribute_name_g[attribute]; }
+
+	bool SameVertexFormat(const VertexFormat &a, const VertexFormat &b)
+	{
+		if (a.stride != b.stride) { return false; }
+		for (int i = 0; i < NumVertexAttributes; i++)
+		{
+			const VertexAttributeFormat &x = a.attribute[i];
+			const VertexAttributeFormat &y = b.attribute[i];
+			if (x.enabled != y.enabled) { return false; }
+			if (x.enabled)
+			{
+				if (x.size != y.size || x.type != y.type || x.normalized != y.normalized || x.offset != y.offset) { return false; }
+			}
+			else if (memcmp(x.constant, y.constant, sizeof(x.constant)) != 0) { return false; }
+		}
+		return true;
+	}
+
+	/* Helpers */
+	static void SetFloatAttribute(VertexAttributeFormat &att, int count, GLsizei &offset)
+	{
+		att.enabled = true;
+		att.size = count;
+		att.type = GL_FLOAT;
+		att.normalized = GL_FALSE;
+		att.offset = offset;
+		offset += count * sizeof(GLfloat);
+	}
+
+	// Convert a float to a 16-bit half float, rounding to nearest
+	static unsigned short FloatToHalf(float value)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		unsigned int sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+		unsigned int mantissa = bits & 0x7fffff;
+
+		// Too small for a normal half: denormal or zero
+		if (exponent <= 0)
+		{
+			if (exponent < -10) { return sign; }
+			mantissa |= 0x800000;
+			int shift = 14 - exponent;
+			unsigned int half = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1) { half++; }
+			return sign | half;
+		}
+
+		// Too large, becomes infinity
+		if (exponent >= 31) { return sign | 0x7c00; }
+
+		// A carry out of the mantissa correctly moves to the exponent
+		unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+		if (mantissa & 0x1000) { half++; }
+		return (unsigned short)half;
+	}
+
+	// Pack a normal in [-1, 1] into a signed normalized 10/10/10/2 integer
+	static unsigned int PackNormal(const GLfloat *normal)
+	{
+		unsigned int packed = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			int value = (int)floor(normal[k] * 511.0f + 0.5f);
+			if (value > 511) { value = 511; }
+			if (value < -511) { value = -511; }
+			packed |= ((unsigned int)value & 0x3ff) << (10 * k);
+		}
+		return packed;
+	}
+
+	VertexFormat DefaultVertexFormat(void)
+	{
+		VertexFormat format;
+		GLsizei offset = 0;
+		for (int i = 0; i < NumVertexAttributes; i++)
+		{
+			SetFloatAttribute(format.attribute[i], attribute_count_g[i], offset);
+			format.attribute[i].constant[0] = format.attribute[i].constant[1] = format.attribute[i].constant[2] = 0.0f;
+			format.attribute[i].constant[3] = 1.0f;
+		}
+		format.stride = offset;
+		return format;
+	}
+
+	VertexFormat ChooseVertexFormat(const GLfloat *vertex, int num_vertices, bool packed_normals)
+	{
+		VertexFormat format = DefaultVertexFormat();
+		GLsizei offset = 0;
+
+		for (int i = 0; i < NumVertexAttributes; i++)
+		{
+			VertexAttributeFormat &att = format.attribute[i];
+			int first = attribute_first_g[i];
+			int count = attribute_count_g[i];
+
+			// Find the range of the attribute, and whether it is the same for every vertex
+			bool constant = true;
+			float min_value = 0.0f, max_value = 0.0f;
+			for (int v = 0; v < num_vertices; v++)
+			{
+				for (int k = 0; k < count; k++)
+				{
+					float value = vertex[v * VERTEX_FLOATS + first + k];
+					if (v == 0 && k == 0) { min_value = max_value = value; }
+					if (value < min_value) { min_value = value; }
+					if (value > max_value) { max_value = value; }
+					if (value != vertex[first + k]) { constant = false; }
+				}
+			}
+
+			// Constant attributes are not stored at all
+			if (num_vertices > 0 && constant && i != PositionAttribute)
+			{
+				att.enabled = false;
+				for (int k = 0; k < count; k++) { att.constant[k] = vertex[first + k]; }
+				continue;
+			}
+
+			if (i == NormalAttribute && packed_normals && min_value >= -1.0f && max_value <= 1.0f)
+			{
+				// 10 bits per component, 4 bytes instead of 12
+				att.enabled = true;
+				att.size = 4;
+				att.type = GL_INT_2_10_10_10_REV;
+				att.normalized = GL_TRUE;
+				att.offset = offset;
+				offset += sizeof(GLuint);
+			}
+			else if (i == ColorAttribute && min_value >= 0.0f && max_value <= 1.0f)
+			{
+				// 16 bits per component, padded to 4 components to keep the stride aligned
+				att.enabled = true;
+				att.size = 4;
+				att.type = GL_UNSIGNED_SHORT;
+				att.normalized = GL_TRUE;
+				att.offset = offset;
+				offset += 4 * sizeof(GLushort);
+			}
+			else if (i == UVAttribute && min_value >= -65504.0f && max_value <= 65504.0f)
+			{
+				// Half floats, 4 bytes instead of 8
+				att.enabled = true;
+				att.size = 2;
+				att.type = GL_HALF_FLOAT;
+				att.normalized = GL_FALSE;
+				att.offset = offset;
+				offset += 2 * sizeof(GLushort);
+			}
+			else { SetFloatAttribute(att, count, offset); }
+		}
+
+		format.stride = offset;
+		return format;
+	}
+
+	void PackVertices(const GLfloat *vertex, int num_vertices, const VertexFormat &format, std::vector<unsigned char> &packed)
+	{
+		packed.assign(num_vertices * format.stride, 0);
+		for (int v = 0; v < num_vertices; v++)
+		{
+			const GLfloat *in = &vertex[v * VERTEX_FLOATS];
+			unsigned char *out = &packed[v * format.stride];
+
+			for (int i = 0; i < NumVertexAttributes; i++)
+			{
+				const VertexAttributeFormat &att = format.attribute[i];
+				if (!att.enabled) { continue; }
+
+				const GLfloat *value = &in[attribute_first_g[i]];
+				unsigned char *dest = out + att.offset;
+				int count = attribute_count_g[i];
+
+				if (att.type == GL_INT_2_10_10_10_REV)
+				{
+					GLuint normal = PackNormal(value);
+					memcpy(dest, &normal, sizeof(normal));
+				}
+				else if (att.type == GL_UNSIGNED_SHORT)
+				{
+					GLushort color[4] = { 0, 0, 0, 65535 };
+					for (int k = 0; k < count; k++) { color[k] = (GLushort)floor(value[k] * 65535.0f + 0.5f); }
+					memcpy(dest, color, sizeof(color));
+				}
+				else if (att.type == GL_HALF_FLOAT)
+				{
+					GLushort half[2];
+					for (int k = 0; k < count; k++) { half[k] = FloatToHalf(value[k]); }
+					memcpy(dest, half, count * sizeof(GLushort));
+				}
+				else { memcpy(dest, value, count * sizeof(GLfloat)); }
+			}
+		}
+	}
+} // namespace game
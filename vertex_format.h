@@ -0,0 +1,39 @@
+#ifndef VERTEX_FORMAT_H_
+#define VERTEX_FORMAT_H_
+
+#include <vector>
+#include "gl_types.h"
+
+// Number of floats in an unpacked vertex: 3D position (3), 3D normal (3), RGB color (3), 2D texture coordinates (2)
+#define VERTEX_FLOATS 11
+
+namespace game
+{
+	// Vertex attributes, in the order they appear in an unpacked vertex
+	typedef enum VertexAttributeName { PositionAttribute, NormalAttribute, ColorAttribute, UVAttribute, NumVertexAttributes } VertexAttributeType;
+
+	// How one attribute is stored in the array buffer
+	struct VertexAttributeFormat
+	{
+		bool enabled;			// Whether the attribute is stored; if not, every vertex gets constant
+		GLint size;				// Number of components
+		GLenum type;			// Type of the components
+		GLboolean normalized;	// Whether integer components map to [0, 1] or [-1, 1]
+		GLsizei offset;			// Offset in bytes from the start of the vertex
+		GLfloat constant[4];	// Value of the attribute when it is not stored
+	};
+
+	// Layout of the vertices of a geometry
+	struct VertexFormat
+	{
+		GLsizei stride;											// Size of one vertex in bytes
+		VertexAttributeFormat attribute[NumVertexAttributes];	// Format of each attribute
+	};
+
+	VertexFormat DefaultVertexFormat(void);		// Unpacked format, with all attributes stored as floats
+	VertexFormat ChooseVertexFormat(const GLfloat *vertex, int num_vertices, bool packed_normals);	// Smallest format that holds the unpacked vertices
+	void PackVertices(const GLfloat *vertex, int num_vertices, const VertexFormat &format, std::vector<unsigned char> &packed);	// Convert unpacked vertices to a format
+	bool SameVertexFormat(const VertexFormat &a, const VertexFormat &b);	// Whether vertices in the two formats can share attribute setup
+	const char *GetVertexAttributeName(VertexAttributeType attribute);	// Name of the attribute in the shaders
+} // namespace game
+#endif // VERTEX_FORMAT_H_
@@ -1,4 +1,5 @@
 #include "wall.h"
+#include "counters.h"
 
 namespace game
 {
@@ -19,6 +20,7 @@ namespace game
 	//plane sphere collision with min max bounds checks
 	bool Wall::collision(SceneNode* obj, float boundRad, float off, glm::vec3* norm)
 	{
+		Counters::Add(CounterCollisionsTested);
 		*norm = normal;			//return the normal of the plane
 
 		//obj up vector
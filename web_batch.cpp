@@ -0,0 +1,95 @@
+#include <cstring>
+#include <stdexcept>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/type_ptr.hpp>
+
+#include "web_batch.h"
+#include "clock.h"
+#include "gl_calls.h"
+
+// WEB BATCH
+namespace game
+{
+	/* Constructor */
+	WebBatch::WebBatch(const std::string name, const Resource *geometry, const Resource *material) : SceneNode(name, geometry, material)
+	{
+		memset(&block_, 0, sizeof(block_));
+		uniform_buffer_ = 0;
+		SetBlending(true);
+		SetInstanceCount(0);
+	}
+
+	/* Destructor */
+	WebBatch::~WebBatch()
+	{
+		if (uniform_buffer_) { glDeleteBuffers(1, &uniform_buffer_); }
+	}
+
+	void WebBatch::SetControlPoints(const GLfloat *control_point, int size)
+	{
+		if (size > WEB_CONTROL_POINTS * 3) { throw(std::invalid_argument(std::string("Too many control points in ") + GetName())); }
+
+		// Arrays in std140 blocks take a vec4 per element
+		for (int i = 0; i < size / 3; i++)
+		{
+			block_.control_point[i * 4 + 0] = control_point[i * 3 + 0];
+			block_.control_point[i * 4 + 1] = control_point[i * 3 + 1];
+			block_.control_point[i * 4 + 2] = control_point[i * 3 + 2];
+		}
+	}
+
+	void WebBatch::AddWeb(SceneNode *particle)
+	{
+		particle->SetMerged(true);
+		webs_.push_back(particle);
+	}
+
+	void WebBatch::UpdateInstances(void)
+	{
+		for (int i = 0; i < webs_.size(); i++)
+		{
+			if (webs_[i]->del) { webs_.erase(webs_.begin() + i); i--; }
+		}
+
+		// Webs past the size of the block wait until older ones are gone
+		drawn_.clear();
+		for (int i = 0; i < webs_.size() && drawn_.size() < MAX_WEB_INSTANCES; i++)
+		{
+			if (webs_[i]->GetVisible()) { drawn_.push_back(webs_[i]); }
+		}
+		SetInstanceCount(drawn_.size());
+	}
+
+	void WebBatch::SetupShader(GLuint program)
+	{
+		SceneNode::SetupShader(program);
+
+		// Matrices from the transform pass of this frame
+		double current_time = Clock::GetTime();
+		for (int i = 0; i < drawn_.size(); i++)
+		{
+			memcpy(&block_.web_world_mat[i * 16], glm::value_ptr(drawn_[i]->GetWorldMatrix()), 16 * sizeof(GLfloat));
+			block_.web_timer[i * 4] = (GLfloat)(current_time - drawn_[i]->GetStartTime());
+		}
+
+		// One upload per frame, only the webs drawn are sent
+		if (!uniform_buffer_)
+		{
+			glGenBuffers(1, &uniform_buffer_);
+			Gl::BindBuffer(GL_UNIFORM_BUFFER, uniform_buffer_);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), NULL, GL_DYNAMIC_DRAW);
+		}
+		else { Gl::BindBuffer(GL_UNIFORM_BUFFER, uniform_buffer_); }
+		GLsizeiptr timer_offset = (GLsizeiptr)((char *)block_.web_timer - (char *)&block_);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block_.control_point) + drawn_.size() * 16 * sizeof(GLfloat), &block_);
+		glBufferSubData(GL_UNIFORM_BUFFER, timer_offset, drawn_.size() * 4 * sizeof(GLfloat), block_.web_timer);
+
+		GLuint block_index = glGetUniformBlockIndex(program, "WebBatch");
+		if (block_index != GL_INVALID_INDEX) { glUniformBlockBinding(program, block_index, WEB_BATCH_BINDING); }
+		Gl::BindBufferBase(GL_UNIFORM_BUFFER, WEB_BATCH_BINDING, uniform_buffer_);
+
+		// Quads interleave the webs in one call, the geometry program has no such uniform
+		GLint num_instances_var = glGetUniformLocation(program, "num_instances");
+		if (num_instances_var >= 0) { Gl::Uniform1i(num_instances_var, drawn_.size()); }
+	}
+} // namespace game
@@ -0,0 +1,49 @@
+#ifndef WEB_BATCH_H_
+#define WEB_BATCH_H_
+
+#include <vector>
+
+#include "scene_node.h"
+
+// Webs drawn by one call, must match the arrays of the WebBatch block in spline_vp.glsl
+#define MAX_WEB_INSTANCES 64
+// Control points of the spline followed by the web particles
+#define WEB_CONTROL_POINTS 64
+// Uniform buffer binding point of the WebBatch block
+#define WEB_BATCH_BINDING 1
+
+// WEB BATCH
+namespace game
+{
+	// Draws the particles of all webs in one instanced call. Each web keeps its own
+	// particle node for its transformation and start time, like the parts of a
+	// character; the batch gathers them and the control points in a uniform buffer
+	class WebBatch : public SceneNode
+	{
+	public:
+		WebBatch(const std::string name, const Resource *geometry, const Resource *material);
+		~WebBatch();
+
+		void SetControlPoints(const GLfloat *control_point, int size);	// Spline shared by all webs, size is the number of floats
+		void AddWeb(SceneNode *particle);	// Draw the particles of a web with the batch, it is no longer drawn on its own
+		void UpdateInstances(void);			// Forget deleted webs and count the ones to draw
+
+	protected:
+		void SetupShader(GLuint program);	// Also upload the uniform buffer
+
+	private:
+		// Layout of the WebBatch block (std140)
+		struct Block
+		{
+			GLfloat control_point[WEB_CONTROL_POINTS * 4];
+			GLfloat web_world_mat[MAX_WEB_INSTANCES * 16];
+			GLfloat web_timer[MAX_WEB_INSTANCES * 4];
+		};
+
+		std::vector<SceneNode *> webs_;		// Particle nodes of the webs, oldest first
+		std::vector<SceneNode *> drawn_;	// Webs drawn this frame
+		Block block_;						// Data uploaded each frame
+		GLuint uniform_buffer_;
+	}; // class WebBatch
+} // namespace game
+#endif // WEB_BATCH_H_